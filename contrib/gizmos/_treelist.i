@@ -181,6 +181,48 @@ public:
         return rval;
     }
 
+    // The Python method returns a sequence of (data, hasChildren) pairs,
+    // one for each of the requested children
+    virtual void OnGetVirtualChildren(const wxTreeItemId& parent,
+                                      size_t from, size_t count,
+                                      wxTreeItemData** data,
+                                      bool* hasChildren) {
+        bool found;
+        wxPyBlock_t blocked = wxPyBeginBlockThreads();
+        if ((found = wxPyCBH_findCallback(m_myInst, "OnGetVirtualChildren"))) {
+            PyObject* parento = wxPyConstructObject((void*)&parent, wxT("wxTreeItemId"), 0);
+            PyObject* ro = wxPyCBH_callCallbackObj(m_myInst, Py_BuildValue("(Oii)", parento, (int)from, (int)count));
+            Py_DECREF(parento);
+            if (ro && PySequence_Check(ro)) {
+                size_t len = (size_t)PySequence_Length(ro);
+                for (size_t i = 0; i < len && i < count; i++) {
+                    PyObject* pair = PySequence_GetItem(ro, i);
+                    PyObject* datao = NULL;
+                    PyObject* flago = NULL;
+                    if (pair && PySequence_Check(pair) && PySequence_Length(pair) == 2) {
+                        datao = PySequence_GetItem(pair, 0);
+                        flago = PySequence_GetItem(pair, 1);
+                    }
+                    if (datao && datao != Py_None)
+                        data[i] = new wxPyTreeItemData(datao);
+                    if (flago)
+                        hasChildren[i] = PyObject_IsTrue(flago) == 1;
+                    Py_XDECREF(datao);
+                    Py_XDECREF(flago);
+                    Py_XDECREF(pair);
+                }
+            }
+            else if (ro)
+                PyErr_SetString(PyExc_TypeError, "OnGetVirtualChildren must return a sequence of (data, hasChildren) pairs");
+            if (PyErr_Occurred())
+                PyErr_Print();
+            Py_XDECREF(ro);
+        }
+        wxPyEndBlockThreads(blocked);
+        if (! found)
+            wxTreeListCtrl::OnGetVirtualChildren(parent, from, count, data, hasChildren);
+    }
+
     PYPRIVATE;
 };
 
@@ -672,8 +714,53 @@ public:
     // sort the children of this item using OnCompareItems
     void SortChildren(const wxTreeItemId& item);
 
-    // searching
-    wxTreeItemId FindItem (const wxTreeItemId& item, const wxString& str, int flags = 0);
+    // sort the children by the text of the column without calling
+    // OnCompareItems, optionally in a worker thread
+    void SortChildrenByColumn (const wxTreeItemId& item, int column,
+                               bool reverse = false, bool background = false);
+
+    // put the children in a new order, order[n] is the current index of
+    // the child to become the n-th one
+    void ReorderChildren (const wxTreeItemId& item, const wxArrayInt& order);
+
+    %pythoncode {
+        def SortChildrenByKey(self, item, key, reverse=False):
+            """
+            Sort the children of item by the values of key(child), key is
+            called once for each child and the values are compared by
+            Python's own (stable) sort, OnCompareItems is not called.
+            """
+            children = []
+            child, cookie = self.GetFirstChild(item)
+            while child.IsOk():
+                children.append(child)
+                child, cookie = self.GetNextChild(item, cookie)
+            keys = [key(child) for child in children]
+            order = sorted(range(len(keys)), key=keys.__getitem__, reverse=reverse)
+            self.ReorderChildren(item, order)
+    }
+
+    // searching, the main column is searched unless another column is given
+    wxTreeItemId FindItem (const wxTreeItemId& item, const wxString& str, int flags = 0,
+                           int column = -1);
+
+    // keep a sorted index of the texts of the column so FindItem() and the
+    // type-ahead search don't have to compare all items
+    void SetFindIndex (int column, bool enable = true);
+    bool HasFindIndex (int column) const;
+
+    // item sizes are measured once and cached, call this when the text of
+    // an item changed behind the control's back (e.g. in virtual mode)
+    void InvalidateItemSize (const wxTreeItemId& item, bool recursively = false);
+
+    // give the item 'count' children which only exist while they are shown
+    // (or selected, expanded, ...), they are created in blocks by calling
+    // OnGetVirtualChildren(parent, from, count) which returns a sequence of
+    // (data, hasChildren) pairs, requires wx.TR_VIRTUAL without
+    // wx.TR_HAS_VARIABLE_ROW_HEIGHT. Walks over them create a block at a
+    // time, ExpandAll doesn't expand them and they can't be sorted
+    void SetVirtualChildrenCount (const wxTreeItemId& item, size_t count);
+    size_t GetVirtualChildrenCount (const wxTreeItemId& item) const;
 
     // drop over item
     void SetDragItem (const wxTreeItemId& item = (wxTreeItemId*)NULL);
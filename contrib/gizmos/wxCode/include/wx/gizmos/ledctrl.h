@@ -5,6 +5,9 @@
 
 #include <wx/window.h>
 #include <wx/control.h>
+#include <wx/bitmap.h>
+#include <wx/dynarray.h>
+#include <wx/hashmap.h>
 
 class wxEraseEvent;
 class wxPaintEvent;
@@ -25,6 +28,9 @@ enum wxLEDValueAlign
 
 #define wxLED_DRAW_FADED 0x08
 
+// Pre-rendered digit cells, keyed by segment mask and faded flag.
+WX_DECLARE_HASH_MAP(int, wxBitmap, wxIntegerHash, wxIntegerEqual, wxLEDGlyphMap);
+
 // ----------------------------------------------------------------------------
 // wxLEDNumberCtrl
 // ----------------------------------------------------------------------------
@@ -65,10 +71,33 @@ private:
     bool m_DrawFaded;
     int m_LeftStartPos;
 
+    // Glyph key of each display column, the first entry being column -1
+    // (used by a leading decimal sign).
+    wxArrayInt m_Columns;
+
+    // Offscreen copy of the client area, only redrawn where it changed.
+    wxBitmap m_Backbuffer;
+    bool m_BackbufferValid;
+
+    // Digit cells rendered for the current size and colours.
+    wxLEDGlyphMap m_Glyphs;
+    wxSize m_GlyphSize;
+    int m_GlyphLineMargin;
+    wxColour m_GlyphForeground;
+    wxColour m_GlyphBackground;
+
     // Functions.
-    void DrawDigit(wxDC &Dc, int Digit, int Column);
+    void DrawDigit(wxDC &Dc, int Digit, int XPos);
     void RecalcInternals(const wxSize &CurrentSize);
 
+    void CalcColumns(const wxString &Value, wxArrayInt &Columns) const;
+    wxRect GetColumnRect(int Column) const;
+    bool UpdateGlyphState();
+    wxBitmap &GetGlyph(int Key);
+    void DrawColumn(wxDC &Dc, int Column, int Key);
+    void DrawBackbuffer(wxDC &Dc);
+    void CreateBackbuffer(int Width, int Height);
+
     // Events.
     DECLARE_EVENT_TABLE()
 
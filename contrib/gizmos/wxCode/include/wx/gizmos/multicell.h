@@ -92,6 +92,18 @@ public:
 
     virtual void RecalcSizes();
     virtual wxSize CalcMin();
+
+    // changing the children makes the minimums computed by CalcMin stale
+    using wxSizer::Insert;
+    using wxSizer::Remove;
+    using wxSizer::Detach;
+    virtual wxSizerItem* Insert(size_t index, wxSizerItem *item);
+    virtual bool Remove(wxSizer *sizer);
+    virtual bool Remove(int index);
+    virtual bool Detach(wxWindow *window);
+    virtual bool Detach(wxSizer *sizer);
+    virtual bool Detach(int index);
+
     bool SetDefaultCellSize(wxSize size);
     bool SetColumnWidth(int column, int colSize = 5, bool expandable = false);
     bool SetRowHeight(int row, int rowSize = 5, bool expandable = false);
@@ -102,6 +114,7 @@ public:
 private:
     void GetMinimums();
     static int Sum(int *array, int x);
+    static int *PrefixSum(int *sums, int *array, int count);
 
 private:
     int *m_maxHeight;
@@ -111,6 +124,13 @@ private:
     wxSize **m_weights;
     wxSize **m_minSizes;
     int m_maxWeights;
+    int *m_rowPos;              // row and column offsets from the last layout
+    int *m_colPos;
+    wxSizerItem **m_minItems;   // children and their min sizes as of the
+    wxSize *m_itemMinSizes;     // last GetMinimums
+    int m_minItemCount;
+    bool m_minimumsValid;       // row and column minimums are up to date
+    bool m_minimumsFresh;       // computed by CalcMin since the last RecalcSizes
     wxSize m_defaultCellSize;
     wxWindow *m_win; // usually used for debugging
     const wxPen *m_pen;
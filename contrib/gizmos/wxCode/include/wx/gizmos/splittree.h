@@ -23,6 +23,8 @@
 #include "wx/treectrl.h"
 #include "wx/splitter.h"
 #include "wx/scrolwin.h"
+#include "wx/hashmap.h"
+#include "wx/hashset.h"
 
 #if USE_GENERIC_TREECTRL
 #include "wx/generic/treectlg.h"
@@ -36,6 +38,11 @@ class wxRemotelyScrolledTreeCtrl;
 class wxThinSplitterWindow;
 class wxSplitterScrolledWindow;
 
+// Number of rows below a tree item when it is expanded, and the set of items
+// whose expansion has been accounted for in those counts.
+WX_DECLARE_HASH_MAP(void*, int, wxPointerHash, wxPointerEqual, wxTreeRowCountMap);
+WX_DECLARE_HASH_SET(void*, wxPointerHash, wxPointerEqual, wxTreeItemSet);
+
 /*
  * wxRemotelyScrolledTreeCtrl
  *
@@ -57,6 +64,7 @@ public:
     void OnExpand(wxTreeEvent& event);
     void OnScroll(wxScrollWinEvent& event);
     void OnPaint(wxPaintEvent& event);
+    void OnDeleteItem(wxTreeEvent& event);
 
 //// Overrides
     // Override this in case we're using the generic tree control.
@@ -88,6 +96,22 @@ public:
     void CalcTreeSize(wxRect& rect);
     void CalcTreeSize(const wxTreeItemId& id, wxRect& rect);
 
+    // Number of rows of the whole tree, i.e. of all items whose ancestors
+    // are expanded. Maintained incrementally as items are expanded,
+    // collapsed and inserted.
+    int GetTotalRowCount();
+
+    // Rows shown in the client area, from top to bottom. Row i starts at
+    // GetVisibleRowTops()[i]; the extra last entry is the bottom of the last
+    // row. The list is shared with the companion window so that neither
+    // has to query the bounding rectangle of every item when painting.
+    const wxArrayTreeItemIds& GetVisibleRows();
+    const wxArrayInt& GetVisibleRowTops();
+
+    // Forget the cached row counts, e.g. after changing the tree in a way
+    // that doesn't generate events.
+    void InvalidateRowCounts();
+
     // Adjust the containing wxScrolledWindow's scrollbars appropriately
     void AdjustRemoteScrollbars();
 
@@ -108,8 +132,34 @@ public:
 
     DECLARE_EVENT_TABLE()
 protected:
+    virtual wxTreeItemId DoInsertItem(const wxTreeItemId& parent,
+                                      size_t pos,
+                                      const wxString& text,
+                                      int image, int selImage,
+                                      wxTreeItemData *data);
+    virtual wxTreeItemId DoInsertAfter(const wxTreeItemId& parent,
+                                       const wxTreeItemId& idPrevious,
+                                       const wxString& text,
+                                       int image = -1, int selImage = -1,
+                                       wxTreeItemData *data = NULL);
+
+    bool IsHiddenRoot(const wxTreeItemId& id) const;
+    int GetSubtreeRowCount(const wxTreeItemId& id);
+    void AdjustRowCounts(const wxTreeItemId& id, int delta);
+    void ItemInserted(const wxTreeItemId& id);
+    void UpdateVisibleRows();
+
     wxWindow*   m_companionWindow;
     bool        m_drawRowLines;
+
+    wxTreeRowCountMap   m_rowCounts;
+    wxTreeItemSet       m_expandedItems;
+
+    wxArrayTreeItemIds  m_visibleRows;
+    wxArrayInt          m_visibleRowTops;
+    int                 m_visibleRowsHeight;
+    bool                m_visibleRowsValid;
+    int                 m_rowPitch;
 };
 
 /*
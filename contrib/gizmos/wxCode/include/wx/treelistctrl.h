@@ -457,7 +457,8 @@ public:
 
     // expand this item
     void Expand (const wxTreeItemId& item);
-    // expand this item and all subitems recursively
+    // expand this item and all subitems recursively, virtual children are
+    // not expanded since that would create all of them
     void ExpandAll (const wxTreeItemId& item);
     // collapse the item without removing its children
     void Collapse (const wxTreeItemId& item);
@@ -504,18 +505,57 @@ public:
     // virtual mode
     virtual wxString OnGetItemText( wxTreeItemData* item, long column ) const;
 
+    // give the item 'count' children which only exist while they are shown
+    // (or selected, expanded, ...), they are created in blocks by calling
+    // OnGetVirtualChildren(), requires wxTR_VIRTUAL without
+    // wxTR_HAS_VARIABLE_ROW_HEIGHT and an item without ordinary children.
+    // Walking over them (GetNext(), GetNextChild(), ...) creates them a
+    // block at a time and releases the older blocks as the walk goes on,
+    // they can't be sorted
+    void SetVirtualChildrenCount (const wxTreeItemId& item, size_t count);
+    size_t GetVirtualChildrenCount (const wxTreeItemId& item) const;
+    // fill in the data and the children flag of the virtual children
+    // [from, from+count) of the parent, the arrays are preset to NULL/false
+    virtual void OnGetVirtualChildren (const wxTreeItemId& parent,
+                                       size_t from, size_t count,
+                                       wxTreeItemData **data,
+                                       bool *hasChildren);
+
     // sorting
     // this function is called to compare 2 items and should return -1, 0
     // or +1 if the first item is less than, equal to or greater than the
     // second one. The base class version performs alphabetic comparaison
     // of item labels (GetText)
     virtual int OnCompareItems (const wxTreeItemId& item1, const wxTreeItemId& item2);
-    // sort the children of this item using OnCompareItems
-    // NB: this function is not reentrant and not MT-safe (FIXME)!
+    // sort the children of this item using OnCompareItems, the sort is
+    // stable and may be nested. If OnCompareItems changes the tree, the
+    // sort stops and the children keep their order
     void SortChildren(const wxTreeItemId& item);
-
-    // searching
-    wxTreeItemId FindItem (const wxTreeItemId& item, const wxString& str, int mode = 0);
+    // sort the children by the text of the column: the text of each child
+    // is taken once and the texts are compared directly, OnCompareItems is
+    // not called. With 'background' the sort runs in a worker thread and
+    // is applied at idle time, unless the tree has been changed meanwhile.
+    // If only texts changed, the children are sorted in the background again
+    void SortChildrenByColumn (const wxTreeItemId& item, int column,
+                               bool reverse = false, bool background = false);
+    // put the children in a new order, order[n] is the current index of
+    // the child to become the n-th one
+    void ReorderChildren (const wxTreeItemId& item, const wxArrayInt& order);
+
+    // searching, the main column is searched unless another column is given
+    wxTreeItemId FindItem (const wxTreeItemId& item, const wxString& str, int mode = 0,
+                           int column = -1);
+
+    // keep a sorted index of the texts of the column, up to date on every
+    // change, so FindItem() and the type-ahead search of the main column
+    // don't have to compare all items for the wxTL_MODE_NAV_EXPANDED and
+    // wxTL_MODE_NAV_VISIBLE modes, not available with wxTR_VIRTUAL
+    void SetFindIndex (int column, bool enable = true);
+    bool HasFindIndex (int column) const;
+
+    // item sizes are measured once and cached, call this when the text of
+    // an item changed behind the control's back (e.g. in virtual mode)
+    void InvalidateItemSize (const wxTreeItemId& item, bool recursively = false);
 
     // overridden base class virtuals
     virtual bool SetBackgroundColour (const wxColour& colour);
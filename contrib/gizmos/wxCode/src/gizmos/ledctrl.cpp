@@ -53,6 +53,10 @@ const int DASH   = LINE7;
 
 const int DIGITALL = -1;
 
+// Added to a segment mask in a glyph key when the faded lines are drawn
+// underneath the lit ones.
+const int FADEDGLYPH = 256;
+
 // ============================================================================
 // wxLEDNumberCtrl class implementation
 // ============================================================================
@@ -64,7 +68,9 @@ wxLEDNumberCtrl::wxLEDNumberCtrl()
     m_LineLength(-1),
     m_LineWidth(-1),
     m_DrawFaded(false),
-    m_LeftStartPos(-1)
+    m_LeftStartPos(-1),
+    m_BackbufferValid(false),
+    m_GlyphLineMargin(-1)
 {
 }
 
@@ -78,7 +84,9 @@ wxLEDNumberCtrl::wxLEDNumberCtrl(wxWindow *parent, wxWindowID id,
     m_LineLength(-1),
     m_LineWidth(-1),
     m_DrawFaded(false),
-    m_LeftStartPos(-1)
+    m_LeftStartPos(-1),
+    m_BackbufferValid(false),
+    m_GlyphLineMargin(-1)
 {
     Create(parent, id, pos, size, style);
 }
@@ -108,6 +116,7 @@ void wxLEDNumberCtrl::SetAlignment(wxLEDValueAlign Alignment, bool Redraw)
     {
         m_Alignment = Alignment;
         RecalcInternals(GetClientSize());
+        m_BackbufferValid = false;
 
         if (Redraw)
             Refresh(false);
@@ -120,6 +129,8 @@ void wxLEDNumberCtrl::SetDrawFaded(bool DrawFaded, bool Redraw)
     if (DrawFaded != m_DrawFaded)
     {
         m_DrawFaded = DrawFaded;
+        CalcColumns(m_Value, m_Columns);
+        m_BackbufferValid = false;
 
         if (Redraw)
             Refresh(false);
@@ -142,11 +153,43 @@ void wxLEDNumberCtrl::SetValue(wxString const &Value, bool Redraw)
         }
 #endif
 
+        wxArrayInt Columns;
+        CalcColumns(Value, Columns);
+
+        const int OldStartPos = m_LeftStartPos;
         m_Value = Value;
         RecalcInternals(GetClientSize());
 
-        if (Redraw)
-            Refresh(false);
+        // If the layout stayed the same only the columns whose glyph changed
+        // need to be redrawn, both in the backbuffer and on screen.
+        if (m_BackbufferValid && !UpdateGlyphState() &&
+            OldStartPos == m_LeftStartPos &&
+            Columns.GetCount() == m_Columns.GetCount())
+        {
+            wxMemoryDC MemDc;
+            MemDc.SelectObject(m_Backbuffer);
+
+            for (size_t i = 0; i < Columns.GetCount(); i++)
+            {
+                if (Columns[i] == m_Columns[i])
+                    continue;
+
+                DrawColumn(MemDc, (int)i - 1, Columns[i]);
+                if (Redraw)
+                    RefreshRect(GetColumnRect((int)i - 1), false);
+            }
+
+            MemDc.SelectObject(wxNullBitmap);
+            m_Columns = Columns;
+        }
+        else
+        {
+            m_Columns = Columns;
+            m_BackbufferValid = false;
+
+            if (Redraw)
+                Refresh(false);
+        }
     }
 }
 
@@ -169,67 +212,88 @@ void wxLEDNumberCtrl::OnPaint(wxPaintEvent &WXUNUSED(event))
 
     int Width, Height;
     GetClientSize(&Width, &Height);
+    if (Width <= 0 || Height <= 0)
+        return;
+
+    // Normally done by OnSize, but the first paint may come before it.
+    if (!m_Backbuffer.Ok() || m_Backbuffer.GetWidth() != Width ||
+        m_Backbuffer.GetHeight() != Height)
+        CreateBackbuffer(Width, Height);
+
+    if (UpdateGlyphState())
+        m_BackbufferValid = false;
 
-    wxBitmap *pMemoryBitmap = new wxBitmap(Width, Height);
     wxMemoryDC MemDc;
+    MemDc.SelectObject(m_Backbuffer);
 
-    MemDc.SelectObject(*pMemoryBitmap);
+    if (!m_BackbufferValid)
+    {
+        DrawBackbuffer(MemDc);
+        m_BackbufferValid = true;
+    }
 
-    // Draw background.
-    MemDc.SetBrush(wxBrush(GetBackgroundColour(), wxSOLID));
-    MemDc.DrawRectangle(wxRect(0, 0, Width, Height));
-    MemDc.SetBrush(wxNullBrush);
+    // Blit the damaged part of the backbuffer to screen.
+    wxRect Rect = GetUpdateRegion().GetBox();
+    Rect.Intersect(wxRect(0, 0, Width, Height));
+    Dc.Blit(Rect.x, Rect.y, Rect.width, Rect.height, &MemDc, Rect.x, Rect.y, wxCOPY);
 
-    // Iterate each digit in the value, and draw.
-    const int DigitCount = m_Value.Len();
-    for (int offset=0, i = 0; offset < DigitCount; ++offset, ++i)
+    MemDc.SelectObject(wxNullBitmap);
+}
+
+
+void wxLEDNumberCtrl::CalcColumns(const wxString &Value, wxArrayInt &Columns) const
+{
+    // Column -1 can only get a decimal sign, from a leading '.'.
+    Columns.Empty();
+    Columns.Add(0);
+
+    const int DigitCount = Value.Len();
+    for (int offset = 0; offset < DigitCount; ++offset)
     {
-        wxChar c = m_Value.GetChar(offset);
+        wxChar c = Value.GetChar(offset);
 
-        // Draw faded lines if wanted.
-        if (m_DrawFaded && (c != _T('.')))
-            DrawDigit(MemDc, DIGITALL, i);
+        // Display the decimal in the previous segment
+        if (c == _T('.'))
+        {
+            Columns[Columns.GetCount() - 1] |= DECIMALSIGN;
+            continue;
+        }
 
-        // Draw the digits.
+        int Key = m_DrawFaded ? FADEDGLYPH : 0;
         switch (c)
         {
             case _T('0') :
-                DrawDigit(MemDc, DIGIT0, i);
+                Key |= DIGIT0;
                 break;
             case _T('1') :
-                DrawDigit(MemDc, DIGIT1, i);
+                Key |= DIGIT1;
                 break;
             case _T('2') :
-                DrawDigit(MemDc, DIGIT2, i);
+                Key |= DIGIT2;
                 break;
             case _T('3') :
-                DrawDigit(MemDc, DIGIT3, i);
+                Key |= DIGIT3;
                 break;
             case _T('4') :
-                DrawDigit(MemDc, DIGIT4, i);
+                Key |= DIGIT4;
                 break;
             case _T('5') :
-                DrawDigit(MemDc, DIGIT5, i);
+                Key |= DIGIT5;
                 break;
             case _T('6') :
-                DrawDigit(MemDc, DIGIT6, i);
+                Key |= DIGIT6;
                 break;
             case _T('7') :
-                DrawDigit(MemDc, DIGIT7, i);
+                Key |= DIGIT7;
                 break;
             case _T('8') :
-                DrawDigit(MemDc, DIGIT8, i);
+                Key |= DIGIT8;
                 break;
             case _T('9') :
-                DrawDigit(MemDc, DIGIT9, i);
+                Key |= DIGIT9;
                 break;
             case _T('-') :
-                DrawDigit(MemDc, DASH, i);
-                break;
-            case _T('.') :
-                // Display the decimal in the previous segment
-                i--;
-                DrawDigit(MemDc, DECIMALSIGN, i);
+                Key |= DASH;
                 break;
             case _T(' ') :
                 // just skip it
@@ -238,15 +302,117 @@ void wxLEDNumberCtrl::OnPaint(wxPaintEvent &WXUNUSED(event))
                 wxFAIL_MSG(wxT("Unknown digit value"));
                 break;
         }
+
+        Columns.Add(Key);
+    }
+}
+
+
+wxRect wxLEDNumberCtrl::GetColumnRect(int Column) const
+{
+    // The cell of a digit starts half a line width before its leftmost
+    // segment, so that it also covers the decimal sign at its right side.
+    const int XPos = m_LeftStartPos + Column * (m_LineLength + m_DigitMargin);
+
+    return wxRect(XPos + (m_LineWidth + 1) / 2, 0,
+                  m_GlyphSize.GetWidth(), m_GlyphSize.GetHeight());
+}
+
+
+bool wxLEDNumberCtrl::UpdateGlyphState()
+{
+    const wxSize GlyphSize(m_LineLength + m_DigitMargin, GetClientSize().GetHeight());
+
+    if (GlyphSize == m_GlyphSize && m_LineMargin == m_GlyphLineMargin &&
+        GetForegroundColour() == m_GlyphForeground &&
+        GetBackgroundColour() == m_GlyphBackground)
+        return false;
+
+    m_Glyphs.clear();
+    m_GlyphSize = GlyphSize;
+    m_GlyphLineMargin = m_LineMargin;
+    m_GlyphForeground = GetForegroundColour();
+    m_GlyphBackground = GetBackgroundColour();
+
+    return true;
+}
+
+
+wxBitmap &wxLEDNumberCtrl::GetGlyph(int Key)
+{
+    wxLEDGlyphMap::iterator it = m_Glyphs.find(Key);
+    if (it != m_Glyphs.end())
+        return it->second;
+
+    wxBitmap &Glyph = m_Glyphs[Key];
+    Glyph.Create(m_GlyphSize.GetWidth(), m_GlyphSize.GetHeight());
+
+    wxMemoryDC MemDc;
+    MemDc.SelectObject(Glyph);
+
+    MemDc.SetBrush(wxBrush(GetBackgroundColour(), wxSOLID));
+    MemDc.SetPen(*wxTRANSPARENT_PEN);
+    MemDc.DrawRectangle(0, 0, m_GlyphSize.GetWidth(), m_GlyphSize.GetHeight());
+    MemDc.SetBrush(wxNullBrush);
+    MemDc.SetPen(wxNullPen);
+
+    // Draw the segments relative to the cell origin.
+    const int XPos = -(m_LineWidth + 1) / 2;
+
+    if (Key & FADEDGLYPH)
+        DrawDigit(MemDc, DIGITALL, XPos);
+    if (Key & ~FADEDGLYPH)
+        DrawDigit(MemDc, Key & ~FADEDGLYPH, XPos);
+
+    MemDc.SelectObject(wxNullBitmap);
+
+    return Glyph;
+}
+
+
+void wxLEDNumberCtrl::DrawColumn(wxDC &Dc, int Column, int Key)
+{
+    if (m_GlyphSize.GetWidth() <= 0 || m_GlyphSize.GetHeight() <= 0)
+        return;
+
+    const wxRect Rect = GetColumnRect(Column);
+
+    wxMemoryDC GlyphDc;
+    GlyphDc.SelectObject(GetGlyph(Key));
+    Dc.Blit(Rect.x, Rect.y, Rect.width, Rect.height, &GlyphDc, 0, 0, wxCOPY);
+    GlyphDc.SelectObject(wxNullBitmap);
+}
+
+
+void wxLEDNumberCtrl::DrawBackbuffer(wxDC &Dc)
+{
+    // Draw background.
+    Dc.SetBrush(wxBrush(GetBackgroundColour(), wxSOLID));
+    Dc.DrawRectangle(wxRect(0, 0, m_Backbuffer.GetWidth(), m_Backbuffer.GetHeight()));
+    Dc.SetBrush(wxNullBrush);
+
+    // Blit the cell of each digit in the value; empty cells are already
+    // covered by the background.
+    for (size_t i = 0; i < m_Columns.GetCount(); i++)
+    {
+        if (m_Columns[i] != 0)
+            DrawColumn(Dc, (int)i - 1, m_Columns[i]);
     }
+}
+
+
+void wxLEDNumberCtrl::CreateBackbuffer(int Width, int Height)
+{
+    if (Width > 0 && Height > 0)
+        m_Backbuffer.Create(Width, Height);
+    else
+        m_Backbuffer = wxNullBitmap;
 
-    // Blit the memory dc to screen.
-    Dc.Blit(0, 0, Width, Height, &MemDc, 0, 0, wxCOPY);
-    delete pMemoryBitmap;
+    m_BackbufferValid = false;
 }
 
 
-void wxLEDNumberCtrl::DrawDigit(wxDC &Dc, int Digit, int Column)
+void wxLEDNumberCtrl::DrawDigit(wxDC &Dc, int Digit, int XPos)
 {
     wxColour LineColor(GetForegroundColour());
 
@@ -259,8 +425,6 @@ void wxLEDNumberCtrl::DrawDigit(wxDC &Dc, int Digit, int Column)
         LineColor.Set(R, G, B);
     }
 
-    int XPos = m_LeftStartPos + Column * (m_LineLength + m_DigitMargin);
-
     // Create a pen and draw the lines.
     wxPen Pen(LineColor, m_LineWidth, wxSOLID);
     Dc.SetPen(Pen);
@@ -388,5 +552,9 @@ void wxLEDNumberCtrl::OnSize(wxSizeEvent &Event)
 {
     RecalcInternals(Event.GetSize());
 
+    int Width, Height;
+    GetClientSize(&Width, &Height);
+    CreateBackbuffer(Width, Height);
+
     Event.Skip();
 }
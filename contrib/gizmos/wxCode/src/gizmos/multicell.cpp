@@ -158,6 +158,13 @@ void wxMultiCellSizer::Initialize( wxSize size )
     }
 
     m_maxWeights = 1 + wxMax(m_cell_count.GetHeight(), m_cell_count.GetWidth());
+    m_rowPos = NULL;
+    m_colPos = NULL;
+    m_minItems = NULL;
+    m_itemMinSizes = NULL;
+    m_minItemCount = 0;
+    m_minimumsValid = false;
+    m_minimumsFresh = false;
     m_defaultCellSize = wxSize(5, 5);
     m_win = NULL;
     m_pen = wxRED_PEN;
@@ -190,6 +197,10 @@ wxMultiCellSizer::~wxMultiCellSizer()
     }
     free(m_weights);
     free(m_minSizes);
+    free(m_rowPos);
+    free(m_colPos);
+    free(m_minItems);
+    delete [] m_itemMinSizes;
 }
 //---------------------------------------------------------------------------
 bool wxMultiCellSizer::EnableGridLines(wxWindow *win)
@@ -208,6 +219,7 @@ bool wxMultiCellSizer::SetGridPen(const wxPen *pen)
 bool wxMultiCellSizer::SetDefaultCellSize(wxSize size)
 {
     m_defaultCellSize = size;
+    m_minimumsValid = false;
     return true;
 }
 //---------------------------------------------------------------------------
@@ -221,6 +233,7 @@ bool wxMultiCellSizer::SetColumnWidth(int column, int colSize, bool expandable)
     {
         m_minSizes[column]->SetWidth(colSize);
     }
+    m_minimumsValid = false;
     return true;
 }
 //---------------------------------------------------------------------------
@@ -234,9 +247,46 @@ bool wxMultiCellSizer::SetRowHeight(int row, int rowSize, bool expandable)
     {
         m_minSizes[row]->SetHeight(rowSize);
     }
+    m_minimumsValid = false;
     return true;
 }
 //---------------------------------------------------------------------------
+wxSizerItem* wxMultiCellSizer::Insert(size_t index, wxSizerItem *item)
+{
+    m_minimumsFresh = false;
+    return wxSizer::Insert(index, item);
+}
+//---------------------------------------------------------------------------
+bool wxMultiCellSizer::Remove(wxSizer *sizer)
+{
+    m_minimumsFresh = false;
+    return wxSizer::Remove(sizer);
+}
+//---------------------------------------------------------------------------
+bool wxMultiCellSizer::Remove(int index)
+{
+    m_minimumsFresh = false;
+    return wxSizer::Remove(index);
+}
+//---------------------------------------------------------------------------
+bool wxMultiCellSizer::Detach(wxWindow *window)
+{
+    m_minimumsFresh = false;
+    return wxSizer::Detach(window);
+}
+//---------------------------------------------------------------------------
+bool wxMultiCellSizer::Detach(wxSizer *sizer)
+{
+    m_minimumsFresh = false;
+    return wxSizer::Detach(sizer);
+}
+//---------------------------------------------------------------------------
+bool wxMultiCellSizer::Detach(int index)
+{
+    m_minimumsFresh = false;
+    return wxSizer::Detach(index);
+}
+//---------------------------------------------------------------------------
 void wxMultiCellSizer::RecalcSizes()
 {
     if (m_children.GetCount() == 0)
@@ -244,7 +294,14 @@ void wxMultiCellSizer::RecalcSizes()
     wxSize size = GetSize();
     wxPoint pos = GetPosition();
 
-    GetMinimums();
+    // Layout calls CalcMin just before, in which case the minimums and the
+    // min sizes of the children are still current.  The children may have
+    // changed behind our back though, if so their count tells.
+    if (!m_minimumsFresh || m_minItemCount != (int)m_children.GetCount())
+    {
+        GetMinimums();
+    }
+    m_minimumsFresh = false;
 
     // We need to take the unused space and equally give it out to all the rows/columns
     // which are stretchable
@@ -257,7 +314,7 @@ void wxMultiCellSizer::RecalcSizes()
 
     for (x = 0; x < wxMax(m_cell_count.GetHeight(), m_cell_count.GetWidth()); x++)
     {
-        if (m_rowStretch[x])
+        if (x < m_cell_count.GetHeight() && m_rowStretch[x])
         {
             totalHeightWeight += m_weights[x]->GetHeight();
         }
@@ -266,26 +323,41 @@ void wxMultiCellSizer::RecalcSizes()
             totalWidthWeight += m_weights[x]->GetWidth();
         }
     }
-    for (x = 0; x < wxMax(m_cell_count.GetHeight(), m_cell_count.GetWidth()); x++)
+
+    // The final height of each row and width of each column go straight into
+    // the offset arrays, so that the position and span of a cell are a
+    // difference of two entries.
+    int *heights = (int *)malloc((1 + m_cell_count.GetHeight()) * sizeof(int));
+    int *widths = (int *)malloc((1 + m_cell_count.GetWidth()) * sizeof(int));
+    for (x = 0; x < m_cell_count.GetHeight(); x++)
     {
-        if (x < m_cell_count.GetHeight() && m_rowStretch[x])
+        heights[x] = m_maxHeight[x];
+        if (m_rowStretch[x])
         {
-            m_maxHeight[x] += unUsedHeight * m_weights[x]->GetHeight() / totalHeightWeight;
+            heights[x] += unUsedHeight * m_weights[x]->GetHeight() / totalHeightWeight;
         }
-        if (x < m_cell_count.GetWidth() && m_colStretch[x])
+    }
+    for (x = 0; x < m_cell_count.GetWidth(); x++)
+    {
+        widths[x] = m_maxWidth[x];
+        if (m_colStretch[x])
         {
-            m_maxWidth[x] += unUsedWidth * m_weights[x]->GetWidth() / totalWidthWeight;
+            widths[x] += unUsedWidth * m_weights[x]->GetWidth() / totalWidthWeight;
         }
     }
+    m_rowPos = PrefixSum(m_rowPos, heights, m_cell_count.GetHeight());
+    m_colPos = PrefixSum(m_colPos, widths, m_cell_count.GetWidth());
+    free(heights);
+    free(widths);
+
     // We now have everything we need to figure each cell position and size
-    // The arrays m_maxHeight and m_maxWidth now contain the final widths and height of
+    // The arrays m_rowPos and m_colPos now contain the final offsets of
     // each row and column.
 
-    double cell_width = (double)size.GetWidth() / (double)m_cell_count.GetWidth();
-    double cell_height = (double)size.GetHeight() / (double)m_cell_count.GetHeight();
     wxPoint c_point;
     wxSize  c_size;
 
+    int index = 0;
     wxSizerItemList::compatibility_iterator current = m_children.GetFirst();
     while (current)
     {
@@ -295,31 +367,21 @@ void wxMultiCellSizer::RecalcSizes()
         if (item != NULL &&
             (rect = (wxMultiCellItemHandle *)item->GetUserData()) != NULL)
         {
-            c_point.x = pos.x + (int)(rect->GetColumn() * cell_width);
-            c_point.y = pos.y + (int)(rect->GetRow() * cell_height);
-
-            c_point.x = pos.x + Sum(m_maxWidth, rect->GetColumn());
-            c_point.y = pos.y + Sum(m_maxHeight, rect->GetRow());
+            int row = rect->GetRow();
+            int col = rect->GetColumn();
+            int lastRow = wxMin(row + rect->GetHeight(), m_cell_count.GetHeight());
+            int lastCol = wxMin(col + rect->GetWidth(), m_cell_count.GetWidth());
 
+            c_point.x = pos.x + m_colPos[col];
+            c_point.y = pos.y + m_rowPos[row];
 
             c_size = rect->GetLocalSize();
-            wxSize minSize( item->CalcMin() );
-            if (c_size.GetHeight() != wxDefaultCoord ||
-                c_size.GetWidth() != wxDefaultCoord)
-            {
-                minSize.SetHeight(wxMax(minSize.GetHeight(), c_size.GetHeight()));
-                minSize.SetWidth(wxMax(minSize.GetWidth(), c_size.GetWidth()));
-            }
+            wxSize minSize( m_itemMinSizes[index] );
             if (rect->GetStyle() & wxHORIZONTAL_RESIZABLE ||
                 rect->GetWidth() > 1
-                || m_minSizes[rect->GetColumn()]->GetWidth() < 0)
+                || m_minSizes[col]->GetWidth() < 0)
             {
-                int w = 0;
-                for (int x = 0; x < rect->GetWidth(); x++)
-                {
-                    w += m_maxWidth[rect->GetColumn() + x];
-                }
-                c_size.SetWidth(w);
+                c_size.SetWidth(m_colPos[lastCol] - m_colPos[col]);
             }
             else
             {
@@ -327,21 +389,16 @@ void wxMultiCellSizer::RecalcSizes()
             }
             if (rect->GetStyle() & wxVERTICAL_RESIZABLE ||
                 rect->GetHeight() > 1 ||
-                m_minSizes[rect->GetRow()]->GetHeight() < 0)
+                m_minSizes[row]->GetHeight() < 0)
             {
-                int h = 0;
-                for (int x = 0; x < rect->GetHeight(); x++)
-                {
-                    h += m_maxHeight[rect->GetRow() + x];
-                }
-                c_size.SetHeight(h);
+                c_size.SetHeight(m_rowPos[lastRow] - m_rowPos[row]);
             }
             else
             {
                 c_size.SetHeight(minSize.GetHeight());
             }
-            int extraHeight = (m_maxHeight[rect->GetRow()] - c_size.GetHeight());
-            int extraWidth = (m_maxWidth[rect->GetColumn()] - c_size.GetWidth());
+            int extraHeight = (m_rowPos[row + 1] - m_rowPos[row] - c_size.GetHeight());
+            int extraWidth = (m_colPos[col + 1] - m_colPos[col] - c_size.GetWidth());
 
             if (rect->GetWidth() == 1 && rect->GetAlignment() & wxALIGN_CENTER_HORIZONTAL)
             {
@@ -362,6 +419,7 @@ void wxMultiCellSizer::RecalcSizes()
             item->SetDimension(c_point, c_size);
         }
         current = current->GetNext();
+        index++;
     }
 }
 //---------------------------------------------------------------------------
@@ -371,6 +429,7 @@ wxSize wxMultiCellSizer::CalcMin()
         return wxSize(10,10);
 
     GetMinimums();
+    m_minimumsFresh = true;
     int m_minWidth = Sum(m_maxWidth, m_cell_count.GetWidth());
     int m_minHeight = Sum(m_maxHeight, m_cell_count.GetHeight());
     return wxSize( m_minWidth, m_minHeight );
@@ -378,6 +437,53 @@ wxSize wxMultiCellSizer::CalcMin()
 //---------------------------------------------------------------------------
 void wxMultiCellSizer :: GetMinimums()
 {
+    // First get the min size of every child. The row and column minimums
+    // only have to be recalculated when one of them (or the list of
+    // children) changed since the last time.
+
+    bool minSizesChanged = !m_minimumsValid;
+    int count = m_children.GetCount();
+    if (count != m_minItemCount)
+    {
+        m_minItems = (wxSizerItem **)realloc(m_minItems, count * sizeof(wxSizerItem *));
+        delete [] m_itemMinSizes;
+        m_itemMinSizes = new wxSize[count];
+        m_minItemCount = count;
+        minSizesChanged = true;
+    }
+
+    int index = 0;
+    wxSizerItemList::compatibility_iterator     node = m_children.GetFirst();
+    while (node)
+    {
+        wxSizerItem     *item = node->GetData();
+        wxMultiCellItemHandle *rect;
+        wxSize minSize;
+        if (item != NULL &&
+            (rect = (wxMultiCellItemHandle *)item->GetUserData()) != NULL)
+        {
+            minSize = item->CalcMin();
+            wxSize c_size = rect->GetLocalSize();
+            if (c_size.GetHeight() != wxDefaultCoord ||
+                c_size.GetWidth() != wxDefaultCoord)
+            {
+                minSize.SetHeight(wxMax(minSize.GetHeight(), c_size.GetHeight()));
+                minSize.SetWidth(wxMax(minSize.GetWidth(), c_size.GetWidth()));
+            }
+        }
+        if (m_minItems[index] != item || m_itemMinSizes[index] != minSize)
+        {
+            m_minItems[index] = item;
+            m_itemMinSizes[index] = minSize;
+            minSizesChanged = true;
+        }
+        node = node->GetNext();
+        index++;
+    }
+
+    if (!minSizesChanged)
+        return;
+
     // We first initial all the arrays EXCEPT for the m_minsizes array.
 
     memset(m_maxHeight, 0, sizeof(int) * m_cell_count.GetHeight());
@@ -390,7 +496,8 @@ void wxMultiCellSizer :: GetMinimums()
         m_weights[x]->SetWidth(0);
     }
 
-    wxSizerItemList::compatibility_iterator     node = m_children.GetFirst();
+    index = 0;
+    node = m_children.GetFirst();
     while (node)
     {
         wxSizerItem     *item = node->GetData();
@@ -411,8 +518,8 @@ void wxMultiCellSizer :: GetMinimums()
                 m_rowStretch = (int *)realloc(m_rowStretch, (1 + row) * sizeof(int));
                 for (int x = m_cell_count.GetHeight(); x < row + 1; x++)
                 {
-                    m_maxHeight[x - 1] = 0;
-                    m_rowStretch[x - 1] = 0;
+                    m_maxHeight[x] = 0;
+                    m_rowStretch[x] = 0;
                 }
                 m_cell_count.SetHeight(row + 1);
             }
@@ -423,8 +530,8 @@ void wxMultiCellSizer :: GetMinimums()
                 m_colStretch = (int *)realloc(m_colStretch, ( 1 + col) * sizeof(int));
                 for (int x = m_cell_count.GetWidth(); x < col + 1; x++)
                 {
-                    m_maxWidth[x - 1] = 0;
-                    m_colStretch[x - 1] = 0;
+                    m_maxWidth[x] = 0;
+                    m_colStretch[x] = 0;
                 }
                 m_cell_count.SetWidth(col + 1);
             }
@@ -434,22 +541,15 @@ void wxMultiCellSizer :: GetMinimums()
                 m_minSizes = (wxSize **)realloc(m_minSizes, (1 + wxMax(m_cell_count.GetHeight(), m_cell_count.GetWidth())) * sizeof(wxSize *));
                 for (int x = m_maxWeights; x < 1 + wxMax(m_cell_count.GetHeight(), m_cell_count.GetWidth()); x++)
                 {
-                    m_weights[x - 1] = new wxSize(0,0);
-                    m_minSizes[x - 1] = new wxSize(0,0);
+                    m_weights[x] = new wxSize(0,0);
+                    m_minSizes[x] = new wxSize(0,0);
                 }
                 m_maxWeights = 1 + wxMax(m_cell_count.GetHeight(), m_cell_count.GetWidth());
             }
 
             // Sum the m_weights for each row/column, but only if they are resizable
 
-            wxSize minSize( item->CalcMin() );
-            wxSize c_size = rect->GetLocalSize();
-            if (c_size.GetHeight() != wxDefaultCoord ||
-                c_size.GetWidth() != wxDefaultCoord)
-            {
-                minSize.SetHeight(wxMax(minSize.GetHeight(), c_size.GetHeight()));
-                minSize.SetWidth(wxMax(minSize.GetWidth(), c_size.GetWidth()));
-            }
+            wxSize minSize( m_itemMinSizes[index] );
 
             // For each row, calculate the max height for those fields which are not
             // resizable in the vertical pane
@@ -492,9 +592,12 @@ void wxMultiCellSizer :: GetMinimums()
                 m_maxWidth[col] = wxMax(m_maxWidth[col], m_defaultCellSize.GetWidth());
                 m_weights[col]->SetWidth(wxMax(m_weights[col]->GetWidth(), rect->GetWeight().GetWidth()));
             }
-            node = node->GetNext();
         }
+        node = node->GetNext();
+        index++;
     }
+
+    m_minimumsValid = true;
 } // wxMultiCellSizer :: GetMinimums
 //---------------------------------------------------------------------------
 /*
@@ -520,6 +623,32 @@ void wxMultiCellSizer :: GetMinimums()
     return sum;
 }
 //---------------------------------------------------------------------------
+/*
+ *Function Name: wxMultiCellSizer :: PrefixSum
+ *
+ *Parameters:    int* array of count + 1 ints to store the sums in, or NULL
+ *               int* pointer to array of ints
+ *               int  Number of cells
+ *
+ *Description:   This member function stores in each element of the first
+ *               array the sum of the elements of the second array which
+ *               preceed that cell, so that Sum(array, x) == sums[x].
+ *
+ *Returns:       int* The (possibly reallocated) array of sums
+ *
+ */
+
+/* static */ int *wxMultiCellSizer :: PrefixSum(int *sums, int *array, int count)
+{
+    sums = (int *)realloc(sums, (1 + count) * sizeof(int));
+    sums[0] = 0;
+    for (int x = 0; x < count; x++)
+    {
+        sums[x + 1] = sums[x] + array[x];
+    }
+    return sums;
+}
+//---------------------------------------------------------------------------
 /*
  *Function Name: wxMultiCellSizer :: DrawGridLines
  *
@@ -532,22 +661,24 @@ void wxMultiCellSizer :: GetMinimums()
 void wxMultiCellSizer :: DrawGridLines(wxDC& dc)
 {
     RecalcSizes();
-    int maxW = Sum(m_maxWidth, m_cell_count.GetWidth());
-    int maxH = Sum(m_maxHeight, m_cell_count.GetHeight());
+    if (!m_colPos || !m_rowPos)
+        return;
+    int maxW = m_colPos[m_cell_count.GetWidth()];
+    int maxH = m_rowPos[m_cell_count.GetHeight()];
     int x;
 
     // Draw the columns
     dc.SetPen(* m_pen);
     for (x = 1; x < m_cell_count.GetWidth(); x++)
     {
-        int colPos = Sum(m_maxWidth, x) ;
+        int colPos = m_colPos[x];
         dc.DrawLine(colPos, 0, colPos, maxH);
     }
 
     // Draw the rows
     for (x = 1; x < m_cell_count.GetHeight(); x++)
     {
-        int rowPos = Sum(m_maxHeight, x);
+        int rowPos = m_rowPos[x];
         dc.DrawLine(0, rowPos, maxW, rowPos);
     }
 }
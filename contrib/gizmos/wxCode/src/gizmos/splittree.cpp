@@ -59,6 +59,7 @@ BEGIN_EVENT_TABLE(wxRemotelyScrolledTreeCtrl, wxTreeCtrl)
     EVT_PAINT(wxRemotelyScrolledTreeCtrl::OnPaint)
     EVT_TREE_ITEM_EXPANDED(wxID_ANY, wxRemotelyScrolledTreeCtrl::OnExpand)
     EVT_TREE_ITEM_COLLAPSED(wxID_ANY, wxRemotelyScrolledTreeCtrl::OnExpand)
+    EVT_TREE_DELETE_ITEM(wxID_ANY, wxRemotelyScrolledTreeCtrl::OnDeleteItem)
     EVT_SCROLLWIN(wxRemotelyScrolledTreeCtrl::OnScroll)
 END_EVENT_TABLE()
 
@@ -74,6 +75,10 @@ wxRemotelyScrolledTreeCtrl::wxRemotelyScrolledTreeCtrl(
     // off above, so wxGenericTreeCtrl doesn't draw them in a
     // different colour.
     m_drawRowLines = (style & wxTR_ROW_LINES) != 0;
+
+    m_visibleRowsHeight = 0;
+    m_visibleRowsValid = false;
+    m_rowPitch = 0;
 }
 
 wxRemotelyScrolledTreeCtrl::~wxRemotelyScrolledTreeCtrl()
@@ -259,6 +264,7 @@ void wxRemotelyScrolledTreeCtrl::ScrollToLine(int WXUNUSED(posHoriz), int posVer
 
 void wxRemotelyScrolledTreeCtrl::OnSize(wxSizeEvent& event)
 {
+    m_visibleRowsValid = false;
     HideVScrollbar();
     AdjustRemoteScrollbars();
     event.Skip();
@@ -266,6 +272,28 @@ void wxRemotelyScrolledTreeCtrl::OnSize(wxSizeEvent& event)
 
 void wxRemotelyScrolledTreeCtrl::OnExpand(wxTreeEvent& event)
 {
+    // Add or remove the rows of the subtree from the counts of the
+    // ancestors, unless that has already been done for this item.
+    wxTreeItemId id = event.GetItem();
+    if (id.IsOk())
+    {
+        void* key = id.GetID();
+        if (event.GetEventType() == wxEVT_COMMAND_TREE_ITEM_EXPANDED)
+        {
+            if (m_expandedItems.find(key) == m_expandedItems.end())
+            {
+                m_expandedItems.insert(key);
+                AdjustRowCounts(id, GetSubtreeRowCount(id));
+            }
+        }
+        else if (m_expandedItems.find(key) != m_expandedItems.end())
+        {
+            m_expandedItems.erase(key);
+            AdjustRowCounts(id, - GetSubtreeRowCount(id));
+        }
+    }
+    m_visibleRowsValid = false;
+
     AdjustRemoteScrollbars();
     event.Skip();
 
@@ -295,26 +323,207 @@ void wxRemotelyScrolledTreeCtrl::OnPaint(wxPaintEvent& event)
     dc.SetBrush(* wxTRANSPARENT_BRUSH);
 
     wxSize clientSize = GetClientSize();
-    wxRect itemRect;
-    wxTreeItemId h, lastH;
-    for (h=GetFirstVisibleItem();
-         h.IsOk();
-         h=GetNextVisible(h))
+    const wxArrayTreeItemIds& rows = GetVisibleRows();
+    const wxArrayInt& tops = GetVisibleRowTops();
+    for (size_t i = 0; i < rows.GetCount(); i++)
+    {
+        int cy = tops[i];
+        dc.DrawLine(0, cy, clientSize.x, cy);
+    }
+    if (rows.GetCount() > 0)
+    {
+        int cy = tops[rows.GetCount()] - 1;
+        dc.DrawLine(0, cy, clientSize.x, cy);
+    }
+}
+
+void wxRemotelyScrolledTreeCtrl::OnDeleteItem(wxTreeEvent& event)
+{
+    // Deleted items may be anywhere in the counted subtrees, and their ids
+    // may be reused, so just start counting again when next needed.
+    InvalidateRowCounts();
+    event.Skip();
+}
+
+wxTreeItemId wxRemotelyScrolledTreeCtrl::DoInsertItem(const wxTreeItemId& parent,
+                                                      size_t pos,
+                                                      const wxString& text,
+                                                      int image, int selImage,
+                                                      wxTreeItemData *data)
+{
+    wxTreeItemId id = wxTreeCtrl::DoInsertItem(parent, pos, text, image, selImage, data);
+    ItemInserted(id);
+    return id;
+}
+
+wxTreeItemId wxRemotelyScrolledTreeCtrl::DoInsertAfter(const wxTreeItemId& parent,
+                                                       const wxTreeItemId& idPrevious,
+                                                       const wxString& text,
+                                                       int image, int selImage,
+                                                       wxTreeItemData *data)
+{
+    wxTreeItemId id = wxTreeCtrl::DoInsertAfter(parent, idPrevious, text, image, selImage, data);
+    ItemInserted(id);
+    return id;
+}
+
+void wxRemotelyScrolledTreeCtrl::ItemInserted(const wxTreeItemId& id)
+{
+    if (!id.IsOk())
+        return;
+
+    // A new item adds a single row to its parent, and to each ancestor
+    // the parent is shown under
+    AdjustRowCounts(id, 1);
+    m_visibleRowsValid = false;
+}
+
+bool wxRemotelyScrolledTreeCtrl::IsHiddenRoot(const wxTreeItemId& id) const
+{
+    return HasFlag(wxTR_HIDE_ROOT) && id == GetRootItem();
+}
+
+// Number of rows below the item when it is expanded. Computed on demand,
+// which only visits the expanded parts of the subtree, and then kept up to
+// date by AdjustRowCounts.
+int wxRemotelyScrolledTreeCtrl::GetSubtreeRowCount(const wxTreeItemId& id)
+{
+    wxTreeRowCountMap::iterator it = m_rowCounts.find(id.GetID());
+    if (it != m_rowCounts.end())
+        return it->second;
+
+    int count = 0;
+    wxTreeItemIdValue cookie;
+    wxTreeItemId childId = GetFirstChild(id, cookie);
+    while (childId)
     {
-        if (GetBoundingRect(h, itemRect))
+        count++;
+        if (IsExpanded(childId))
         {
-            int cy = itemRect.GetTop();
-            dc.DrawLine(0, cy, clientSize.x, cy);
-            lastH = h;
+            m_expandedItems.insert(childId.GetID());
+            count += GetSubtreeRowCount(childId);
         }
-        if (! IsVisible(h))
+        childId = GetNextChild(id, cookie);
+    }
+
+    m_rowCounts[id.GetID()] = count;
+    return count;
+}
+
+// Add delta rows below the given item to the counts of its ancestors, going
+// up as long as the rows are shown under the ancestor.
+void wxRemotelyScrolledTreeCtrl::AdjustRowCounts(const wxTreeItemId& id, int delta)
+{
+    wxTreeItemId parent = GetItemParent(id);
+    while (parent.IsOk())
+    {
+        wxTreeRowCountMap::iterator it = m_rowCounts.find(parent.GetID());
+        if (it != m_rowCounts.end())
+            it->second += delta;
+
+        if (!IsExpanded(parent) && !IsHiddenRoot(parent))
             break;
+        parent = GetItemParent(parent);
     }
-    if (lastH.IsOk() && GetBoundingRect(lastH, itemRect))
+}
+
+void wxRemotelyScrolledTreeCtrl::InvalidateRowCounts()
+{
+    if (!m_rowCounts.empty())
+        m_rowCounts.clear();
+    if (!m_expandedItems.empty())
+        m_expandedItems.clear();
+    m_visibleRowsValid = false;
+}
+
+int wxRemotelyScrolledTreeCtrl::GetTotalRowCount()
+{
+    wxTreeItemId root = GetRootItem();
+    if (!root.IsOk())
+        return 0;
+
+    if (IsHiddenRoot(root))
+        return GetSubtreeRowCount(root);
+    if (!IsExpanded(root))
+        return 1;
+
+    m_expandedItems.insert(root.GetID());
+    return 1 + GetSubtreeRowCount(root);
+}
+
+const wxArrayTreeItemIds& wxRemotelyScrolledTreeCtrl::GetVisibleRows()
+{
+    UpdateVisibleRows();
+    return m_visibleRows;
+}
+
+const wxArrayInt& wxRemotelyScrolledTreeCtrl::GetVisibleRowTops()
+{
+    UpdateVisibleRows();
+    return m_visibleRowTops;
+}
+
+// Rebuild the list of rows in the client area if the tree has changed or
+// scrolled since it was last built.
+void wxRemotelyScrolledTreeCtrl::UpdateVisibleRows()
+{
+    wxSize clientSize = GetClientSize();
+    wxTreeItemId first = GetFirstVisibleItem();
+    wxRect firstRect;
+    if (!first.IsOk() || !GetBoundingRect(first, firstRect))
     {
-        int cy = itemRect.GetBottom();
-        dc.DrawLine(0, cy, clientSize.x, cy);
+        m_visibleRows.Empty();
+        m_visibleRowTops.Empty();
+        m_visibleRowsValid = false;
+        return;
+    }
+
+    // Scrolling changes the first row or its position, so that is all that
+    // needs checking besides the explicit invalidations.
+    if (m_visibleRowsValid && clientSize.y == m_visibleRowsHeight &&
+        m_visibleRows.GetCount() > 0 && m_visibleRows[0] == first &&
+        m_visibleRowTops[0] == firstRect.y)
+        return;
+
+    m_visibleRows.Empty();
+    m_visibleRowTops.Empty();
+
+    // Unless rows can differ in height, only the first two bounding
+    // rectangles are needed: the distance between them is the row pitch
+    // (which can be less than the reported item height).
+    const bool variableHeight = HasFlag(wxTR_HAS_VARIABLE_ROW_HEIGHT);
+    m_rowPitch = firstRect.height;
+
+    int y = firstRect.y;
+    int height = firstRect.height;
+    wxRect itemRect;
+    wxTreeItemId h = first;
+    while (h.IsOk() && y < clientSize.y)
+    {
+        m_visibleRows.Add(h);
+        m_visibleRowTops.Add(y);
+
+        // The item must be visible to ask for the next one
+        h = GetNextVisible(h);
+        if (h.IsOk() && (variableHeight || m_visibleRows.GetCount() == 1))
+        {
+            if (!GetBoundingRect(h, itemRect))
+            {
+                y += height;
+                break;
+            }
+            if (m_visibleRows.GetCount() == 1)
+                m_rowPitch = itemRect.y - y;
+            y = itemRect.y;
+            height = itemRect.height;
+        }
+        else
+            y += variableHeight ? height : m_rowPitch;
     }
+    m_visibleRowTops.Add(y);
+
+    m_visibleRowsHeight = clientSize.y;
+    m_visibleRowsValid = true;
 }
 
 
@@ -395,6 +604,18 @@ static wxRect CombineRectangles(const wxRect& rect1, const wxRect& rect2)
 // correctly
 void wxRemotelyScrolledTreeCtrl::CalcTreeSize(wxRect& rect)
 {
+    // With rows of equal height this follows from the row count, which is
+    // kept up to date as subtrees are expanded and collapsed.
+    if (!HasFlag(wxTR_HAS_VARIABLE_ROW_HEIGHT))
+    {
+        UpdateVisibleRows();
+        if (m_visibleRowsValid && m_rowPitch > 0)
+        {
+            rect = wxRect(0, 0, GetClientSize().x, GetTotalRowCount() * m_rowPitch);
+            return;
+        }
+    }
+
     CalcTreeSize(GetRootItem(), rect);
 }
 
@@ -507,30 +728,23 @@ void wxTreeCompanionWindow::OnPaint(wxPaintEvent& WXUNUSED(event))
     wxFont font(wxSystemSettings::GetFont(wxSYS_DEFAULT_GUI_FONT));
     dc.SetFont(font);
 
+    // Paint from the rows cached by the tree rather than asking it for the
+    // rectangle of each item.
     wxSize clientSize = GetClientSize();
-    wxRect itemRect;
-    wxTreeItemId h, lastH;
-    for (h=m_treeCtrl->GetFirstVisibleItem();
-         h.IsOk();
-         h=m_treeCtrl->GetNextVisible(h))
+    const wxArrayTreeItemIds& rows = m_treeCtrl->GetVisibleRows();
+    const wxArrayInt& tops = m_treeCtrl->GetVisibleRowTops();
+    for (size_t i = 0; i < rows.GetCount(); i++)
     {
-        if (m_treeCtrl->GetBoundingRect(h, itemRect))
-        {
-            int cy = itemRect.GetTop();
-            wxRect drawItemRect(0, cy, clientSize.x, itemRect.GetHeight());
-
-            lastH = h;
+        int cy = tops[i];
+        wxRect drawItemRect(0, cy, clientSize.x, tops[i + 1] - cy);
 
-            // Draw the actual item
-            DrawItem(dc, h, drawItemRect);
-            dc.DrawLine(0, cy, clientSize.x, cy);
-        }
-        if (! m_treeCtrl->IsVisible(h))
-            break;
+        // Draw the actual item
+        DrawItem(dc, rows[i], drawItemRect);
+        dc.DrawLine(0, cy, clientSize.x, cy);
     }
-    if (lastH.IsOk() && m_treeCtrl->GetBoundingRect(lastH, itemRect))
+    if (rows.GetCount() > 0)
     {
-        int cy = itemRect.GetBottom();
+        int cy = tops[rows.GetCount()] - 1;
         dc.DrawLine(0, cy, clientSize.x, cy);
     }
 }
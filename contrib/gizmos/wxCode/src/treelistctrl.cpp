@@ -35,6 +35,9 @@
 #include <wx/dcscreen.h>
 #include <wx/dcmemory.h>
 #include <wx/scrolwin.h>
+#if wxUSE_THREADS
+#include <wx/thread.h>
+#endif
 #if wxCHECK_VERSION(2, 7, 0)
 #include <wx/renderer.h>
 #endif
@@ -63,6 +66,473 @@ WX_DECLARE_OBJARRAY(wxTreeListColumnInfo, wxArrayTreeListColumnInfo);
 #include <wx/arrimpl.cpp>
 WX_DEFINE_OBJARRAY(wxArrayTreeListColumnInfo);
 
+#include <wx/hashmap.h>
+WX_DECLARE_HASH_MAP(size_t, wxTreeListItem*, wxIntegerHash, wxIntegerEqual, wxTreeListIndexItemMap);
+WX_DECLARE_HASH_MAP(wxTreeListItem*, size_t, wxPointerHash, wxPointerEqual, wxTreeListItemIndexMap);
+
+// children of an item which are only given by their count, see
+// wxTreeListCtrl::SetVirtualChildrenCount(), only those in use exist
+class wxTreeListVirtualChildren
+{
+public:
+    wxTreeListVirtualChildren (size_t count) : m_count (count) {}
+
+    size_t                 m_count;   // number of children
+    wxTreeListIndexItemMap m_items;   // the existing children by index
+    wxTreeListItemIndexMap m_indices; // and the index of each of them
+    wxArrayInt             m_runs;    // its runs in the layout, in order
+};
+
+WX_DECLARE_HASH_MAP(wxTreeListItem*, wxTreeListVirtualChildren*, wxPointerHash, wxPointerEqual, wxTreeListVirtualMap);
+
+// consecutive collapsed virtual children, laid out as a block of rows
+// without creating the items
+class wxTreeListVirtualRun
+{
+public:
+    wxTreeListItem *m_parent;
+    size_t          m_first;  // index of the first child of the run
+    size_t          m_count;
+    int             m_x;      // position of the children
+    int             m_y;
+};
+
+WX_DECLARE_OBJARRAY(wxTreeListVirtualRun, wxArrayTreeListVirtualRuns);
+WX_DEFINE_OBJARRAY(wxArrayTreeListVirtualRuns);
+
+// the find index of a column: the lower case texts of all items, ordered by
+// text and then by item for a search of the items starting with a given
+// text. It is a treap counting the entries of each subtree, so an entry is
+// added or removed in O(log n) and the n-th entry is found in O(log n); the
+// entries are found by item for their removal
+class wxTreeListFindNode
+{
+public:
+    wxTreeListFindNode (const wxString& key, wxTreeListItem *item, unsigned priority)
+        : m_key (key), m_item (item), m_priority (priority), m_size (1),
+          m_left (NULL), m_right (NULL) {}
+
+    wxString            m_key;
+    wxTreeListItem     *m_item;
+    unsigned            m_priority; // heap ordered, at random
+    size_t              m_size;     // number of entries of the subtree
+    wxTreeListFindNode *m_left;
+    wxTreeListFindNode *m_right;
+};
+
+WX_DECLARE_HASH_MAP(wxTreeListItem*, wxTreeListFindNode*, wxPointerHash, wxPointerEqual, wxTreeListFindNodeMap);
+
+class wxTreeListFindIndex
+{
+public:
+    wxTreeListFindIndex() : m_root (NULL), m_seed (2463534242u) {}
+    ~wxTreeListFindIndex() { Clear(); }
+
+    size_t GetCount() const { return Size (m_root); }
+    void Add (const wxString& key, wxTreeListItem *item);
+    void Remove (wxTreeListItem *item);
+    void Clear();
+
+    // number of entries before the ones with the key, or before the end
+    // of them (matches: entries starting with it if partial)
+    size_t Rank (const wxString& key, bool end, bool partial) const;
+    // the item of the n-th entry
+    wxTreeListItem *Item (size_t n) const;
+
+private:
+    static size_t Size (wxTreeListFindNode *node) { return node? node->m_size: 0; }
+    static void Update (wxTreeListFindNode *node)
+        { node->m_size = Size (node->m_left) + Size (node->m_right) + 1; }
+    static int Compare (const wxTreeListFindNode *a, const wxTreeListFindNode *b);
+    static void Split (wxTreeListFindNode *node, const wxTreeListFindNode *at,
+                       wxTreeListFindNode *&left, wxTreeListFindNode *&right);
+    static wxTreeListFindNode *Merge (wxTreeListFindNode *left, wxTreeListFindNode *right);
+    static wxTreeListFindNode *Insert (wxTreeListFindNode *node, wxTreeListFindNode *entry);
+    static wxTreeListFindNode *Erase (wxTreeListFindNode *node, wxTreeListFindNode *entry);
+
+    wxTreeListFindNode   *m_root;
+    wxTreeListFindNodeMap m_nodes;
+    unsigned              m_seed;
+};
+
+int wxTreeListFindIndex::Compare (const wxTreeListFindNode *a, const wxTreeListFindNode *b) {
+    int cmp = a->m_key.Cmp (b->m_key);
+    if (cmp != 0) return cmp;
+    wxUIntPtr pa = (wxUIntPtr)a->m_item, pb = (wxUIntPtr)b->m_item;
+    return (pa < pb)? -1: (pa > pb)? 1: 0;
+}
+
+// left gets the entries before at, right the others
+void wxTreeListFindIndex::Split (wxTreeListFindNode *node, const wxTreeListFindNode *at,
+                                 wxTreeListFindNode *&left, wxTreeListFindNode *&right) {
+    if (!node) {
+        left = right = NULL;
+        return;
+    }
+    if (Compare (node, at) < 0) {
+        Split (node->m_right, at, node->m_right, right);
+        left = node;
+    }else{
+        Split (node->m_left, at, left, node->m_left);
+        right = node;
+    }
+    Update (node);
+}
+
+wxTreeListFindNode *wxTreeListFindIndex::Merge (wxTreeListFindNode *left, wxTreeListFindNode *right) {
+    if (!left) return right;
+    if (!right) return left;
+    if (left->m_priority > right->m_priority) {
+        left->m_right = Merge (left->m_right, right);
+        Update (left);
+        return left;
+    }
+    right->m_left = Merge (left, right->m_left);
+    Update (right);
+    return right;
+}
+
+wxTreeListFindNode *wxTreeListFindIndex::Insert (wxTreeListFindNode *node, wxTreeListFindNode *entry) {
+    if (!node) return entry;
+    if (entry->m_priority > node->m_priority) {
+        Split (node, entry, entry->m_left, entry->m_right);
+        Update (entry);
+        return entry;
+    }
+    if (Compare (entry, node) < 0) {
+        node->m_left = Insert (node->m_left, entry);
+    }else{
+        node->m_right = Insert (node->m_right, entry);
+    }
+    Update (node);
+    return node;
+}
+
+wxTreeListFindNode *wxTreeListFindIndex::Erase (wxTreeListFindNode *node, wxTreeListFindNode *entry) {
+    if (node == entry) return Merge (node->m_left, node->m_right);
+    if (Compare (entry, node) < 0) {
+        node->m_left = Erase (node->m_left, entry);
+    }else{
+        node->m_right = Erase (node->m_right, entry);
+    }
+    Update (node);
+    return node;
+}
+
+void wxTreeListFindIndex::Add (const wxString& key, wxTreeListItem *item) {
+    // xorshift, the priorities only have to be spread evenly
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    wxTreeListFindNode *entry = new wxTreeListFindNode (key, item, m_seed);
+    m_nodes[item] = entry;
+    m_root = Insert (m_root, entry);
+}
+
+void wxTreeListFindIndex::Remove (wxTreeListItem *item) {
+    wxTreeListFindNodeMap::iterator it = m_nodes.find (item);
+    if (it == m_nodes.end()) return;
+    wxTreeListFindNode *entry = it->second;
+    m_nodes.erase (it);
+    m_root = Erase (m_root, entry);
+    delete entry;
+}
+
+void wxTreeListFindIndex::Clear() {
+    wxTreeListFindNodeMap::iterator it;
+    for (it = m_nodes.begin(); it != m_nodes.end(); ++it) delete it->second;
+    m_nodes.clear();
+    m_root = NULL;
+}
+
+size_t wxTreeListFindIndex::Rank (const wxString& key, bool end, bool partial) const {
+    // the entries counted come first in the order, hence one descent
+    size_t rank = 0;
+    wxTreeListFindNode *node = m_root;
+    while (node) {
+        int cmp = node->m_key.Cmp (key);
+        bool before = cmp < 0;
+        if (end && !before) before = partial? node->m_key.StartsWith (key): (cmp == 0);
+        if (before) {
+            rank += Size (node->m_left) + 1;
+            node = node->m_right;
+        }else{
+            node = node->m_left;
+        }
+    }
+    return rank;
+}
+
+wxTreeListItem *wxTreeListFindIndex::Item (size_t n) const {
+    wxTreeListFindNode *node = m_root;
+    while (node) {
+        size_t left = Size (node->m_left);
+        if (n < left) {
+            node = node->m_left;
+        }else if (n == left) {
+            return node->m_item;
+        }else{
+            n -= left + 1;
+            node = node->m_right;
+        }
+    }
+    return (wxTreeListItem*)NULL;
+}
+
+WX_DECLARE_HASH_MAP(int, wxTreeListFindIndex*, wxIntegerHash, wxIntegerEqual, wxTreeListFindIndexMap);
+
+// the text extents measured with one font at one scale, the least recently
+// used ones are forgotten first when there are too many. The font is kept
+// referenced so its data can't be reused by another font meanwhile
+class wxTreeListExtent
+{
+public:
+    wxTreeListExtent (const wxString& text, const wxSize& size)
+        : m_text (text), m_size (size), m_prev (NULL), m_next (NULL) {}
+
+    wxString          m_text;
+    wxSize            m_size;
+    wxTreeListExtent *m_prev;  // the one used more recently
+    wxTreeListExtent *m_next;
+};
+
+WX_DECLARE_STRING_HASH_MAP(wxTreeListExtent*, wxTreeListExtentMap);
+
+class wxTreeListFontExtents
+{
+public:
+    wxTreeListFontExtents (const wxFont& font, double scaleX, double scaleY)
+        : m_font (font), m_scaleX (scaleX), m_scaleY (scaleY),
+          m_first (NULL), m_last (NULL) {}
+    ~wxTreeListFontExtents() {
+        wxTreeListExtentMap::iterator it;
+        for (it = m_extents.begin(); it != m_extents.end(); ++it) delete it->second;
+    }
+
+    // the extent of the text, or NULL if it isn't known
+    const wxSize *Find (const wxString& text) {
+        wxTreeListExtentMap::iterator it = m_extents.find (text);
+        if (it == m_extents.end()) return (const wxSize*)NULL;
+        Unlink (it->second);
+        Link (it->second);
+        return &it->second->m_size;
+    }
+    void Store (const wxString& text, const wxSize& size, size_t maxStrings) {
+        if ((m_extents.size() >= maxStrings) && m_last) {
+            wxTreeListExtent *old = m_last;
+            Unlink (old);
+            m_extents.erase (old->m_text);
+            delete old;
+        }
+        wxTreeListExtent *extent = new wxTreeListExtent (text, size);
+        m_extents[text] = extent;
+        Link (extent);
+    }
+
+    wxFont              m_font;
+    double              m_scaleX, m_scaleY;
+
+private:
+    void Link (wxTreeListExtent *extent) {
+        extent->m_prev = NULL;
+        extent->m_next = m_first;
+        if (m_first) m_first->m_prev = extent; else m_last = extent;
+        m_first = extent;
+    }
+    void Unlink (wxTreeListExtent *extent) {
+        if (extent->m_prev) extent->m_prev->m_next = extent->m_next; else m_first = extent->m_next;
+        if (extent->m_next) extent->m_next->m_prev = extent->m_prev; else m_last = extent->m_prev;
+    }
+
+    wxTreeListExtentMap m_extents;
+    wxTreeListExtent   *m_first;  // most recently used
+    wxTreeListExtent   *m_last;   // least recently used
+};
+
+WX_DEFINE_ARRAY_PTR(wxTreeListFontExtents*, wxArrayTreeListFontExtents);
+
+// the extents of the texts of a control by font, scale and text. A DC
+// measures in logical units, so the product of its user and logical scales
+// is part of the key. The fonts used least recently are forgotten first too
+class wxTreeListExtentCache
+{
+public:
+    wxTreeListExtentCache (size_t maxStrings = 4096) : m_maxStrings (maxStrings) {}
+    ~wxTreeListExtentCache() { Clear(); }
+
+    // measure the text with the current font of the dc
+    void GetTextExtent (wxDC& dc, const wxString& text, wxCoord *w, wxCoord *h) {
+        double userX, userY, logicalX, logicalY;
+        dc.GetUserScale (&userX, &userY);
+        dc.GetLogicalScale (&logicalX, &logicalY);
+        wxTreeListFontExtents *extents = GetExtents (dc.GetFont(), userX*logicalX, userY*logicalY);
+        const wxSize *size = extents->Find (text);
+        wxSize measured;
+        if (!size) {
+            dc.GetTextExtent (text, &measured.x, &measured.y);
+            extents->Store (text, measured, m_maxStrings);
+            size = &measured;
+        }
+        if (w) *w = size->x;
+        if (h) *h = size->y;
+    }
+
+    // measure the text with the given font through the window, which
+    // measures in device units
+    void GetTextExtent (wxWindow *win, const wxFont& font, const wxString& text,
+                        wxCoord *w, wxCoord *h) {
+        wxTreeListFontExtents *extents = GetExtents (font, 1.0, 1.0);
+        const wxSize *size = extents->Find (text);
+        wxSize measured;
+        if (!size) {
+            win->GetTextExtent (text, &measured.x, &measured.y, NULL, NULL, &font);
+            extents->Store (text, measured, m_maxStrings);
+            size = &measured;
+        }
+        if (w) *w = size->x;
+        if (h) *h = size->y;
+    }
+
+    void Clear() {
+        for (size_t n = 0; n < m_fonts.GetCount(); ++n) delete m_fonts[n];
+        m_fonts.Empty();
+    }
+
+private:
+    enum { MAX_FONTS = 8 };
+
+    // the most recently used font is kept last
+    wxTreeListFontExtents *GetExtents (const wxFont& font, double scaleX, double scaleY) {
+        size_t count = m_fonts.GetCount();
+        for (size_t n = count; n > 0; --n) {
+            wxTreeListFontExtents *extents = m_fonts[n-1];
+            if ((extents->m_font.GetRefData() == font.GetRefData()) &&
+                (extents->m_scaleX == scaleX) && (extents->m_scaleY == scaleY)) {
+                if (n < count) {
+                    m_fonts.RemoveAt (n-1);
+                    m_fonts.Add (extents);
+                }
+                return extents;
+            }
+        }
+        if (count >= MAX_FONTS) {
+            delete m_fonts[0];
+            m_fonts.RemoveAt (0);
+        }
+        m_fonts.Add (new wxTreeListFontExtents (font, scaleX, scaleY));
+        return m_fonts.Last();
+    }
+
+    wxArrayTreeListFontExtents m_fonts;
+    size_t                     m_maxStrings; // per font
+};
+
+static int wxCMPFUNC_CONV wxTreeListCompareIndices (long *first, long *second)
+{
+    return (*first < *second)? -1: (*first > *second)? 1: 0;
+}
+
+// stable merge sort of the child indices 0..n-1, the order is given by the
+// derived classes, no global state is used so sorts may be nested
+class wxTreeListSorter
+{
+public:
+    virtual ~wxTreeListSorter() {}
+
+    virtual size_t GetCount() const = 0;
+    virtual int Compare (int first, int second) const = 0;
+    // false once the elements compared can't be trusted any more, the sort
+    // then stops without comparing them again
+    virtual bool IsValid() const { return true; }
+
+    // returns false if the sort was stopped, order is incomplete then
+    bool Sort (wxArrayInt& order) const
+    {
+        size_t count = GetCount();
+        order.Empty();
+        order.Alloc (count);
+        for (size_t n = 0; n < count; ++n) order.Add ((int)n);
+        if (count < 2) return true;
+        int *tmp = new int[count];
+        bool done = MergeSort (&order[0], tmp, count);
+        delete [] tmp;
+        return done;
+    }
+
+private:
+    bool MergeSort (int *order, int *tmp, size_t count) const
+    {
+        if (count < 2) return true;
+        size_t half = count / 2;
+        if (!MergeSort (order, tmp, half)) return false;
+        if (!MergeSort (order + half, tmp, count - half)) return false;
+
+        size_t i = 0, j = half, k = 0;
+        while ((i < half) && (j < count)) {
+            // on ties the first half wins, this keeps the sort stable
+            int res = Compare (order[j], order[i]);
+            if (!IsValid()) return false;
+            if (res < 0) {
+                tmp[k++] = order[j++];
+            }else{
+                tmp[k++] = order[i++];
+            }
+        }
+        while (i < half) tmp[k++] = order[i++];
+        while (j < count) tmp[k++] = order[j++];
+        for (k = 0; k < count; ++k) order[k] = tmp[k];
+    }
+};
+
+// compares the keys taken once of each child
+class wxTreeListKeySorter : public wxTreeListSorter
+{
+public:
+    wxTreeListKeySorter (const wxArrayString& keys, bool reverse)
+        : m_keys (keys), m_reverse (reverse) {}
+
+    virtual size_t GetCount() const { return m_keys.GetCount(); }
+    virtual int Compare (int first, int second) const
+    {
+        int res = m_keys[first].Cmp (m_keys[second]);
+        return m_reverse? -res: res;
+    }
+
+private:
+    const wxArrayString& m_keys;
+    bool                 m_reverse;
+};
+
+#if wxUSE_THREADS
+// sorts the keys of a background SortChildrenByColumn() off the GUI thread,
+// the main window applies the order when the thread is done
+class wxTreeListSortThread : public wxThread
+{
+public:
+    wxTreeListSortThread (wxTreeListItem *parent, size_t stamp, size_t textStamp,
+                          int column, bool reverse)
+        : wxThread (wxTHREAD_JOINABLE),
+          m_parent (parent), m_stamp (stamp), m_textStamp (textStamp),
+          m_column (column), m_reverse (reverse) {}
+
+    virtual ExitCode Entry()
+    {
+        wxTreeListKeySorter sorter (m_keys, m_reverse);
+        sorter.Sort (m_order);
+        wxWakeUpIdle();
+        return 0;
+    }
+
+    wxTreeListItem *m_parent;
+    size_t          m_stamp;  // tree stamp when the keys were taken
+    size_t          m_textStamp; // and the text stamp
+    int             m_column;
+    bool            m_reverse;
+    wxArrayString   m_keys;
+    wxArrayInt      m_order;  // the result
+};
+#endif
+
 
 // --------------------------------------------------------------------------
 // constants
@@ -81,6 +551,10 @@ static const int EXTRA_HEIGHT = 4;
 static const int HEADER_OFFSET_X = 1;
 static const int HEADER_OFFSET_Y = 1;
 
+static const size_t VIRTUAL_POOL_SIZE = 256; // recycled items kept for reuse
+static const size_t VIRTUAL_FETCH_SIZE = 64; // virtual children asked for at once
+static const size_t MAX_SHIFTS = 256; // row moves logged before they are applied
+
 static const int DRAG_TIMER_TICKS = 250; // minimum drag wait time in ms
 static const int FIND_TIMER_TICKS = 500; // minimum find wait time in ms
 static const int RENAME_TIMER_TICKS = 250; // minimum rename wait time in ms
@@ -540,12 +1014,29 @@ public:
     virtual int OnCompareItems(const wxTreeItemId& item1,
                                const wxTreeItemId& item2);
     // sort the children of this item using OnCompareItems
-    //
-    // NB: this function is not reentrant and not MT-safe (FIXME)!
     void SortChildren(const wxTreeItemId& item);
+    // sort the children by the text of a column, each text is taken once
+    void SortChildrenByColumn (const wxTreeItemId& item, int column,
+                               bool reverse = false, bool background = false);
+    // put the children in the given order of their current indices
+    void ReorderChildren (const wxTreeItemId& item, const wxArrayInt& order);
 
     // searching
-    wxTreeItemId FindItem (const wxTreeItemId& item, const wxString& str, int mode = 0);
+    wxTreeItemId FindItem (const wxTreeItemId& item, const wxString& str, int mode = 0,
+                           int column = -1);
+
+    // keep an index of the texts of the column for FindItem()
+    void SetFindIndex (int column, bool enable = true);
+    bool HasFindIndex (int column) const;
+
+    // discard the cached size of the item (and of its whole subtree if
+    // 'recursively'), it is measured again on the next layout pass
+    void InvalidateItemSize (const wxTreeItemId& item, bool recursively = false);
+
+    // virtual children: the item gets 'count' children which are created
+    // on demand through wxTreeListCtrl::OnGetVirtualChildren()
+    void SetVirtualChildrenCount (const wxTreeItemId& item, size_t count);
+    size_t GetVirtualChildrenCount (const wxTreeItemId& item) const;
 
     // implementation only from now on
 
@@ -650,6 +1141,64 @@ protected:
     wxTimer             *m_findTimer;
     wxString             m_findStr;
 
+    // all painted items in display order with ascending Y, rebuilt by
+    // CalculatePositions() and used to find the rows of a given y range
+    wxArrayTreeListItems m_rows;
+    int                  m_totalHeight; // bottom of the last row
+
+    // the extents of the texts measured so far
+    wxTreeListExtentCache m_extentCache;
+
+    // items with virtual children, the laid out runs of collapsed virtual
+    // children (sorted by Y like m_rows) and recycled items to reuse
+    wxTreeListVirtualMap m_virtualChildren;
+    wxArrayTreeListVirtualRuns m_runs;
+    wxArrayTreeListItems m_itemPool;
+    // the Y range in which the last release kept the virtual children, the
+    // next one only looks at the children in it and at the blocks created
+    // since, unless the layout changed meanwhile. Too many of those blocks
+    // are released right away, the oldest first
+    int                  m_keptStart, m_keptEnd;
+    bool                 m_keptValid;
+    wxArrayTreeListVirtualRuns m_strays;
+    size_t               m_strayCount; // children in m_strays
+
+    // the rows below a branch laid out again are not moved at once, the
+    // move is logged instead: rows from m_shiftTops[n] on moved down by
+    // m_shiftDeltas[n]. Each row applies the moves logged since it was
+    // placed when its Y is asked for, see wxTreeListItem::GetY()
+    wxArrayInt           m_shiftTops;
+    wxArrayInt           m_shiftDeltas;
+    size_t               m_shiftBase; // stamp of the first logged move
+    void ClearShifts();
+
+    // incremented on every change of the tree structure, a background sort
+    // is only applied if the tree didn't change meanwhile
+    size_t               m_treeStamp;
+    // incremented on every change of an item text, a background sort is
+    // done again if the keys it got changed meanwhile
+    size_t               m_textStamp;
+#if wxUSE_THREADS
+    wxTreeListSortThread *m_sortThread;
+    void FinishBackgroundSort (bool apply);
+#endif
+    void DoReorderChildren (wxTreeListItem *item, const wxArrayInt& order);
+
+    // find indices by column, updated on every insertion, deletion and
+    // text change of an item
+    wxTreeListFindIndexMap m_findIndices;
+    // the indices are emptied while a large part of the tree is deleted,
+    // and filled again at the end, see BeginBulkDelete()
+    bool                   m_findIndicesStale;
+    void FillFindIndex (wxTreeListItem *item, int column, wxTreeListFindIndex& index);
+    void AddToFindIndices (wxTreeListItem *item);
+    bool BeginBulkDelete (wxTreeListItem *item, bool withItem);
+    void EndBulkDelete (bool bulk);
+    bool FindItemIndexed (const wxTreeItemId& item, const wxString& str, int mode,
+                          int column, wxTreeItemId& found);
+    bool IsFindMatch (wxTreeListItem *item, const wxString& str, const wxString& key,
+                      int mode, int column) const;
+
     // the common part of all ctors
     void Init();
 
@@ -665,14 +1214,47 @@ protected:
 protected:
     void CalculateLineHeight();
     int  GetLineHeight(wxTreeListItem *item) const;
-    void PaintLevel( wxTreeListItem *item, wxDC& dc, int level, int &y,
-                     int x_maincol);
+    void PaintRow( wxTreeListItem *item, wxDC& dc, int x_maincol);
     void PaintItem( wxTreeListItem *item, wxDC& dc);
 
+    // index of the first row in m_rows ending at or below y
+    size_t FindRowIndex (int y) const;
+    // index of item in m_rows, the count of rows if it isn't one
+    size_t FindItemRow (wxTreeListItem *item) const;
+    // hit test of the row at the given unscrolled position
+    wxTreeListItem *HitTestRow (const wxPoint& pos, int& flags, int& column);
+
+    void CalculateMetrics();
     void CalculateLevel( wxTreeListItem *item, wxDC &dc, int level, int &y,
                          int x_maincol);
     void CalculatePositions();
+    void RelayoutBranch (wxTreeListItem *item);
+    int  GetMainColumnX() const;
     void CalculateSize( wxTreeListItem *item, wxDC &dc );
+    void InvalidateSizes (wxTreeListItem *item, bool recursively);
+    int  GetLevelX (int level, int x_colstart) const;
+
+    // children access for both ordinary and virtual children
+    size_t CountChildren (wxTreeListItem *item, bool recursively) const;
+    wxTreeListItem *GetChildAt (wxTreeListItem *parent, size_t index) const;
+    size_t GetChildIndex (wxTreeListItem *parent, wxTreeListItem *child) const;
+    bool IsLastChild (wxTreeListItem *parent, wxTreeListItem *child) const;
+
+    // virtual children helpers
+    wxTreeListVirtualChildren *GetVirtualChildren (wxTreeListItem *item) const;
+    wxTreeListItem *GetVirtualChild (wxTreeListItem *parent, size_t index);
+    void MaterializeVirtualChildren (wxTreeListItem *parent, size_t from, size_t count);
+    void PlaceVirtualChild (wxTreeListItem *child, size_t index);
+    void PlaceVirtualChildren (const wxTreeListVirtualRun& run, size_t from, size_t to, wxDC& dc);
+    void ReleaseVirtualChildren (int y_start, int y_end);
+    void ReleaseVirtualChild (wxTreeListItem *parent, size_t index, int y_start, int y_end);
+    void ReleaseStrays();
+    void RecycleItem (wxTreeListItem *item);
+    void DeleteVirtualChildren (wxTreeListItem *item);
+    void CalculateVirtualLevel (wxTreeListItem *item, wxDC &dc, int level, int &y,
+                                int x_colstart);
+    size_t FindRunIndex (int y) const;
+    bool IsPinned (wxTreeListItem *item) const;
 
     void RefreshSubtree (wxTreeListItem *item);
     void RefreshLine (wxTreeListItem *item);
@@ -754,6 +1336,9 @@ public:
 
     ~wxTreeListItem();
 
+    // reinitialize a recycled item to be used as another virtual child
+    void Reset (wxTreeListItem *parent, wxTreeItemData *data);
+
     // trivial accessors
     wxArrayTreeListItems& GetChildren() { return m_children; }
 
@@ -818,10 +1403,10 @@ public:
     void SetBold(bool bold) { m_isBold = bold; }
 
     int GetX() const { return m_x; }
-    int GetY() const { return m_y; }
+    int GetY() const;
 
     void SetX (int x) { m_x = x; }
-    void SetY (int y) { m_y = y; }
+    void SetY (int y);
 
     int  GetHeight() const { return m_height; }
     int  GetWidth()  const { return m_width; }
@@ -829,6 +1414,11 @@ public:
     void SetHeight (int height) { m_height = height; }
     void SetWidth (int width) { m_width = width; }
 
+    // the size is measured once and kept until the text or font changes
+    bool IsSizeValid() const { return m_sizeValid != 0; }
+    void ValidateSize() { m_sizeValid = true; }
+    void InvalidateSize() { m_sizeValid = false; }
+
     int GetTextX() const { return m_text_x; }
     void SetTextX (int text_x) { m_text_x = text_x; }
 
@@ -845,8 +1435,6 @@ public:
     void Insert(wxTreeListItem *child, size_t index)
     { m_children.Insert(child, index); }
 
-    void GetSize( int &x, int &y, const wxTreeListMainWindow* );
-
     // return the item at given position (or NULL if no item), onButton is
     // true if the point belongs to the item's button, otherwise it lies
     // on the button's label
@@ -916,7 +1504,8 @@ private:
 
     // main column item positions
     wxCoord             m_x;            // (virtual) offset from left (vertical line)
-    wxCoord             m_y;            // (virtual) offset from top
+    mutable wxCoord     m_y;            // (virtual) offset from top
+    mutable size_t      m_yStamp;       // the owner's row moves applied to m_y
     wxCoord             m_text_x;       // item offset from left
     short               m_width;        // width of this item
     unsigned char       m_height;       // height of this item
@@ -928,6 +1517,7 @@ private:
                                           // children but has a [+] button
     int                 m_isBold      :1; // render the label in bold font
     int                 m_ownsAttr    :1; // delete attribute when done
+    int                 m_sizeValid   :1; // m_width and m_height are measured
 };
 
 // ===========================================================================
@@ -1593,6 +2183,7 @@ wxTreeListItem::wxTreeListItem (wxTreeListMainWindow *owner,
     m_data = data;
     m_x = 0;
     m_y = 0;
+    m_yStamp = 0;
     m_text_x = 0;
 
     m_isCollapsed = true;
@@ -1609,6 +2200,53 @@ wxTreeListItem::wxTreeListItem (wxTreeListMainWindow *owner,
     // We don't know the height here yet.
     m_width = 0;
     m_height = 0;
+    m_sizeValid = false;
+}
+
+int wxTreeListItem::GetY() const {
+    const wxTreeListMainWindow *tree = m_owner;
+    size_t count = tree->m_shiftTops.GetCount();
+    // placed before the log was cleared, only rows have to be up to date
+    // and all of them are placed again then
+    if (m_yStamp < tree->m_shiftBase) m_yStamp = tree->m_shiftBase + count;
+    for (size_t n = m_yStamp - tree->m_shiftBase; n < count; ++n) {
+        if (m_y >= tree->m_shiftTops[n]) m_y += tree->m_shiftDeltas[n];
+    }
+    m_yStamp = tree->m_shiftBase + count;
+    return m_y;
+}
+
+void wxTreeListItem::SetY (int y) {
+    m_y = y;
+    m_yStamp = m_owner->m_shiftBase + m_owner->m_shiftTops.GetCount();
+}
+
+void wxTreeListItem::Reset (wxTreeListItem *parent, wxTreeItemData *data) {
+    wxASSERT_MSG( m_children.IsEmpty(), _T("only items without children can be reset"));
+
+    delete m_data;
+    m_data = data;
+    if (m_ownsAttr) delete m_attr;
+    m_attr = (wxTreeItemAttr *)NULL;
+    m_ownsAttr = false;
+    m_parent = parent;
+
+    for (size_t n = 0; n < m_text.GetCount(); ++n) m_text[n].Empty();
+    m_col_images.Empty();
+    m_images[wxTreeItemIcon_Normal] = NO_IMAGE;
+    m_images[wxTreeItemIcon_Selected] = NO_IMAGE;
+    m_images[wxTreeItemIcon_Expanded] = NO_IMAGE;
+    m_images[wxTreeItemIcon_SelectedExpanded] = NO_IMAGE;
+
+    m_x = m_y = m_text_x = 0;
+    m_yStamp = 0;
+    m_width = 0;
+    m_height = 0;
+    m_isCollapsed = true;
+    m_hasHilight = false;
+    m_hasPlus = false;
+    m_isBold = false;
+    m_sizeValid = false;
 }
 
 wxTreeListItem::~wxTreeListItem() {
@@ -1631,6 +2269,7 @@ void wxTreeListItem::DeleteChildren (wxTreeListMainWindow *tree) {
         delete child;
     }
     m_children.Empty();
+    if (tree) tree->DeleteVirtualChildren (this);
 }
 
 void wxTreeListItem::SetText (const wxString &text) {
@@ -1652,20 +2291,6 @@ size_t wxTreeListItem::GetChildrenCount (bool recursively) const {
     return total;
 }
 
-void wxTreeListItem::GetSize (int &x, int &y, const wxTreeListMainWindow *theButton) {
-    int bottomY = m_y + theButton->GetLineHeight (this);
-    if (y < bottomY) y = bottomY;
-    int width = m_x +  m_width;
-    if ( x < width ) x = width;
-
-    if (IsExpanded()) {
-        size_t count = m_children.Count();
-        for (size_t n = 0; n < count; ++n ) {
-            m_children[n]->GetSize (x, y, theButton);
-        }
-    }
-}
-
 wxTreeListItem *wxTreeListItem::HitTest (const wxPoint& point,
                                          const wxTreeListMainWindow *theCtrl,
                                          int &flags, int& column, int level) {
@@ -1683,12 +2308,13 @@ wxTreeListItem *wxTreeListItem::HitTest (const wxPoint& point,
 
         // evaluate if y-pos is okay
         int h = theCtrl->GetLineHeight (this);
-        if ((point.y >= m_y) && (point.y <= m_y + h)) {
+        int y = GetY();
+        if ((point.y >= y) && (point.y <= y + h)) {
 
             int maincol = theCtrl->GetMainColumn();
 
             // check for above/below middle
-            int y_mid = m_y + h/2;
+            int y_mid = y + h/2;
             if (point.y < y_mid) {
                 flags |= wxTREE_HITTEST_ONITEMUPPERPART;
             }else{
@@ -1869,6 +2495,18 @@ void wxTreeListMainWindow::Init() {
 
     m_findTimer = new wxTimer (this, -1);
 
+    m_totalHeight = 0;
+    m_keptStart = m_keptEnd = 0;
+    m_keptValid = false;
+    m_strayCount = 0;
+    m_shiftBase = 0;
+    m_treeStamp = 0;
+    m_textStamp = 0;
+    m_findIndicesStale = false;
+#if wxUSE_THREADS
+    m_sortThread = (wxTreeListSortThread*)NULL;
+#endif
+
 #if defined( __WXMAC__ ) && defined(__WXMAC_CARBON__)
     m_normalFont.MacCreateFromThemeFont (kThemeViewsFont);
 #else
@@ -1952,7 +2590,14 @@ wxTreeListMainWindow::~wxTreeListMainWindow() {
     if (m_ownsImageListState) delete m_imageListState;
     if (m_ownsImageListButtons) delete m_imageListButtons;
 
+#if wxUSE_THREADS
+    if (m_sortThread) FinishBackgroundSort (false);
+#endif
     DeleteRoot();
+    wxTreeListFindIndexMap::iterator it;
+    for (it = m_findIndices.begin(); it != m_findIndices.end(); ++it) delete it->second;
+    size_t count = m_itemPool.GetCount();
+    for (size_t n = 0; n < count; ++n) delete m_itemPool[n];
 }
 
 
@@ -1961,7 +2606,7 @@ wxTreeListMainWindow::~wxTreeListMainWindow() {
 //-----------------------------------------------------------------------------
 
 size_t wxTreeListMainWindow::GetCount() const {
-    return m_rootItem == NULL? 0: m_rootItem->GetChildrenCount();
+    return m_rootItem == NULL? 0: CountChildren (m_rootItem, true);
 }
 
 void wxTreeListMainWindow::SetIndent (unsigned int indent) {
@@ -1978,7 +2623,7 @@ void wxTreeListMainWindow::SetLineSpacing (unsigned int spacing) {
 size_t wxTreeListMainWindow::GetChildrenCount (const wxTreeItemId& item,
                                                bool recursively) {
     wxCHECK_MSG (item.IsOk(), 0u, _T("invalid tree item"));
-    return ((wxTreeListItem*)item.m_pItem)->GetChildrenCount (recursively);
+    return CountChildren ((wxTreeListItem*)item.m_pItem, recursively);
 }
 
 void wxTreeListMainWindow::SetWindowStyle (const long styles) {
@@ -2056,6 +2701,7 @@ void wxTreeListMainWindow::SetItemBold (const wxTreeItemId& item, bool bold) {
     wxTreeListItem *pItem = (wxTreeListItem*) item.m_pItem;
     if (pItem->IsBold() != bold) { // avoid redrawing if no real change
         pItem->SetBold (bold);
+        pItem->InvalidateSize();
         RefreshLine (pItem);
     }
 }
@@ -2081,6 +2727,7 @@ void wxTreeListMainWindow::SetItemFont (const wxTreeItemId& item,
     wxCHECK_RET (item.IsOk(), _T("invalid tree item"));
     wxTreeListItem *pItem = (wxTreeListItem*) item.m_pItem;
     pItem->Attr().SetFont (font);
+    pItem->InvalidateSize();
     RefreshLine (pItem);
 }
 
@@ -2093,6 +2740,9 @@ bool wxTreeListMainWindow::SetFont (const wxFont &font) {
                          wxBOLD,
                          m_normalFont.GetUnderlined(),
                          m_normalFont.GetFaceName());
+    m_extentCache.Clear();
+    if (m_rootItem) InvalidateSizes (m_rootItem, true);
+    m_dirty = true;
     CalculateLineHeight();
     return true;
 }
@@ -2167,9 +2817,9 @@ wxTreeItemId wxTreeListMainWindow::GetFirstChild (const wxTreeItemId& item,
                                                   wxTreeItemIdValue& cookie) const {
 #endif
     wxCHECK_MSG (item.IsOk(), wxTreeItemId(), _T("invalid tree item"));
-    wxArrayTreeListItems& children = ((wxTreeListItem*) item.m_pItem)->GetChildren();
+    wxTreeListItem *parent = (wxTreeListItem*) item.m_pItem;
     cookie = 0;
-    return (!children.IsEmpty())? wxTreeItemId(children.Item(0)): wxTreeItemId();
+    return (CountChildren (parent, false) > 0)? wxTreeItemId(GetChildAt (parent, 0)): wxTreeItemId();
 }
 
 #if !wxCHECK_VERSION(2, 5, 0)
@@ -2180,10 +2830,10 @@ wxTreeItemId wxTreeListMainWindow::GetNextChild (const wxTreeItemId& item,
                                                  wxTreeItemIdValue& cookie) const {
 #endif
     wxCHECK_MSG (item.IsOk(), wxTreeItemId(), _T("invalid tree item"));
-    wxArrayTreeListItems& children = ((wxTreeListItem*) item.m_pItem)->GetChildren();
+    wxTreeListItem *parent = (wxTreeListItem*) item.m_pItem;
     // it's ok to cast cookie to long, we never have indices which overflow "void*"
     long *pIndex = ((long*)&cookie);
-    return ((*pIndex)+1 < (long)children.Count())? wxTreeItemId(children.Item(++(*pIndex))): wxTreeItemId();
+    return ((*pIndex)+1 < (long)CountChildren (parent, false))? wxTreeItemId(GetChildAt (parent, ++(*pIndex))): wxTreeItemId();
 }
 
 #if !wxCHECK_VERSION(2, 5, 0)
@@ -2194,10 +2844,10 @@ wxTreeItemId wxTreeListMainWindow::GetPrevChild (const wxTreeItemId& item,
                                                  wxTreeItemIdValue& cookie) const {
 #endif
     wxCHECK_MSG (item.IsOk(), wxTreeItemId(), _T("invalid tree item"));
-    wxArrayTreeListItems& children = ((wxTreeListItem*) item.m_pItem)->GetChildren();
+    wxTreeListItem *parent = (wxTreeListItem*) item.m_pItem;
     // it's ok to cast cookie to long, we never have indices which overflow "void*"
     long *pIndex = (long*)&cookie;
-    return ((*pIndex)-1 >= 0)? wxTreeItemId(children.Item(--(*pIndex))): wxTreeItemId();
+    return ((*pIndex)-1 >= 0)? wxTreeItemId(GetChildAt (parent, --(*pIndex))): wxTreeItemId();
 }
 
 #if !wxCHECK_VERSION(2, 5, 0)
@@ -2208,11 +2858,12 @@ wxTreeItemId wxTreeListMainWindow::GetLastChild (const wxTreeItemId& item,
                                                  wxTreeItemIdValue& cookie) const {
 #endif
     wxCHECK_MSG (item.IsOk(), wxTreeItemId(), _T("invalid tree item"));
-    wxArrayTreeListItems& children = ((wxTreeListItem*) item.m_pItem)->GetChildren();
+    wxTreeListItem *parent = (wxTreeListItem*) item.m_pItem;
+    size_t count = CountChildren (parent, false);
     // it's ok to cast cookie to long, we never have indices which overflow "void*"
     long *pIndex = ((long*)&cookie);
-    (*pIndex) = children.Count();
-    return (!children.IsEmpty())? wxTreeItemId(children.Last()): wxTreeItemId();
+    (*pIndex) = count;
+    return (count > 0)? wxTreeItemId(GetChildAt (parent, count-1)): wxTreeItemId();
 }
 
 wxTreeItemId wxTreeListMainWindow::GetNextSibling (const wxTreeItemId& item) const {
@@ -2224,10 +2875,9 @@ wxTreeItemId wxTreeListMainWindow::GetNextSibling (const wxTreeItemId& item) con
     if (!parent) return wxTreeItemId(); // root item doesn't have any siblings
 
     // get index
-    wxArrayTreeListItems& siblings = parent->GetChildren();
-    size_t index = siblings.Index (i);
+    size_t index = GetChildIndex (parent, i);
     wxASSERT (index != (size_t)wxNOT_FOUND); // I'm not a child of my parent?
-    return (index < siblings.Count()-1)? wxTreeItemId(siblings[index+1]): wxTreeItemId();
+    return (index+1 < CountChildren (parent, false))? wxTreeItemId(GetChildAt (parent, index+1)): wxTreeItemId();
 }
 
 wxTreeItemId wxTreeListMainWindow::GetPrevSibling (const wxTreeItemId& item) const {
@@ -2239,10 +2889,9 @@ wxTreeItemId wxTreeListMainWindow::GetPrevSibling (const wxTreeItemId& item) con
     if (!parent) return wxTreeItemId(); // root item doesn't have any siblings
 
     // get index
-    wxArrayTreeListItems& siblings = parent->GetChildren();
-    size_t index = siblings.Index(i);
+    size_t index = GetChildIndex (parent, i);
     wxASSERT (index != (size_t)wxNOT_FOUND); // I'm not a child of my parent?
-    return (index >= 1)? wxTreeItemId(siblings[index-1]): wxTreeItemId();
+    return (index >= 1)? wxTreeItemId(GetChildAt (parent, index-1)): wxTreeItemId();
 }
 
 // Only for internal use right now, but should probably be public
@@ -2250,9 +2899,9 @@ wxTreeItemId wxTreeListMainWindow::GetNext (const wxTreeItemId& item, bool fullt
     wxCHECK_MSG (item.IsOk(), wxTreeItemId(), _T("invalid tree item"));
 
     // if there are any children, return first child
-    if (fulltree || ((wxTreeListItem*)item.m_pItem)->IsExpanded()) {
-        wxArrayTreeListItems& children = ((wxTreeListItem*)item.m_pItem)->GetChildren();
-        if (children.GetCount() > 0) return children.Item (0);
+    wxTreeListItem *i = (wxTreeListItem*) item.m_pItem;
+    if (fulltree || i->IsExpanded()) {
+        if (CountChildren (i, false) > 0) return GetChildAt (i, 0);
     }
 
     // get sibling of this item or of the ancestors instead
@@ -2270,9 +2919,10 @@ wxTreeItemId wxTreeListMainWindow::GetPrev (const wxTreeItemId& item, bool fullt
     wxCHECK_MSG (item.IsOk(), wxTreeItemId(), _T("invalid tree item"));
 
     // if there are any children, return last child
-    if (fulltree || ((wxTreeListItem*)item.m_pItem)->IsExpanded()) {
-        wxArrayTreeListItems& children = ((wxTreeListItem*)item.m_pItem)->GetChildren();
-        if (children.GetCount() > 0) return children.Item (children.GetCount()-1);
+    wxTreeListItem *i = (wxTreeListItem*) item.m_pItem;
+    if (fulltree || i->IsExpanded()) {
+        size_t count = CountChildren (i, false);
+        if (count > 0) return GetChildAt (i, count-1);
     }
 
     // get sibling of this item or of the ancestors instead
@@ -2334,7 +2984,21 @@ wxTreeItemId wxTreeListMainWindow::DoInsertItem (const wxTreeItemId& parentId,
                                                  wxTreeItemData *data) {
     wxTreeListItem *parent = (wxTreeListItem*)parentId.m_pItem;
     wxCHECK_MSG (parent, wxTreeItemId(), _T("item must have a parent, at least root!") );
-    m_dirty = true; // do this first so stuff below doesn't cause flicker
+    wxCHECK_MSG (!GetVirtualChildren (parent), wxTreeItemId(), _T("item has virtual children, no items can be inserted!") );
+    // the layout only changes if the new item is shown, then it is done
+    // once at idle time for all the items inserted meanwhile
+    if (!m_dirty) {
+        if ((parent == m_rootItem) && HasFlag(wxTR_HIDE_ROOT)) {
+            m_dirty = true; // do this first so stuff below doesn't cause flicker
+        }else if (FindItemRow (parent) < m_rows.GetCount()) {
+            if (parent->IsExpanded()) {
+                m_dirty = true;
+            }else{
+                RefreshLine (parent); // it may get a button
+            }
+        }
+    }
+    ++m_treeStamp;
 
     wxArrayString arr;
     arr.Alloc (GetColumnCount());
@@ -2349,6 +3013,7 @@ wxTreeItemId wxTreeListMainWindow::DoInsertItem (const wxTreeItemId& parentId,
 #endif
     }
     parent->Insert (item, previous);
+    AddToFindIndices (item);
 
     return item;
 }
@@ -2359,6 +3024,7 @@ wxTreeItemId wxTreeListMainWindow::AddRoot (const wxString& text,
     wxCHECK_MSG(!m_rootItem, wxTreeItemId(), _T("tree can have only one root"));
     wxCHECK_MSG(GetColumnCount(), wxTreeItemId(), _T("Add column(s) before adding the root item"));
     m_dirty = true; // do this first so stuff below doesn't cause flicker
+    ++m_treeStamp;
 
     wxArrayString arr;
     arr.Alloc (GetColumnCount());
@@ -2372,6 +3038,7 @@ wxTreeItemId wxTreeListMainWindow::AddRoot (const wxString& text,
         data->SetId(m_rootItem);
 #endif
     }
+    AddToFindIndices (m_rootItem);
     if (HasFlag(wxTR_HIDE_ROOT)) {
         // if we will hide the root, make sure children are visible
         m_rootItem->SetHasPlus();
@@ -2430,6 +3097,14 @@ wxTreeItemId wxTreeListMainWindow::AppendItem (const wxTreeItemId& parentId,
 }
 
 void wxTreeListMainWindow::SendDeleteEvent (wxTreeListItem *item) {
+    // all deleted items pass here
+    if (!m_findIndicesStale) {
+        wxTreeListFindIndexMap::iterator it;
+        for (it = m_findIndices.begin(); it != m_findIndices.end(); ++it) {
+            it->second->Remove (item);
+        }
+    }
+
     // send event to user code
     wxTreeEvent event (wxEVT_COMMAND_TREE_DELETE_ITEM, m_owner->GetId());
 #if !wxCHECK_VERSION(2, 5, 0)
@@ -2444,7 +3119,10 @@ void wxTreeListMainWindow::SendDeleteEvent (wxTreeListItem *item) {
 void wxTreeListMainWindow::Delete (const wxTreeItemId& itemId) {
     wxTreeListItem *item = (wxTreeListItem*) itemId.m_pItem;
     wxCHECK_RET (item != m_rootItem, _T("invalid item, root may not be deleted this way!"));
+    wxCHECK_RET (!GetVirtualChildren (item->GetItemParent()),
+                 _T("invalid item, virtual children may only be removed by SetVirtualChildrenCount()!"));
     m_dirty = true; // do this first so stuff below doesn't cause flicker
+    ++m_treeStamp;
 
     // don't stay with invalid m_shiftItem or we will crash in the next call to OnChar()
     bool changeKeyCurrent = false;
@@ -2484,9 +3162,11 @@ void wxTreeListMainWindow::Delete (const wxTreeItemId& itemId) {
     }
     if (changeKeyCurrent)  m_shiftItem = parent;
 
+    bool bulk = BeginBulkDelete (item, true);
     SendDeleteEvent (item);
     if (m_selectItem == item) m_selectItem = (wxTreeListItem*)NULL;
     item->DeleteChildren (this);
+    EndBulkDelete (bulk);
 
     if (item == m_select_me)
         m_select_me = NULL;
@@ -2497,19 +3177,55 @@ void wxTreeListMainWindow::Delete (const wxTreeItemId& itemId) {
 void wxTreeListMainWindow::DeleteChildren (const wxTreeItemId& itemId) {
     wxTreeListItem *item = (wxTreeListItem*) itemId.m_pItem;
     m_dirty = true; // do this first so stuff below doesn't cause flicker
+    ++m_treeStamp;
 
+    bool bulk = BeginBulkDelete (item, false);
     item->DeleteChildren (this);
+    EndBulkDelete (bulk);
 }
 
 void wxTreeListMainWindow::DeleteRoot() {
     if (m_rootItem) {
         m_dirty = true;
+        ++m_treeStamp;
+        m_rows.Empty();
+        m_runs.Empty();
+        // nothing is left to index
+        wxTreeListFindIndexMap::iterator it;
+        for (it = m_findIndices.begin(); it != m_findIndices.end(); ++it) it->second->Clear();
+        m_findIndicesStale = true;
         SendDeleteEvent (m_rootItem);
         m_curItem = (wxTreeListItem*)NULL;
         m_selectItem= (wxTreeListItem*)NULL;
         m_rootItem->DeleteChildren (this);
         delete m_rootItem;
         m_rootItem = NULL;
+        m_findIndicesStale = false;
+    }
+}
+
+// Deleting the entries of a large branch one at a time costs more than
+// filling the indices again with what is left, so when the branch holds
+// more than half of the items the indices are emptied, and refilled by
+// EndBulkDelete() once it is gone. Returns whether they were emptied.
+bool wxTreeListMainWindow::BeginBulkDelete (wxTreeListItem *item, bool withItem) {
+    if (m_findIndices.empty() || m_findIndicesStale) return false;
+    size_t entries = m_findIndices.begin()->second->GetCount();
+    size_t count = CountChildren (item, true) + (withItem? 1: 0);
+    if (count * 2 <= entries) return false;
+    wxTreeListFindIndexMap::iterator it;
+    for (it = m_findIndices.begin(); it != m_findIndices.end(); ++it) it->second->Clear();
+    m_findIndicesStale = true;
+    return true;
+}
+
+void wxTreeListMainWindow::EndBulkDelete (bool bulk) {
+    if (!bulk) return;
+    m_findIndicesStale = false;
+    if (!m_rootItem) return;
+    wxTreeListFindIndexMap::iterator it;
+    for (it = m_findIndices.begin(); it != m_findIndices.end(); ++it) {
+        FillFindIndex (m_rootItem, it->first, *it->second);
     }
 }
 
@@ -2530,7 +3246,7 @@ void wxTreeListMainWindow::Expand (const wxTreeItemId& itemId) {
     if (m_owner->GetEventHandler()->ProcessEvent (event) && !event.IsAllowed()) return; // expand canceled
 
     item->Expand();
-    m_dirty = true;
+    RelayoutBranch (item);
 
     // send event to user code
     event.SetEventType (wxEVT_COMMAND_TREE_ITEM_EXPANDED);
@@ -2540,6 +3256,9 @@ void wxTreeListMainWindow::Expand (const wxTreeItemId& itemId) {
 void wxTreeListMainWindow::ExpandAll (const wxTreeItemId& itemId) {
     Expand (itemId);
     if (!IsExpanded (itemId)) return;
+    // expanded virtual children are kept, expanding all of them would
+    // create the whole branch at once
+    if (GetVirtualChildren ((wxTreeListItem*) itemId.m_pItem)) return;
 #if !wxCHECK_VERSION(2, 5, 0)
     long cookie;
 #else
@@ -2569,7 +3288,7 @@ void wxTreeListMainWindow::Collapse (const wxTreeItemId& itemId) {
     if (m_owner->GetEventHandler()->ProcessEvent (event) && !event.IsAllowed()) return; // collapse canceled
 
     item->Collapse();
-    m_dirty = true;
+    RelayoutBranch (item);
 
     // send event to user code
     event.SetEventType (wxEVT_COMMAND_TREE_ITEM_COLLAPSED);
@@ -2610,6 +3329,13 @@ void wxTreeListMainWindow::UnselectAllChildren (wxTreeListItem *item) {
             UnselectAllChildren (children[n]);
         }
     }
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (item);
+    if (virt) {
+        wxTreeListIndexItemMap::iterator it;
+        for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+            UnselectAllChildren (it->second);
+        }
+    }
 }
 
 void wxTreeListMainWindow::UnselectAll() {
@@ -2630,6 +3356,9 @@ bool wxTreeListMainWindow::TagNextChildren (wxTreeListItem *crt_item,
         return TagAllChildrenUntilLast (crt_item, last_item);
     }
 
+    // ranges don't extend over virtual children
+    if (GetVirtualChildren (parent)) return TagNextChildren (parent, last_item);
+
     wxArrayTreeListItems& children = parent->GetChildren();
     int index = children.Index(crt_item);
     wxASSERT (index != wxNOT_FOUND); // I'm not a child of my parent?
@@ -2697,8 +3426,10 @@ void wxTreeListMainWindow::SelectItem (const wxTreeItemId& itemId,
         }
     }
 
-    // select item or item range
-    if (!is_single && lastId.IsOk() && (itemId != lastId)) {
+    // select item or item range, ranges don't extend over virtual children
+    if (!is_single && lastId.IsOk() && (itemId != lastId) &&
+        !GetVirtualChildren (item->GetItemParent()) &&
+        !GetVirtualChildren (((wxTreeListItem*) lastId.m_pItem)->GetItemParent())) {
 
         if (!unselected && unselect_others) UnselectAll();
         wxTreeListItem *last = (wxTreeListItem*) lastId.m_pItem;
@@ -2774,6 +3505,13 @@ void wxTreeListMainWindow::FillArray (wxTreeListItem *item,
         size_t count = children.GetCount();
         for (size_t n = 0; n < count; ++n) FillArray (children[n], array);
     }
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (item);
+    if (virt) {
+        wxTreeListIndexItemMap::iterator it;
+        for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+            FillArray (it->second, array);
+        }
+    }
 }
 
 size_t wxTreeListMainWindow::GetSelections (wxArrayTreeItemIds &array) const {
@@ -2820,11 +3558,8 @@ void wxTreeListMainWindow::ScrollTo (const wxTreeItemId &item) {
     int client_w = 0;
     GetClientSize (&client_w, &client_h);
 
-    int x = 0;
-    int y = 0;
-    m_rootItem->GetSize (x, y, this);
-    x = m_owner->GetHeaderWindow()->GetWidth();
-    y += yUnit + 2; // one more scrollbar unit + 2 pixels
+    int x = m_owner->GetHeaderWindow()->GetWidth();
+    int y = m_totalHeight + yUnit + 2; // one more scrollbar unit + 2 pixels
     int x_pos = GetScrollPos( wxHORIZONTAL );
 
     if (item_y < start_y+3) {
@@ -2837,16 +3572,28 @@ void wxTreeListMainWindow::ScrollTo (const wxTreeItemId &item) {
     }
 }
 
-// FIXME: tree sorting functions are not reentrant and not MT-safe!
-static wxTreeListMainWindow *s_treeBeingSorted = NULL;
-
-static int LINKAGEMODE tree_ctrl_compare_func(wxTreeListItem **item1,
-                                  wxTreeListItem **item2)
+// compares the children through OnCompareItems(), which calls user code: if
+// that changes the tree (the stamp moves), the children may have been
+// deleted and are not compared any more
+class wxTreeListItemSorter : public wxTreeListSorter
 {
-    wxCHECK_MSG (s_treeBeingSorted, 0, _T("bug in wxTreeListMainWindow::SortChildren()") );
+public:
+    wxTreeListItemSorter (wxTreeListMainWindow *tree, const wxArrayTreeListItems& children,
+                          const size_t& treeStamp)
+        : m_tree (tree), m_children (children),
+          m_treeStamp (treeStamp), m_stamp (treeStamp) {}
 
-    return s_treeBeingSorted->OnCompareItems(*item1, *item2);
-}
+    virtual size_t GetCount() const { return m_children.GetCount(); }
+    virtual int Compare (int first, int second) const
+        { return m_tree->OnCompareItems (m_children[first], m_children[second]); }
+    virtual bool IsValid() const { return m_treeStamp == m_stamp; }
+
+private:
+    wxTreeListMainWindow *m_tree;
+    wxArrayTreeListItems  m_children; // a copy, the tree may change meanwhile
+    const size_t&         m_treeStamp;
+    size_t                m_stamp;    // when the sort started
+};
 
 int wxTreeListMainWindow::OnCompareItems(const wxTreeItemId& item1,
                                const wxTreeItemId& item2)
@@ -2858,20 +3605,112 @@ void wxTreeListMainWindow::SortChildren (const wxTreeItemId& itemId) {
     wxCHECK_RET (itemId.IsOk(), _T("invalid tree item"));
 
     wxTreeListItem *item = (wxTreeListItem*) itemId.m_pItem;
+    wxCHECK_RET (!GetVirtualChildren (item), _T("virtual children are given in order by OnGetVirtualChildren()"));
+    wxArrayTreeListItems& children = item->GetChildren();
+    if (children.Count() < 2) return;
+
+    // the comparisons call user code, the sort stops if it changes the tree
+    wxArrayInt order;
+    wxTreeListItemSorter sorter (this, children, m_treeStamp);
+    if (sorter.Sort (order)) DoReorderChildren (item, order);
+}
 
-    wxCHECK_RET (!s_treeBeingSorted,
-                 _T("wxTreeListMainWindow::SortChildren is not reentrant") );
+void wxTreeListMainWindow::SortChildrenByColumn (const wxTreeItemId& itemId, int column,
+                                                 bool reverse, bool background) {
+    wxCHECK_RET (itemId.IsOk(), _T("invalid tree item"));
+    wxCHECK_RET ((column >= 0) && (column < GetColumnCount()), _T("invalid column"));
 
+    wxTreeListItem *item = (wxTreeListItem*) itemId.m_pItem;
+    wxCHECK_RET (!GetVirtualChildren (item), _T("virtual children are given in order by OnGetVirtualChildren()"));
     wxArrayTreeListItems& children = item->GetChildren();
-    if ( children.Count() > 1 ) {
-        m_dirty = true;
-        s_treeBeingSorted = this;
-        children.Sort(tree_ctrl_compare_func);
-        s_treeBeingSorted = NULL;
+    size_t count = children.GetCount();
+    if (count < 2) return;
+
+#if wxUSE_THREADS
+    // only one sort runs in the background, a previous one is done first
+    // (if it is sorted again since its texts changed, that one as well)
+    while (m_sortThread) FinishBackgroundSort (true);
+
+    if (background) {
+        wxTreeListSortThread *thread = new wxTreeListSortThread (item, m_treeStamp, m_textStamp,
+                                                                 column, reverse);
+        thread->m_keys.Alloc (count);
+        for (size_t n = 0; n < count; ++n) {
+            // no buffers are shared with the tree, the thread only reads them
+            thread->m_keys.Add (wxString (GetItemText (children[n], column).c_str()));
+        }
+        if ((thread->Create() == wxTHREAD_NO_ERROR) && (thread->Run() == wxTHREAD_NO_ERROR)) {
+            m_sortThread = thread;
+            return;
+        }
+        delete thread; // sort it right here instead
+    }
+#else
+    wxUnusedVar (background);
+#endif
+
+    wxArrayString keys;
+    keys.Alloc (count);
+    for (size_t n = 0; n < count; ++n) keys.Add (GetItemText (children[n], column));
+    wxArrayInt order;
+    wxTreeListKeySorter sorter (keys, reverse);
+    sorter.Sort (order);
+    DoReorderChildren (item, order);
+}
+
+#if wxUSE_THREADS
+void wxTreeListMainWindow::FinishBackgroundSort (bool apply) {
+    wxTreeListSortThread *thread = m_sortThread;
+    m_sortThread = (wxTreeListSortThread*)NULL;
+    thread->Wait();
+    if (apply && (thread->m_stamp == m_treeStamp)) {
+        if (thread->m_textStamp == m_textStamp) {
+            DoReorderChildren (thread->m_parent, thread->m_order);
+        }else{
+            // the order is of outdated texts, sort the current ones instead
+            SortChildrenByColumn (thread->m_parent, thread->m_column, thread->m_reverse, true);
+        }
     }
+    delete thread;
 }
+#endif
+
+void wxTreeListMainWindow::ReorderChildren (const wxTreeItemId& itemId, const wxArrayInt& order) {
+    wxCHECK_RET (itemId.IsOk(), _T("invalid tree item"));
+
+    wxTreeListItem *item = (wxTreeListItem*) itemId.m_pItem;
+    size_t count = item->GetChildren().GetCount();
+    wxCHECK_RET (order.GetCount() == count, _T("the order must contain each child once"));
+
+    wxArrayInt used;
+    used.Add (0, count);
+    for (size_t n = 0; n < count; ++n) {
+        wxCHECK_RET ((order[n] >= 0) && ((size_t)order[n] < count) && !used[order[n]],
+                     _T("the order must contain each child once"));
+        used[order[n]] = 1;
+    }
+    DoReorderChildren (item, order);
+}
+
+void wxTreeListMainWindow::DoReorderChildren (wxTreeListItem *item, const wxArrayInt& order) {
+    wxArrayTreeListItems& children = item->GetChildren();
+    wxArrayTreeListItems sorted;
+    size_t count = order.GetCount();
+    sorted.Alloc (count);
+    for (size_t n = 0; n < count; ++n) sorted.Add (children[order[n]]);
+    for (size_t n = 0; n < count; ++n) children[n] = sorted[n];
+    ++m_treeStamp;
+    // the rows of the branch are cached in m_rows in the old order, they
+    // are replaced (or the whole layout is marked as outdated)
+    RelayoutBranch (item);
+}
+
+wxTreeItemId wxTreeListMainWindow::FindItem (const wxTreeItemId& item, const wxString& str,
+                                             int mode, int column) {
+    if (column < 0) column = m_main_column;
+    wxTreeItemId found;
+    if (FindItemIndexed (item, str, mode, column, found)) return found;
 
-wxTreeItemId wxTreeListMainWindow::FindItem (const wxTreeItemId& item, const wxString& str, int mode) {
     wxString itemText;
     // determine start item
     wxTreeItemId next = item;
@@ -2903,9 +3742,9 @@ wxTreeItemId wxTreeListMainWindow::FindItem (const wxTreeItemId& item, const wxS
     // start checking the next items
     while (next.IsOk() && (next != item)) {
         if (mode & wxTL_MODE_FIND_PARTIAL) {
-            itemText = GetItemText (next).Mid (0, str.Length());
+            itemText = GetItemText (next, column).Mid (0, str.Length());
         }else{
-            itemText = GetItemText (next);
+            itemText = GetItemText (next, column);
         }
         if (mode & wxTL_MODE_FIND_NOCASE) {
             if (itemText.CmpNoCase (str) == 0) return next;
@@ -2931,25 +3770,459 @@ wxTreeItemId wxTreeListMainWindow::FindItem (const wxTreeItemId& item, const wxS
     return (wxTreeItemId*)NULL;
 }
 
-void wxTreeListMainWindow::SetDragItem (const wxTreeItemId& item) {
-    wxTreeListItem *prevItem = m_dragItem;
-    m_dragItem = (wxTreeListItem*) item.m_pItem;
-    if (prevItem) RefreshLine (prevItem);
-    if (m_dragItem) RefreshLine (m_dragItem);
+void wxTreeListMainWindow::SetFindIndex (int column, bool enable) {
+    wxCHECK_RET ((column >= 0) && (column < GetColumnCount()), _T("invalid column"));
+    wxCHECK_RET (!IsVirtual(), _T("the texts of a virtual control can't be indexed"));
+
+    wxTreeListFindIndexMap::iterator it = m_findIndices.find (column);
+    if (it != m_findIndices.end()) {
+        if (enable) return;
+        delete it->second;
+        m_findIndices.erase (it);
+        return;
+    }
+    if (!enable) return;
+
+    wxTreeListFindIndex *index = new wxTreeListFindIndex;
+    if (m_rootItem) FillFindIndex (m_rootItem, column, *index);
+    m_findIndices[column] = index;
 }
 
-void wxTreeListMainWindow::CalculateLineHeight() {
-    wxClientDC dc (this);
-    dc.SetFont (m_normalFont);
-    m_lineHeight = (int)(dc.GetCharHeight() + m_linespacing);
+bool wxTreeListMainWindow::HasFindIndex (int column) const {
+    return m_findIndices.find (column) != m_findIndices.end();
+}
 
-    if (m_imageListNormal) {
-        // Calculate a m_lineHeight value from the normal Image sizes.
-        // May be toggle off. Then wxTreeListMainWindow will spread when
-        // necessary (which might look ugly).
-        int n = m_imageListNormal->GetImageCount();
-        for (int i = 0; i < n ; i++) {
-            int width = 0, height = 0;
+void wxTreeListMainWindow::FillFindIndex (wxTreeListItem *item, int column,
+                                          wxTreeListFindIndex& index) {
+    index.Add (item->GetText (column).Lower(), item);
+    wxArrayTreeListItems& children = item->GetChildren();
+    size_t count = children.GetCount();
+    for (size_t n = 0; n < count; ++n) FillFindIndex (children[n], column, index);
+}
+
+void wxTreeListMainWindow::AddToFindIndices (wxTreeListItem *item) {
+    wxTreeListFindIndexMap::iterator it;
+    for (it = m_findIndices.begin(); it != m_findIndices.end(); ++it) {
+        it->second->Add (item->GetText (it->first).Lower(), item);
+    }
+}
+
+// whether the text of the column of item matches str, key is the lower
+// case str
+bool wxTreeListMainWindow::IsFindMatch (wxTreeListItem *item, const wxString& str,
+                                        const wxString& key, int mode, int column) const {
+    wxString text = GetItemText (item, column);
+    if (mode & wxTL_MODE_FIND_PARTIAL) text = text.Mid (0, str.Length());
+    if (mode & wxTL_MODE_FIND_NOCASE) return text.Lower() == key;
+    return text.Cmp (str) == 0;
+}
+
+// answers FindItem() with the find index of the column: the matching items
+// are a range of the index, hence only the navigation modes visiting rows
+// can be served, false is returned for the others. The next match after
+// the start item is the one with the lowest row following it: few matches
+// are each looked up in the rows, otherwise the rows are walked from the
+// start item until the first match, which is about rows/matches away
+bool wxTreeListMainWindow::FindItemIndexed (const wxTreeItemId& item, const wxString& str,
+                                            int mode, int column, wxTreeItemId& found) {
+    if (!(mode & (wxTL_MODE_NAV_EXPANDED | wxTL_MODE_NAV_VISIBLE)) ||
+        (mode & wxTL_MODE_NAV_LEVEL)) return false;
+    wxTreeListFindIndexMap::iterator it = m_findIndices.find (column);
+    if ((it == m_findIndices.end()) || m_findIndicesStale) return false;
+
+    // ensure that the position of the items is calculated in any case
+    if (m_dirty) CalculatePositions();
+
+    size_t rows = m_rows.GetCount();
+    wxTreeListItem *start = (wxTreeListItem*) item.m_pItem;
+    size_t start_row = start? FindItemRow (start): rows;
+    if (start && (start_row == rows)) return false;
+
+    const wxTreeListFindIndex& index = *it->second;
+    wxString key = str.Lower();
+    bool partial = (mode & wxTL_MODE_FIND_PARTIAL) != 0;
+
+    // the range of the index matching the key
+    size_t lo = index.Rank (key, false, partial);
+    size_t hi = index.Rank (key, true, partial);
+    size_t matches = hi - lo;
+    found = wxTreeItemId();
+    if (matches == 0) return true;
+
+    // rows are counted from the one after the start, wrapping around
+    size_t first_row = start? start_row + 1: 0;
+    if ((double)matches * matches < (double)rows) {
+        size_t best = rows;
+        for (size_t n = lo; n < hi; ++n) {
+            wxTreeListItem *match = index.Item (n);
+            if (match == start) continue;
+            if (!IsFindMatch (match, str, key, mode, column)) continue;
+            size_t row = FindItemRow (match);
+            if (row == rows) continue;
+            if ((mode & wxTL_MODE_NAV_VISIBLE) && !IsVisible (match, false)) continue;
+            size_t dist = (row + rows - first_row) % rows;
+            if (dist < best) {
+                best = dist;
+                found = match;
+            }
+        }
+        return true;
+    }
+    for (size_t n = 0; n < rows; ++n) {
+        wxTreeListItem *row = m_rows[(first_row + n) % rows];
+        if (row == start) continue;
+        if (!IsFindMatch (row, str, key, mode, column)) continue;
+        if ((mode & wxTL_MODE_NAV_VISIBLE) && !IsVisible (row, false)) continue;
+        found = row;
+        break;
+    }
+    return true;
+}
+
+void wxTreeListMainWindow::InvalidateItemSize (const wxTreeItemId& itemId, bool recursively) {
+    wxCHECK_RET (itemId.IsOk(), _T("invalid tree item"));
+
+    InvalidateSizes ((wxTreeListItem*) itemId.m_pItem, recursively);
+    m_dirty = true;
+}
+
+// ----------------------------------------------------------------------------
+// virtual children
+// ----------------------------------------------------------------------------
+
+void wxTreeListMainWindow::SetVirtualChildrenCount (const wxTreeItemId& itemId, size_t count) {
+    wxTreeListItem *item = (wxTreeListItem*) itemId.m_pItem;
+    wxCHECK_RET (item, _T("invalid tree item"));
+    wxCHECK_RET (IsVirtual(), _T("virtual children require the wxTR_VIRTUAL style"));
+    // runs of virtual children are laid out as rows of the same height
+    wxCHECK_RET (!HasFlag(wxTR_HAS_VARIABLE_ROW_HEIGHT), _T("virtual children can't have variable row heights"));
+    wxCHECK_RET (!item->HasChildren(), _T("item already has children"));
+    m_dirty = true;
+    ++m_treeStamp;
+
+    // the children in use are discarded, they may not match the new count
+    DeleteVirtualChildren (item);
+    if (count > 0) m_virtualChildren[item] = new wxTreeListVirtualChildren (count);
+    item->SetHasPlus (count > 0);
+}
+
+size_t wxTreeListMainWindow::GetVirtualChildrenCount (const wxTreeItemId& itemId) const {
+    wxCHECK_MSG (itemId.IsOk(), 0u, _T("invalid tree item"));
+    wxTreeListVirtualChildren *virt = GetVirtualChildren ((wxTreeListItem*) itemId.m_pItem);
+    return virt? virt->m_count: 0;
+}
+
+wxTreeListVirtualChildren *wxTreeListMainWindow::GetVirtualChildren (wxTreeListItem *item) const {
+    if (m_virtualChildren.empty()) return (wxTreeListVirtualChildren*)NULL;
+    wxTreeListVirtualMap::const_iterator it = m_virtualChildren.find (item);
+    return (it != m_virtualChildren.end())? it->second: (wxTreeListVirtualChildren*)NULL;
+}
+
+size_t wxTreeListMainWindow::CountChildren (wxTreeListItem *item, bool recursively) const {
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (item);
+    const wxArrayTreeListItems& children = item->GetChildren();
+    size_t count = virt? virt->m_count: children.GetCount();
+    if (!recursively) return count;
+
+    // virtual children which are not in use have no children of their own
+    size_t total = count;
+    if (virt) {
+        wxTreeListIndexItemMap::iterator it;
+        for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+            total += CountChildren (it->second, true);
+        }
+    }else{
+        for (size_t n = 0; n < count; ++n) total += CountChildren (children[n], true);
+    }
+    return total;
+}
+
+wxTreeListItem *wxTreeListMainWindow::GetChildAt (wxTreeListItem *parent, size_t index) const {
+    if (GetVirtualChildren (parent)) {
+        return ((wxTreeListMainWindow*)this)->GetVirtualChild (parent, index);
+    }
+    return parent->GetChildren()[index];
+}
+
+size_t wxTreeListMainWindow::GetChildIndex (wxTreeListItem *parent, wxTreeListItem *child) const {
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (parent);
+    if (!virt) return (size_t)parent->GetChildren().Index (child);
+    wxTreeListItemIndexMap::const_iterator it = virt->m_indices.find (child);
+    return (it != virt->m_indices.end())? it->second: (size_t)wxNOT_FOUND;
+}
+
+bool wxTreeListMainWindow::IsLastChild (wxTreeListItem *parent, wxTreeListItem *child) const {
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (parent);
+    if (!virt) return parent->GetChildren().Last() == child;
+    return GetChildIndex (parent, child) == virt->m_count-1;
+}
+
+wxTreeListItem *wxTreeListMainWindow::GetVirtualChild (wxTreeListItem *parent, size_t index) {
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (parent);
+    wxCHECK_MSG (virt && (index < virt->m_count), (wxTreeListItem*)NULL, _T("invalid virtual child index"));
+
+    wxTreeListIndexItemMap::iterator it = virt->m_items.find (index);
+    if (it != virt->m_items.end()) return it->second;
+
+    // walks over the children ask for the next ones soon, so the whole
+    // block around the child is created with one call of the user code
+    wxTreeListVirtualRun stray;
+    stray.m_parent = parent;
+    stray.m_first = index - index % VIRTUAL_FETCH_SIZE;
+    stray.m_count = wxMin (VIRTUAL_FETCH_SIZE, virt->m_count - stray.m_first);
+    stray.m_x = stray.m_y = 0;
+    MaterializeVirtualChildren (parent, stray.m_first, stray.m_count);
+    if (!m_dirty) {
+        for (size_t n = stray.m_first; n < stray.m_first + stray.m_count; ++n) {
+            PlaceVirtualChild (virt->m_items[n], n);
+        }
+    }
+
+    // the block may be far from the range kept by the last release
+    m_strays.Add (stray);
+    m_strayCount += stray.m_count;
+    if (m_strayCount > VIRTUAL_POOL_SIZE) ReleaseStrays();
+    return virt->m_items[index];
+}
+
+// releases the oldest blocks of m_strays until half of the pool is left, the
+// newest block is always kept since its children are just being used
+void wxTreeListMainWindow::ReleaseStrays() {
+    // without a valid layout the children have no position to keep them for
+    int y_start = m_keptStart;
+    int y_end = m_keptEnd;
+    if (m_dirty || !m_keptValid) {
+        y_start = 1;
+        y_end = -m_lineHeight - 1;
+    }
+    size_t released = 0;
+    while ((released + 1 < m_strays.GetCount()) && (m_strayCount > VIRTUAL_POOL_SIZE/2)) {
+        const wxTreeListVirtualRun& stray = m_strays[released];
+        for (size_t n = stray.m_first; n < stray.m_first + stray.m_count; ++n) {
+            ReleaseVirtualChild (stray.m_parent, n, y_start, y_end);
+        }
+        m_strayCount -= stray.m_count;
+        ++released;
+    }
+    m_strays.RemoveAt (0, released);
+}
+
+// creates the missing children of the range, asking the user code only once
+// for each contiguous block of them
+void wxTreeListMainWindow::MaterializeVirtualChildren (wxTreeListItem *parent,
+                                                       size_t from, size_t count) {
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (parent);
+    size_t end = from + count;
+    size_t index = from;
+    while (index < end) {
+        if (virt->m_items.find (index) != virt->m_items.end()) {
+            ++index;
+            continue;
+        }
+        size_t first = index;
+        while ((index < end) && (virt->m_items.find (index) == virt->m_items.end())) ++index;
+        size_t missing = index - first;
+
+        wxTreeItemData **data = new wxTreeItemData*[missing];
+        bool *hasChildren = new bool[missing];
+        for (size_t n = 0; n < missing; ++n) {
+            data[n] = (wxTreeItemData*)NULL;
+            hasChildren[n] = false;
+        }
+        m_owner->OnGetVirtualChildren (parent, first, missing, data, hasChildren);
+
+        for (size_t n = 0; n < missing; ++n) {
+            wxTreeListItem *child;
+            if (!m_itemPool.IsEmpty()) {
+                child = m_itemPool.Last();
+                m_itemPool.RemoveAt (m_itemPool.GetCount()-1);
+                child->Reset (parent, data[n]);
+            }else{
+                wxArrayString arr;
+                arr.Alloc (GetColumnCount());
+                for (int i = 0; i < (int)GetColumnCount(); ++i) arr.Add (wxEmptyString);
+                child = new wxTreeListItem (this, parent, arr, NO_IMAGE, NO_IMAGE, data[n]);
+            }
+            if (data[n] != NULL) {
+#if !wxCHECK_VERSION(2, 5, 0)
+                data[n]->SetId ((long)child);
+#else
+                data[n]->SetId (child);
+#endif
+            }
+            child->SetHasPlus (hasChildren[n]);
+            virt->m_items[first+n] = child;
+            virt->m_indices[child] = first+n;
+        }
+        delete [] data;
+        delete [] hasChildren;
+    }
+}
+
+void wxTreeListMainWindow::PlaceVirtualChild (wxTreeListItem *child, size_t index) {
+    // the runs of the parent are ordered by their first child
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (child->GetItemParent());
+    size_t lo = 0;
+    size_t hi = virt->m_runs.GetCount();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const wxTreeListVirtualRun& run = m_runs[virt->m_runs[mid]];
+        if (run.m_first + run.m_count <= index) {
+            lo = mid + 1;
+        }else{
+            hi = mid;
+        }
+    }
+    if (lo == virt->m_runs.GetCount()) return;
+    const wxTreeListVirtualRun& run = m_runs[virt->m_runs[lo]];
+    if (index < run.m_first) return; // expanded, it is a row of its own
+    child->SetX (run.m_x);
+    child->SetY (run.m_y + (int)(index - run.m_first) * m_lineHeight);
+}
+
+void wxTreeListMainWindow::PlaceVirtualChildren (const wxTreeListVirtualRun& run,
+                                                 size_t from, size_t to, wxDC& dc) {
+    MaterializeVirtualChildren (run.m_parent, from, to - from);
+
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (run.m_parent);
+    for (size_t index = from; index < to; ++index) {
+        wxTreeListItem *child = virt->m_items[index];
+        if (!child->IsSizeValid()) CalculateSize (child, dc);
+        child->SetX (run.m_x);
+        child->SetY (run.m_y + (int)(index - run.m_first) * m_lineHeight);
+    }
+}
+
+// the state of these items would get lost if they were recycled
+bool wxTreeListMainWindow::IsPinned (wxTreeListItem *item) const {
+    return item->IsExpanded() || item->HasChildren() || GetVirtualChildren (item) ||
+           item->IsSelected() || item->IsBold() || item->GetAttributes() ||
+           (item->GetImage() != NO_IMAGE) ||
+           (item == m_curItem) || (item == m_shiftItem) || (item == m_editItem) ||
+           (item == m_selectItem) || (item == m_select_me) ||
+           (item == m_dragItem) || (item == m_drag_item);
+}
+
+// recycles the virtual children outside of [y_start, y_end] which have no
+// state to keep, visiting only those which may have left that range since
+// the last call
+void wxTreeListMainWindow::ReleaseVirtualChildren (int y_start, int y_end) {
+    if (!m_keptValid) {
+        // the layout changed, all the children have to be looked at
+        wxArrayTreeListItems released;
+        wxTreeListVirtualMap::iterator vit;
+        for (vit = m_virtualChildren.begin(); vit != m_virtualChildren.end(); ++vit) {
+            wxTreeListVirtualChildren *virt = vit->second;
+            wxTreeListIndexItemMap::iterator it;
+            for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+                wxTreeListItem *child = it->second;
+                if ((child->GetY() + m_lineHeight >= y_start) && (child->GetY() <= y_end)) continue;
+                if (IsPinned (child)) continue;
+                released.Add (child);
+            }
+
+            size_t count = released.GetCount();
+            for (size_t n = 0; n < count; ++n) {
+                wxTreeListItem *child = released[n];
+                virt->m_items.erase (virt->m_indices[child]);
+                virt->m_indices.erase (child);
+                RecycleItem (child);
+            }
+            released.Empty();
+        }
+    }else{
+        // the children of the runs in the range kept last time
+        size_t count = m_runs.GetCount();
+        for (size_t n = FindRunIndex (m_keptStart); n < count; ++n) {
+            const wxTreeListVirtualRun& run = m_runs[n];
+            if (run.m_y > m_keptEnd) break;
+            size_t from = run.m_first;
+            if (m_keptStart > run.m_y) from += (m_keptStart - run.m_y) / m_lineHeight;
+            size_t to = run.m_first + (m_keptEnd - run.m_y) / m_lineHeight + 1;
+            if (to > run.m_first + run.m_count) to = run.m_first + run.m_count;
+            for (size_t index = from; index < to; ++index) {
+                ReleaseVirtualChild (run.m_parent, index, y_start, y_end);
+            }
+        }
+        // and the ones created since
+        count = m_strays.GetCount();
+        for (size_t n = 0; n < count; ++n) {
+            const wxTreeListVirtualRun& stray = m_strays[n];
+            for (size_t index = stray.m_first; index < stray.m_first + stray.m_count; ++index) {
+                ReleaseVirtualChild (stray.m_parent, index, y_start, y_end);
+            }
+        }
+    }
+    m_strays.Empty();
+    m_strayCount = 0;
+    m_keptStart = y_start;
+    m_keptEnd = y_end;
+    m_keptValid = true;
+}
+
+void wxTreeListMainWindow::ReleaseVirtualChild (wxTreeListItem *parent, size_t index,
+                                                int y_start, int y_end) {
+    // the parent may have been deleted meanwhile, it is only looked up
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (parent);
+    if (!virt) return;
+    wxTreeListIndexItemMap::iterator it = virt->m_items.find (index);
+    if (it == virt->m_items.end()) return;
+    wxTreeListItem *child = it->second;
+    if ((child->GetY() + m_lineHeight >= y_start) && (child->GetY() <= y_end)) return;
+    if (IsPinned (child)) return;
+    virt->m_items.erase (it);
+    virt->m_indices.erase (child);
+    RecycleItem (child);
+}
+
+void wxTreeListMainWindow::RecycleItem (wxTreeListItem *item) {
+    if (m_itemPool.GetCount() < VIRTUAL_POOL_SIZE) {
+        item->Reset ((wxTreeListItem*)NULL, (wxTreeItemData*)NULL);
+        m_itemPool.Add (item);
+    }else{
+        delete item;
+    }
+}
+
+void wxTreeListMainWindow::DeleteVirtualChildren (wxTreeListItem *item) {
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (item);
+    if (!virt) return;
+    m_virtualChildren.erase (item);
+
+    // only the children in use are known to the user code
+    wxTreeListIndexItemMap::iterator it;
+    for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+        wxTreeListItem *child = it->second;
+        SendDeleteEvent (child);
+        if (m_selectItem == child) m_selectItem = (wxTreeListItem*)NULL;
+        if (m_curItem == child) m_curItem = item;
+        if (m_shiftItem == child) m_shiftItem = item;
+        if (m_select_me == child) m_select_me = (wxTreeListItem*)NULL;
+        child->DeleteChildren (this);
+        delete child;
+    }
+    delete virt;
+}
+
+void wxTreeListMainWindow::SetDragItem (const wxTreeItemId& item) {
+    wxTreeListItem *prevItem = m_dragItem;
+    m_dragItem = (wxTreeListItem*) item.m_pItem;
+    if (prevItem) RefreshLine (prevItem);
+    if (m_dragItem) RefreshLine (m_dragItem);
+}
+
+void wxTreeListMainWindow::CalculateLineHeight() {
+    wxClientDC dc (this);
+    dc.SetFont (m_normalFont);
+    m_lineHeight = (int)(dc.GetCharHeight() + m_linespacing);
+
+    if (m_imageListNormal) {
+        // Calculate a m_lineHeight value from the normal Image sizes.
+        // May be toggle off. Then wxTreeListMainWindow will spread when
+        // necessary (which might look ugly).
+        int n = m_imageListNormal->GetImageCount();
+        for (int i = 0; i < n ; i++) {
+            int width = 0, height = 0;
             m_imageListNormal->GetSize(i, width, height);
             if (height > m_lineHeight) m_lineHeight = height + m_linespacing;
         }
@@ -2979,6 +4252,7 @@ void wxTreeListMainWindow::SetImageList (wxImageList *imageList) {
     m_imageListNormal = imageList;
     m_ownsImageListNormal = false;
     m_dirty = true;
+    if (m_rootItem) InvalidateSizes (m_rootItem, true);
     CalculateLineHeight();
 }
 
@@ -2993,6 +4267,7 @@ void wxTreeListMainWindow::SetButtonsImageList (wxImageList *imageList) {
     m_imageListButtons = imageList;
     m_ownsImageListButtons = false;
     m_dirty = true;
+    if (m_rootItem) InvalidateSizes (m_rootItem, true);
     CalculateLineHeight();
 }
 
@@ -3021,12 +4296,10 @@ void wxTreeListMainWindow::AdjustMyScrollbars() {
         GetScrollPixelsPerUnit (&xUnit, &yUnit);
         if (xUnit == 0) xUnit = GetCharWidth();
         if (yUnit == 0) yUnit = m_lineHeight;
-        int x = 0, y = 0;
-        m_rootItem->GetSize (x, y, this);
-        y += yUnit + 2; // one more scrollbar unit + 2 pixels
+        int y = m_totalHeight + yUnit + 2; // one more scrollbar unit + 2 pixels
         int x_pos = GetScrollPos (wxHORIZONTAL);
         int y_pos = GetScrollPos (wxVERTICAL);
-        x = m_owner->GetHeaderWindow()->GetWidth() + 2;
+        int x = m_owner->GetHeaderWindow()->GetWidth() + 2;
         if (x < GetClientSize().GetWidth()) x_pos = 0;
         SetScrollbars (xUnit, yUnit, x/xUnit, y/yUnit, x_pos, y_pos);
     }else{
@@ -3067,7 +4340,7 @@ void wxTreeListMainWindow::PaintItem (wxTreeListItem *item, wxDC& dc) {
     wxDCClipper clipper (dc, 0, item->GetY(), total_w, total_h); // only within line
 
     int text_w = 0, text_h = 0;
-    dc.GetTextExtent( item->GetText(GetMainColumn()), &text_w, &text_h );
+    m_extentCache.GetTextExtent (dc, item->GetText(GetMainColumn()), &text_w, &text_h);
 
     // determine background and show it
     wxColour colBg;
@@ -3152,12 +4425,12 @@ void wxTreeListMainWindow::PaintItem (wxTreeListItem *item, wxDC& dc) {
             // nothing to do, already left aligned
             break;
         case wxALIGN_RIGHT:
-            dc.GetTextExtent (text, &text_w, NULL);
+            m_extentCache.GetTextExtent (dc, text, &text_w, NULL);
             w = col_w - (image_w + text_w + off_w + MARGIN);
             x += (w > 0)? w: 0;
             break;
         case wxALIGN_CENTER:
-            dc.GetTextExtent(text, &text_w, NULL);
+            m_extentCache.GetTextExtent (dc, text, &text_w, NULL);
             w = (col_w - (image_w + text_w + off_w + MARGIN))/2;
             x += (w > 0)? w: 0;
             break;
@@ -3233,151 +4506,143 @@ void wxTreeListMainWindow::PaintItem (wxTreeListItem *item, wxDC& dc) {
     dc.SetFont( m_normalFont );
 }
 
-// Now y stands for the top of the item, whereas it used to stand for middle !
-void wxTreeListMainWindow::PaintLevel (wxTreeListItem *item, wxDC &dc,
-                                       int level, int &y, int x_maincol) {
-
-    // Handle hide root (only level 0)
-    if (HasFlag(wxTR_HIDE_ROOT) && (level == 0)) {
-        wxArrayTreeListItems& children = item->GetChildren();
-        for (size_t n = 0; n < children.Count(); n++) {
-            PaintLevel (children[n], dc, 1, y, x_maincol);
-        }
-        // end after expanding root
-        return;
-    }
-
-    // calculate position of vertical lines
-    int x = x_maincol + MARGIN; // start of column
-    if (HasFlag(wxTR_LINES_AT_ROOT)) x += LINEATROOT; // space for lines at root
-    if (HasButtons()) {
-        x += (m_btnWidth-m_btnWidth2); // half button space
-    }else{
-        x += (m_indent-m_indent/2);
-    }
-    if (HasFlag(wxTR_HIDE_ROOT)) {
-        x += m_indent * (level-1); // indent but not level 1
-    }else{
-        x += m_indent * level; // indent according to level
-    }
-
-    // set position of vertical line
-    item->SetX (x);
-    item->SetY (y);
+// y positions are those computed by CalculatePositions(), the row is only
+// painted, the layout is not changed here
+void wxTreeListMainWindow::PaintRow (wxTreeListItem *item, wxDC &dc, int x_maincol) {
 
+    int x = item->GetX();
     int h = GetLineHeight (item);
-    int y_top = y;
+    int y_top = item->GetY();
     int y_mid = y_top + (h/2);
-    y += h;
-
-    int exposed_x = dc.LogicalToDeviceX(0);
-    int exposed_y = dc.LogicalToDeviceY(y_top);
 
-    if (IsExposed(exposed_x, exposed_y, 10000, h)) { // 10000 = very much
-
-        if (HasFlag(wxTR_ROW_LINES)) { // horizontal lines between rows
-            //dc.DestroyClippingRegion();
-            int total_width = m_owner->GetHeaderWindow()->GetWidth();
-            // if the background colour is white, choose a
-            // contrasting color for the lines
+    if (HasFlag(wxTR_ROW_LINES)) { // horizontal lines between rows
+        //dc.DestroyClippingRegion();
+        int total_width = m_owner->GetHeaderWindow()->GetWidth();
+        // if the background colour is white, choose a
+        // contrasting color for the lines
 #if !wxCHECK_VERSION(2, 5, 0)
-            wxPen pen (wxSystemSettings::GetSystemColour (wxSYS_COLOUR_3DLIGHT ), 1, wxSOLID);
+        wxPen pen (wxSystemSettings::GetSystemColour (wxSYS_COLOUR_3DLIGHT ), 1, wxSOLID);
 #else
-            wxPen pen (wxSystemSettings::GetColour (wxSYS_COLOUR_3DLIGHT ), 1, wxSOLID);
+        wxPen pen (wxSystemSettings::GetColour (wxSYS_COLOUR_3DLIGHT ), 1, wxSOLID);
 #endif
-            dc.SetPen ((GetBackgroundColour() == *wxWHITE)? pen: *wxWHITE_PEN);
-            dc.DrawLine (0, y_top, total_width, y_top);
-            dc.DrawLine (0, y_top+h, total_width, y_top+h);
-        }
+        dc.SetPen ((GetBackgroundColour() == *wxWHITE)? pen: *wxWHITE_PEN);
+        dc.DrawLine (0, y_top, total_width, y_top);
+        dc.DrawLine (0, y_top+h, total_width, y_top+h);
+    }
 
-        // draw item
-        PaintItem (item, dc);
+    // draw item
+    PaintItem (item, dc);
 
-        // restore DC objects
-        dc.SetBrush(*wxWHITE_BRUSH);
-        dc.SetPen(m_dottedPen);
+    // restore DC objects
+    dc.SetBrush(*wxWHITE_BRUSH);
+    dc.SetPen(m_dottedPen);
 
-        // clip to the column width
-        int clip_width = m_owner->GetHeaderWindow()->
-                            GetColumn(m_main_column).GetWidth();
-        wxDCClipper clipper(dc, x_maincol, y_top, clip_width, 10000);
+    // clip to the column width
+    int clip_width = m_owner->GetHeaderWindow()->
+                        GetColumn(m_main_column).GetWidth();
+    wxDCClipper clipper(dc, x_maincol, y_top, clip_width, 10000);
 
-        if (!HasFlag(wxTR_NO_LINES)) { // connection lines
+    if (!HasFlag(wxTR_NO_LINES)) { // connection lines
 
-            // draw the horizontal line here
-            dc.SetPen(m_dottedPen);
-            int x2 = x - m_indent;
-            if (x2 < (x_maincol + MARGIN)) x2 = x_maincol + MARGIN;
-            int x3 = x + (m_btnWidth-m_btnWidth2);
-            if (HasButtons()) {
-                if (item->HasPlus()) {
-                    dc.DrawLine (x2, y_mid, x - m_btnWidth2, y_mid);
-                    dc.DrawLine (x3, y_mid, x3 + LINEATROOT, y_mid);
-                }else{
-                    dc.DrawLine (x2, y_mid, x3 + LINEATROOT, y_mid);
-                }
+        // draw the horizontal line here
+        dc.SetPen(m_dottedPen);
+        int x2 = x - m_indent;
+        if (x2 < (x_maincol + MARGIN)) x2 = x_maincol + MARGIN;
+        int x3 = x + (m_btnWidth-m_btnWidth2);
+        if (HasButtons()) {
+            if (item->HasPlus()) {
+                dc.DrawLine (x2, y_mid, x - m_btnWidth2, y_mid);
+                dc.DrawLine (x3, y_mid, x3 + LINEATROOT, y_mid);
             }else{
-                dc.DrawLine (x2, y_mid, x - m_indent/2, y_mid);
+                dc.DrawLine (x2, y_mid, x3 + LINEATROOT, y_mid);
             }
+        }else{
+            dc.DrawLine (x2, y_mid, x - m_indent/2, y_mid);
         }
 
-        if (item->HasPlus() && HasButtons()) { // should the item show a button?
-
-            if (m_imageListButtons) {
-
-                // draw the image button here
-                int image = wxTreeItemIcon_Normal;
-                if (item->IsExpanded()) image = wxTreeItemIcon_Expanded;
-                if (item->IsSelected()) image += wxTreeItemIcon_Selected - wxTreeItemIcon_Normal;
-                int xx = x - m_btnWidth2 + MARGIN;
-                int yy = y_mid - m_btnHeight2;
-                dc.SetClippingRegion(xx, yy, m_btnWidth, m_btnHeight);
-                m_imageListButtons->Draw (image, dc, xx, yy, wxIMAGELIST_DRAW_TRANSPARENT);
-                dc.DestroyClippingRegion();
-
-            }else if (HasFlag (wxTR_TWIST_BUTTONS)) {
-
-                // draw the twisty button here
-                dc.SetPen(*wxBLACK_PEN);
-                dc.SetBrush(*m_hilightBrush);
-                wxPoint button[3];
-                if (item->IsExpanded()) {
-                    button[0].x = x - (m_btnWidth2+1);
-                    button[0].y = y_mid - (m_btnHeight/3);
-                    button[1].x = x + (m_btnWidth2+1);
-                    button[1].y = button[0].y;
-                    button[2].x = x;
-                    button[2].y = button[0].y + (m_btnHeight2+1);
-                }else{
-                    button[0].x = x - (m_btnWidth/3);
-                    button[0].y = y_mid - (m_btnHeight2+1);
-                    button[1].x = button[0].x;
-                    button[1].y = y_mid + (m_btnHeight2+1);
-                    button[2].x = button[0].x + (m_btnWidth2+1);
-                    button[2].y = y_mid;
-                }
-                dc.DrawPolygon(3, button);
+        // the vertical line to the children starts below the item
+        if (item->IsExpanded() && (CountChildren (item, false) > 0)) {
+            int oldY;
+            if (m_imgWidth > 0) {
+                oldY = y_mid + m_imgHeight2;
+            }else{
+                oldY = y_mid + h/2;
+            }
+            dc.DrawLine (x, oldY, x, y_top + h);
+        }
 
-            }else{ // if (HasFlag(wxTR_HAS_BUTTONS))
+        // the vertical lines of the ancestors crossing this row, a line
+        // ends in the middle of the last child of its item
+        wxTreeListItem *child = item;
+        wxTreeListItem *parent = item->GetItemParent();
+        while (parent && !(parent == m_rootItem && HasFlag(wxTR_HIDE_ROOT))) {
+            bool isLast = IsLastChild (parent, child);
+            int px = parent->GetX();
+            if (child == item) {
+                dc.DrawLine (px, y_top, px, isLast? y_mid: y_top + h);
+            }else if (!isLast) {
+                dc.DrawLine (px, y_top, px, y_top + h);
+            }
+            child = parent;
+            parent = parent->GetItemParent();
+        }
+    }
 
-                // draw the plus sign here
+    if (item->HasPlus() && HasButtons()) { // should the item show a button?
+
+        if (m_imageListButtons) {
+
+            // draw the image button here
+            int image = wxTreeItemIcon_Normal;
+            if (item->IsExpanded()) image = wxTreeItemIcon_Expanded;
+            if (item->IsSelected()) image += wxTreeItemIcon_Selected - wxTreeItemIcon_Normal;
+            int xx = x - m_btnWidth2 + MARGIN;
+            int yy = y_mid - m_btnHeight2;
+            dc.SetClippingRegion(xx, yy, m_btnWidth, m_btnHeight);
+            m_imageListButtons->Draw (image, dc, xx, yy, wxIMAGELIST_DRAW_TRANSPARENT);
+            dc.DestroyClippingRegion();
+
+        }else if (HasFlag (wxTR_TWIST_BUTTONS)) {
+
+            // draw the twisty button here
+            dc.SetPen(*wxBLACK_PEN);
+            dc.SetBrush(*m_hilightBrush);
+            wxPoint button[3];
+            if (item->IsExpanded()) {
+                button[0].x = x - (m_btnWidth2+1);
+                button[0].y = y_mid - (m_btnHeight/3);
+                button[1].x = x + (m_btnWidth2+1);
+                button[1].y = button[0].y;
+                button[2].x = x;
+                button[2].y = button[0].y + (m_btnHeight2+1);
+            }else{
+                button[0].x = x - (m_btnWidth/3);
+                button[0].y = y_mid - (m_btnHeight2+1);
+                button[1].x = button[0].x;
+                button[1].y = y_mid + (m_btnHeight2+1);
+                button[2].x = button[0].x + (m_btnWidth2+1);
+                button[2].y = y_mid;
+            }
+            dc.DrawPolygon(3, button);
+
+        }else{ // if (HasFlag(wxTR_HAS_BUTTONS))
+
+            // draw the plus sign here
 #if !wxCHECK_VERSION(2, 7, 0)
-                dc.SetPen(*wxGREY_PEN);
-                dc.SetBrush(*wxWHITE_BRUSH);
-                dc.DrawRectangle (x-m_btnWidth2, y_mid-m_btnHeight2, m_btnWidth, m_btnHeight);
-                dc.SetPen(*wxBLACK_PEN);
-                dc.DrawLine (x-(m_btnWidth2-2), y_mid, x+(m_btnWidth2-1), y_mid);
-                if (!item->IsExpanded()) { // change "-" to "+"
-                    dc.DrawLine (x, y_mid-(m_btnHeight2-2), x, y_mid+(m_btnHeight2-1));
-                }
+            dc.SetPen(*wxGREY_PEN);
+            dc.SetBrush(*wxWHITE_BRUSH);
+            dc.DrawRectangle (x-m_btnWidth2, y_mid-m_btnHeight2, m_btnWidth, m_btnHeight);
+            dc.SetPen(*wxBLACK_PEN);
+            dc.DrawLine (x-(m_btnWidth2-2), y_mid, x+(m_btnWidth2-1), y_mid);
+            if (!item->IsExpanded()) { // change "-" to "+"
+                dc.DrawLine (x, y_mid-(m_btnHeight2-2), x, y_mid+(m_btnHeight2-1));
+            }
 #else
-                wxRect rect (x-m_btnWidth2, y_mid-m_btnHeight2, m_btnWidth, m_btnHeight);
-                int flag = item->IsExpanded()? wxCONTROL_EXPANDED: 0;
-                wxRendererNative::GetDefault().DrawTreeItemButton (this, dc, rect, flag);
+            wxRect rect (x-m_btnWidth2, y_mid-m_btnHeight2, m_btnWidth, m_btnHeight);
+            int flag = item->IsExpanded()? wxCONTROL_EXPANDED: 0;
+            wxRendererNative::GetDefault().DrawTreeItemButton (this, dc, rect, flag);
 #endif
 
-            }
-
         }
 
     }
@@ -3386,37 +4651,46 @@ void wxTreeListMainWindow::PaintLevel (wxTreeListItem *item, wxDC &dc,
     dc.SetBrush(*wxWHITE_BRUSH);
     dc.SetPen(m_dottedPen);
     dc.SetTextForeground(*wxBLACK);
+}
 
-    if (item->IsExpanded())
-    {
-        wxArrayTreeListItems& children = item->GetChildren();
-
-        // clip to the column width
-        int clip_width = m_owner->GetHeaderWindow()->
-                            GetColumn(m_main_column).GetWidth();
-
-        // process lower levels
-        int oldY;
-        if (m_imgWidth > 0) {
-            oldY = y_mid + m_imgHeight2;
+size_t wxTreeListMainWindow::FindRowIndex (int y) const {
+    // rows are sorted by their Y position, so a binary search will do
+    size_t lo = 0;
+    size_t hi = m_rows.GetCount();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        wxTreeListItem *row = m_rows[mid];
+        if (row->GetY() + GetLineHeight (row) < y) {
+            lo = mid + 1;
         }else{
-            oldY = y_mid + h/2;
+            hi = mid;
         }
-        int y2;
-        for (size_t n = 0; n < children.Count(); ++n) {
-
-            y2 = y + h/2;
-            PaintLevel (children[n], dc, level+1, y, x_maincol);
-
-            // draw vertical line
-            wxDCClipper clipper(dc, x_maincol, y_top, clip_width, 10000);
-            if (!HasFlag (wxTR_NO_LINES)) {
-                x = item->GetX();
-                dc.DrawLine (x, oldY, x, y2);
-                oldY = y2;
-            }
+    }
+    return lo;
+}
+
+size_t wxTreeListMainWindow::FindItemRow (wxTreeListItem *item) const {
+    // the Y position of an item hidden in a collapsed branch is outdated,
+    // so the row found must be the item itself
+    size_t n = FindRowIndex (item->GetY() + 1);
+    if ((n < m_rows.GetCount()) && (m_rows[n] == item)) return n;
+    return m_rows.GetCount();
+}
+
+size_t wxTreeListMainWindow::FindRunIndex (int y) const {
+    // runs are sorted by their Y position as well
+    size_t lo = 0;
+    size_t hi = m_runs.GetCount();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const wxTreeListVirtualRun& run = m_runs[mid];
+        if (run.m_y + (int)run.m_count * m_lineHeight < y) {
+            lo = mid + 1;
+        }else{
+            hi = mid;
         }
     }
+    return lo;
 }
 
 
@@ -3431,43 +4705,55 @@ void wxTreeListMainWindow::OnPaint (wxPaintEvent &WXUNUSED(event)) {
 
     if (!m_rootItem || (GetColumnCount() <= 0)) return;
 
-    // calculate button size
-    if (m_imageListButtons) {
-        m_imageListButtons->GetSize (0, m_btnWidth, m_btnHeight);
-    }else if (HasButtons()) {
-        m_btnWidth = BTNWIDTH;
-        m_btnHeight = BTNHEIGHT;
-    }
-    m_btnWidth2 = m_btnWidth/2;
-    m_btnHeight2 = m_btnHeight/2;
-
-    // calculate image size
-    if (m_imageListNormal) {
-        m_imageListNormal->GetSize (0, m_imgWidth, m_imgHeight);
-    }
-    m_imgWidth2 = m_imgWidth/2;
-    m_imgHeight2 = m_imgHeight/2;
-
-    // calculate indent size
-    if (m_imageListButtons) {
-        m_indent = wxMax (MININDENT, m_btnWidth + MARGIN);
-    }else if (HasButtons()) {
-        m_indent = wxMax (MININDENT, m_btnWidth + LINEATROOT);
-    }
+    // the layout may be outdated if we are painted before the next idle time
+    if (m_dirty) CalculatePositions();
 
     // set default values
     dc.SetFont( m_normalFont );
     dc.SetPen( m_dottedPen );
 
-    // calculate column start and paint
+    // calculate column start
     int x_maincol = 0;
     int i = 0;
     for (i = 0; i < (int)GetMainColumn(); ++i) {
         if (!m_owner->GetHeaderWindow()->IsColumnShown(i)) continue;
         x_maincol += m_owner->GetHeaderWindow()->GetColumnWidth (i);
     }
-    int y = 0;
-    PaintLevel (m_rootItem, dc, 0, y, x_maincol);
+
+    // paint only the rows within the update region
+    wxRect upd = GetUpdateRegion().GetBox();
+    int dummy = 0;
+    int y_start = 0, y_end = 0;
+    CalcUnscrolledPosition (0, upd.GetTop(), &dummy, &y_start);
+    CalcUnscrolledPosition (0, upd.GetBottom(), &dummy, &y_end);
+    size_t count = m_rows.GetCount();
+    for (size_t n = FindRowIndex (y_start); n < count; ++n) {
+        wxTreeListItem *row = m_rows[n];
+        if (row->GetY() > y_end) break;
+        PaintRow (row, dc, x_maincol);
+    }
+    if (m_runs.IsEmpty()) return;
+
+    // virtual children scrolled far enough out of view are recycled, the
+    // ones to be painted are created as needed
+    int client_h = GetClientSize().GetHeight();
+    int view_start = 0;
+    CalcUnscrolledPosition (0, 0, &dummy, &view_start);
+    ReleaseVirtualChildren (view_start - client_h, view_start + 2*client_h);
+
+    count = m_runs.GetCount();
+    for (size_t n = FindRunIndex (y_start); n < count; ++n) {
+        const wxTreeListVirtualRun& run = m_runs[n];
+        if (run.m_y > y_end) break;
+        size_t from = run.m_first;
+        if (y_start > run.m_y) from += (y_start - run.m_y) / m_lineHeight;
+        size_t to = run.m_first + (y_end - run.m_y) / m_lineHeight + 1;
+        if (to > run.m_first + run.m_count) to = run.m_first + run.m_count;
+        if (from >= to) continue;
+        PlaceVirtualChildren (run, from, to, dc);
+        wxTreeListVirtualChildren *virt = GetVirtualChildren (run.m_parent);
+        for (size_t i = from; i < to; ++i) PaintRow (virt->m_items[i], dc, x_maincol);
+    }
 }
 
 void wxTreeListMainWindow::OnSetFocus (wxFocusEvent &event) {
@@ -3712,8 +4998,7 @@ wxTreeItemId wxTreeListMainWindow::HitTest (const wxPoint& point, int& flags, in
         return wxTreeItemId();
     }
 
-    wxTreeListItem *hit = m_rootItem->HitTest (CalcUnscrolledPosition(point),
-                                               this, flags, column, 0);
+    wxTreeListItem *hit = HitTestRow (CalcUnscrolledPosition (point), flags, column);
     if (!hit) {
         flags = wxTREE_HITTEST_NOWHERE;
         column = -1;
@@ -3722,6 +5007,36 @@ wxTreeItemId wxTreeListMainWindow::HitTest (const wxPoint& point, int& flags, in
     return hit;
 }
 
+wxTreeListItem *wxTreeListMainWindow::HitTestRow (const wxPoint& pos, int& flags, int& column) {
+
+    // ensure that the position of the items is calculated in any case
+    if (m_dirty) CalculatePositions();
+
+    // only the row under the point needs to be tested, the hidden root is
+    // never part of the rows
+    flags = 0;
+    column = -1;
+    size_t n = FindRowIndex (pos.y);
+    if (n < m_rows.GetCount()) {
+        wxTreeListItem *hit = m_rows[n]->HitTest (pos, this, flags, column, 1);
+        if (hit) return hit;
+    }
+
+    // otherwise the point may be on a virtual child within a run
+    n = FindRunIndex (pos.y);
+    if (n >= m_runs.GetCount()) return (wxTreeListItem*)NULL;
+    const wxTreeListVirtualRun& run = m_runs[n];
+    if (pos.y < run.m_y) return (wxTreeListItem*)NULL;
+    size_t index = run.m_first + (pos.y - run.m_y) / m_lineHeight;
+    if (index >= run.m_first + run.m_count) return (wxTreeListItem*)NULL;
+    wxTreeListItem *child = GetVirtualChild (run.m_parent, index);
+    if (!child->IsSizeValid()) {
+        wxClientDC dc (this);
+        CalculateSize (child, dc);
+    }
+    return child->HitTest (pos, this, flags, column, 1);
+}
+
 // get the bounding rectangle of the item (or of its label only)
 bool wxTreeListMainWindow::GetBoundingRect (const wxTreeItemId& itemId, wxRect& rect,
                                             bool WXUNUSED(textOnly)) const {
@@ -3841,8 +5156,7 @@ void wxTreeListMainWindow::OnMouse (wxMouseEvent &event) {
     // determine event
     wxPoint p = wxPoint (event.GetX(), event.GetY());
     int flags = 0;
-    wxTreeListItem *item = m_rootItem->HitTest (CalcUnscrolledPosition (p),
-                                                this, flags, m_curColumn, 0);
+    wxTreeListItem *item = HitTestRow (CalcUnscrolledPosition (p), flags, m_curColumn);
 
     // we only process dragging here
     if (event.Dragging() && m_should_return) { 
@@ -4042,6 +5356,11 @@ void wxTreeListMainWindow::OnIdle (wxIdleEvent &WXUNUSED(event)) {
     /* after all changes have been done to the tree control,
      * we actually redraw the tree when everything is over */
 
+#if wxUSE_THREADS
+    // apply the result of a background sort once it is done
+    if (m_sortThread && !m_sortThread->IsAlive()) FinishBackgroundSort (true);
+#endif
+
     if (!m_dirty) return;
     m_dirty = false;
 
@@ -4085,7 +5404,7 @@ void wxTreeListMainWindow::CalculateSize (wxTreeListItem *item, wxDC &dc) {
 
     dc.SetFont (GetItemFont (item));
 
-    dc.GetTextExtent (item->GetText (m_main_column), &text_w, &text_h);
+    m_extentCache.GetTextExtent (dc, item->GetText (m_main_column), &text_w, &text_h);
 
     // restore normal font
     dc.SetFont (m_normalFont);
@@ -4100,6 +5419,7 @@ void wxTreeListMainWindow::CalculateSize (wxTreeListItem *item, wxDC &dc) {
     item->SetHeight (total_h);
     if (total_h > m_lineHeight) m_lineHeight = total_h;
     item->SetWidth(m_imgWidth + text_w+2);
+    item->ValidateSize();
 }
 
 // -----------------------------------------------------------------------------
@@ -4107,44 +5427,158 @@ void wxTreeListMainWindow::CalculateLevel (wxTreeListItem *item, wxDC &dc,
                                            int level, int &y, int x_colstart) {
 
     // calculate position of vertical lines
-    int x = x_colstart + MARGIN; // start of column
-    if (HasFlag(wxTR_LINES_AT_ROOT)) x += LINEATROOT; // space for lines at root
-    if (HasButtons()) {
-        x += (m_btnWidth-m_btnWidth2); // half button space
-    }else{
-        x += (m_indent-m_indent/2);
-    }
-    if (HasFlag(wxTR_HIDE_ROOT)) {
-        x += m_indent * (level-1); // indent but not level 1
-    }else{
-        x += m_indent * level; // indent according to level
-    }
+    int x = GetLevelX (level, x_colstart);
 
     // a hidden root is not evaluated, but its children are always
     if (HasFlag(wxTR_HIDE_ROOT) && (level == 0)) goto Recurse;
 
-    CalculateSize( item, dc );
+    // sizes are only measured again after they have been invalidated, the
+    // line height is reset meanwhile though
+    if (!item->IsSizeValid()) {
+        CalculateSize( item, dc );
+    }else if (item->GetHeight() > m_lineHeight) {
+        m_lineHeight = item->GetHeight();
+    }
 
     // set its position
     item->SetX (x);
     item->SetY (y);
     y += GetLineHeight(item);
+    m_rows.Add (item);
 
     // we don't need to calculate collapsed branches
     if ( !item->IsExpanded() ) return;
 
 Recurse:
+    ++level;
+    if (GetVirtualChildren (item)) {
+        CalculateVirtualLevel (item, dc, level, y, x_colstart);
+        return;
+    }
     wxArrayTreeListItems& children = item->GetChildren();
     long n, count = (long)children.Count();
-    ++level;
     for (n = 0; n < count; ++n) {
         CalculateLevel( children[n], dc, level, y, x_colstart );  // recurse
     }
 }
 
+void wxTreeListMainWindow::CalculateMetrics() {
+
+    // calculate button size
+    if (m_imageListButtons) {
+        m_imageListButtons->GetSize (0, m_btnWidth, m_btnHeight);
+    }else if (HasButtons()) {
+        m_btnWidth = BTNWIDTH;
+        m_btnHeight = BTNHEIGHT;
+    }
+    m_btnWidth2 = m_btnWidth/2;
+    m_btnHeight2 = m_btnHeight/2;
+
+    // calculate image size
+    if (m_imageListNormal) {
+        m_imageListNormal->GetSize (0, m_imgWidth, m_imgHeight);
+    }
+    m_imgWidth2 = m_imgWidth/2;
+    m_imgHeight2 = m_imgHeight/2;
+
+    // calculate indent size
+    if (m_imageListButtons) {
+        m_indent = wxMax (MININDENT, m_btnWidth + MARGIN);
+    }else if (HasButtons()) {
+        m_indent = wxMax (MININDENT, m_btnWidth + LINEATROOT);
+    }
+}
+
+int wxTreeListMainWindow::GetLevelX (int level, int x_colstart) const {
+    int x = x_colstart + MARGIN; // start of column
+    if (HasFlag(wxTR_LINES_AT_ROOT)) x += LINEATROOT; // space for lines at root
+    if (HasButtons()) {
+        x += (m_btnWidth-m_btnWidth2); // half button space
+    }else{
+        x += (m_indent-m_indent/2);
+    }
+    if (HasFlag(wxTR_HIDE_ROOT)) {
+        x += m_indent * (level-1); // indent but not level 1
+    }else{
+        x += m_indent * level; // indent according to level
+    }
+    return x;
+}
+
+// virtual children are laid out as runs of uniform rows, only the expanded
+// ones become ordinary rows since their children follow them
+void wxTreeListMainWindow::CalculateVirtualLevel (wxTreeListItem *item, wxDC &dc,
+                                                  int level, int &y, int x_colstart) {
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (item);
+    int x = GetLevelX (level, x_colstart);
+
+    wxArrayLong expanded;
+    wxTreeListIndexItemMap::iterator it;
+    for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+        if (it->second->IsExpanded()) expanded.Add ((long)it->first);
+    }
+    expanded.Sort (wxTreeListCompareIndices);
+
+    size_t pos = 0;
+    size_t count = expanded.GetCount();
+    for (size_t n = 0; n <= count; ++n) {
+        size_t next = (n < count)? (size_t)expanded[n]: virt->m_count;
+        if (next > pos) {
+            wxTreeListVirtualRun run;
+            run.m_parent = item;
+            run.m_first = pos;
+            run.m_count = next - pos;
+            run.m_x = x;
+            run.m_y = y;
+            virt->m_runs.Add ((int)m_runs.GetCount());
+            m_runs.Add (run);
+            y += (int)run.m_count * m_lineHeight;
+        }
+        if (n < count) {
+            CalculateLevel (virt->m_items[next], dc, level, y, x_colstart);
+            pos = next + 1;
+        }
+    }
+
+    // the other children in use keep their place within the runs
+    for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+        wxTreeListItem *child = it->second;
+        if (child->IsExpanded()) continue;
+        if (!child->IsSizeValid()) {
+            CalculateSize (child, dc);
+        }else if (child->GetHeight() > m_lineHeight) {
+            m_lineHeight = child->GetHeight();
+        }
+        PlaceVirtualChild (child, it->first);
+    }
+}
+
+// applies the logged moves to all the rows and empties the log
+void wxTreeListMainWindow::ClearShifts() {
+    size_t count = m_rows.GetCount();
+    for (size_t n = 0; n < count; ++n) m_rows[n]->GetY();
+    m_shiftBase += m_shiftTops.GetCount();
+    m_shiftTops.Empty();
+    m_shiftDeltas.Empty();
+}
+
 void wxTreeListMainWindow::CalculatePositions() {
+    // all the rows are placed again, the logged moves are not needed
+    m_shiftBase += m_shiftTops.GetCount();
+    m_shiftTops.Empty();
+    m_shiftDeltas.Empty();
+    m_rows.Empty();
+    m_runs.Empty();
+    wxTreeListVirtualMap::iterator vit;
+    for (vit = m_virtualChildren.begin(); vit != m_virtualChildren.end(); ++vit) {
+        vit->second->m_runs.Empty();
+    }
+    m_keptValid = false;
+    m_totalHeight = 0;
     if ( !m_rootItem ) return;
 
+    CalculateMetrics();
+
     wxClientDC dc(this);
     PrepareDC( dc );
 
@@ -4154,13 +5588,111 @@ void wxTreeListMainWindow::CalculatePositions() {
     //if(GetImageList() == NULL)
     // m_lineHeight = (int)(dc.GetCharHeight() + 4);
 
-    int y = 2;
+    int y = 0;
+    CalculateLevel( m_rootItem, dc, 0, y, GetMainColumnX() ); // start recursion
+    m_totalHeight = y;
+}
+
+int wxTreeListMainWindow::GetMainColumnX() const {
     int x_colstart = 0;
     for (int i = 0; i < (int)GetMainColumn(); ++i) {
         if (!m_owner->GetHeaderWindow()->IsColumnShown(i)) continue;
         x_colstart += m_owner->GetHeaderWindow()->GetColumnWidth(i);
     }
-    CalculateLevel( m_rootItem, dc, 0, y, x_colstart ); // start recursion
+    return x_colstart;
+}
+
+// lays out again only the rows of the branch of item after it was expanded,
+// collapsed or reordered: they replace the old ones in m_rows and the move
+// of the rows below is logged, they are neither measured nor walked nor
+// moved one by one (in m_rows they only take part in a memmove).
+// The whole layout is still done at idle time if the layout is outdated
+// anyway, for virtual runs, a hidden root or a change of the line height.
+// It is also done in single selection mode while nothing is selected, since
+// OnIdle then selects an item (the root or the first one) before the layout
+void wxTreeListMainWindow::RelayoutBranch (wxTreeListItem *item) {
+    if (m_dirty) return;
+    if (!m_runs.IsEmpty() || GetVirtualChildren (item) ||
+        ((item == m_rootItem) && HasFlag(wxTR_HIDE_ROOT)) ||
+        (!m_owner->HasFlag(wxTR_MULTIPLE) && !m_owner->GetSelection().IsOk())) {
+        m_dirty = true;
+        return;
+    }
+    size_t count = m_rows.GetCount();
+    size_t row = FindItemRow (item);
+    if (row == count) return; // hidden in a collapsed branch, nothing moves
+
+    // the old rows of the branch follow the item and are indented further
+    size_t end = row + 1;
+    while ((end < count) && (m_rows[end]->GetX() > item->GetX())) ++end;
+    int y = item->GetY() + GetLineHeight (item);
+    int old_bottom = (end < count)? m_rows[end]->GetY(): m_totalHeight;
+
+    if (m_shiftTops.GetCount() >= MAX_SHIFTS) ClearShifts();
+    // reserve the log entry first, the new rows of the branch don't move
+    m_shiftTops.Add (old_bottom);
+    m_shiftDeltas.Add (0);
+
+    if (end > row + 1) m_rows.RemoveAt (row + 1, end - row - 1);
+    size_t n;
+    size_t before = m_rows.GetCount();
+
+    int lineHeight = m_lineHeight;
+    if (item->IsExpanded()) {
+        wxClientDC dc(this);
+        PrepareDC( dc );
+        dc.SetFont( m_normalFont );
+        dc.SetPen( m_dottedPen );
+        int level = 1;
+        wxTreeListItem *parent;
+        for (parent = item->GetItemParent(); parent; parent = parent->GetItemParent()) ++level;
+        int x_colstart = GetMainColumnX();
+        wxArrayTreeListItems& children = item->GetChildren();
+        for (n = 0; n < children.GetCount(); ++n) {
+            CalculateLevel (children[n], dc, level, y, x_colstart);
+        }
+    }
+
+    // the new rows were added at the end, they go right after the item
+    size_t added = m_rows.GetCount() - before;
+    if (added > 0) {
+        wxArrayTreeListItems branch;
+        branch.Alloc (added);
+        for (n = before; n < before + added; ++n) branch.Add (m_rows[n]);
+        m_rows.RemoveAt (before, added);
+        m_rows.Insert ((wxTreeListItem*)NULL, row + 1, added);
+        for (n = 0; n < added; ++n) m_rows[row + 1 + n] = branch[n];
+    }
+
+    int delta = y - old_bottom;
+    m_shiftDeltas.Last() = delta;
+    m_totalHeight += delta;
+    m_keptValid = false;
+
+    // new rows taller than the others change the height of all of them
+    if (m_lineHeight != lineHeight) {
+        m_dirty = true;
+        return;
+    }
+    RefreshSubtree (item);
+}
+
+void wxTreeListMainWindow::InvalidateSizes (wxTreeListItem *item, bool recursively) {
+    item->InvalidateSize();
+    if (!recursively) return;
+
+    const wxArrayTreeListItems& children = item->GetChildren();
+    size_t count = children.GetCount();
+    for (size_t n = 0; n < count; ++n) {
+        InvalidateSizes (children[n], true);
+    }
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (item);
+    if (virt) {
+        wxTreeListIndexItemMap::iterator it;
+        for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+            InvalidateSizes (it->second, true);
+        }
+    }
 }
 
 void wxTreeListMainWindow::RefreshSubtree (wxTreeListItem *item) {
@@ -4222,6 +5754,13 @@ void wxTreeListMainWindow::RefreshSelectedUnder (wxTreeListItem *item) {
     for (long n = 0; n < count; n++ ) {
         RefreshSelectedUnder (children[n]);
     }
+    wxTreeListVirtualChildren *virt = GetVirtualChildren (item);
+    if (virt) {
+        wxTreeListIndexItemMap::iterator it;
+        for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+            RefreshSelectedUnder (it->second);
+        }
+    }
 }
 
 // ----------------------------------------------------------------------------
@@ -4248,7 +5787,14 @@ void wxTreeListMainWindow::SetItemText (const wxTreeItemId& itemId, int column,
 
     wxClientDC dc (this);
     wxTreeListItem *item = (wxTreeListItem*) itemId.m_pItem;
+    wxTreeListFindIndexMap::iterator it = m_findIndices.find (column);
+    if ((it != m_findIndices.end()) && !m_findIndicesStale) {
+        it->second->Remove (item);
+        it->second->Add (text.Lower(), item);
+    }
     item->SetText (column, text);
+    ++m_textStamp;
+    item->InvalidateSize();
     CalculateSize (item, dc);
     RefreshLine (item);
 }
@@ -4289,7 +5835,8 @@ int wxTreeListMainWindow::GetItemWidth (int column, wxTreeListItem *item) {
     // determine item width
     int w = 0, h = 0;
     wxFont font = GetItemFont (item);
-    GetTextExtent (item->GetText (column), &w, &h, NULL, NULL, font.Ok()? &font: NULL);
+    if (!font.Ok()) font = GetFont();
+    m_extentCache.GetTextExtent (this, font, item->GetText (column), &w, &h);
     w += 2*MARGIN;
 
     // calculate width
@@ -4329,6 +5876,24 @@ int wxTreeListMainWindow::GetBestColumnWidth (int column, wxTreeItemId parent) {
         if (width > maxWidth) return maxWidth;
     }
 
+    // of virtual children only those in use are considered, asking for all
+    // of them would create them
+    wxTreeListVirtualChildren *virt = GetVirtualChildren ((wxTreeListItem*)parent.m_pItem);
+    if (virt) {
+        wxTreeListIndexItemMap::iterator it;
+        for (it = virt->m_items.begin(); it != virt->m_items.end(); ++it) {
+            int w = GetItemWidth (column, it->second);
+            if (width < w) width = w;
+            if (width > maxWidth) return maxWidth;
+            if (it->second->IsExpanded()) {
+                int w = GetBestColumnWidth (column, it->second);
+                if (width < w) width = w;
+                if (width > maxWidth) return maxWidth;
+            }
+        }
+        return width;
+    }
+
     wxTreeItemIdValue cookie = 0;
     wxTreeItemId item = GetFirstChild (parent, cookie);
     while (item.IsOk()) {
@@ -4755,8 +6320,31 @@ int wxTreeListCtrl::OnCompareItems(const wxTreeItemId& item1,
 void wxTreeListCtrl::SortChildren(const wxTreeItemId& item)
 { m_main_win->SortChildren(item); }
 
-wxTreeItemId wxTreeListCtrl::FindItem (const wxTreeItemId& item, const wxString& str, int mode)
-{ return m_main_win->FindItem (item, str, mode); }
+void wxTreeListCtrl::SortChildrenByColumn (const wxTreeItemId& item, int column,
+                                           bool reverse, bool background)
+{ m_main_win->SortChildrenByColumn (item, column, reverse, background); }
+
+void wxTreeListCtrl::ReorderChildren (const wxTreeItemId& item, const wxArrayInt& order)
+{ m_main_win->ReorderChildren (item, order); }
+
+wxTreeItemId wxTreeListCtrl::FindItem (const wxTreeItemId& item, const wxString& str, int mode,
+                                       int column)
+{ return m_main_win->FindItem (item, str, mode, column); }
+
+void wxTreeListCtrl::SetFindIndex (int column, bool enable)
+{ m_main_win->SetFindIndex (column, enable); }
+
+bool wxTreeListCtrl::HasFindIndex (int column) const
+{ return m_main_win->HasFindIndex (column); }
+
+void wxTreeListCtrl::InvalidateItemSize (const wxTreeItemId& item, bool recursively)
+{ m_main_win->InvalidateItemSize (item, recursively); }
+
+void wxTreeListCtrl::SetVirtualChildrenCount (const wxTreeItemId& item, size_t count)
+{ m_main_win->SetVirtualChildrenCount (item, count); }
+
+size_t wxTreeListCtrl::GetVirtualChildrenCount (const wxTreeItemId& item) const
+{ return m_main_win->GetVirtualChildrenCount (item); }
 
 void wxTreeListCtrl::SetDragItem (const wxTreeItemId& item)
 { m_main_win->SetDragItem (item); }
@@ -4905,3 +6493,10 @@ wxString wxTreeListCtrl::OnGetItemText( wxTreeItemData* WXUNUSED(item), long WXU
 {
     return wxEmptyString;
 }
+
+void wxTreeListCtrl::OnGetVirtualChildren (const wxTreeItemId& WXUNUSED(parent),
+                                           size_t WXUNUSED(from), size_t WXUNUSED(count),
+                                           wxTreeItemData** WXUNUSED(data),
+                                           bool* WXUNUSED(hasChildren))
+{
+}
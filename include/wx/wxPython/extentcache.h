@@ -0,0 +1,180 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        extentcache.h
+// Purpose:     A cache of text extents by font, scale and string, used
+//              by the wx.DC.GetTextExtent cache
+//
+// RCS-ID:      $Id$
+// Copyright:   (c) wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef __extentcache_h__
+#define __extentcache_h__
+
+#include <wx/hashmap.h>
+#include <wx/dynarray.h>
+
+class wxPyTextExtent
+{
+public:
+    wxPyTextExtent(const wxString& text, const wxSize& size)
+        : m_text(text), m_size(size), m_prev(NULL), m_next(NULL) {}
+    wxString        m_text;
+    wxSize          m_size;
+    wxPyTextExtent* m_prev;     // the one used more recently
+    wxPyTextExtent* m_next;
+};
+
+WX_DECLARE_STRING_HASH_MAP(wxPyTextExtent*, wxPyTextExtentMap);
+
+// The extents measured with one font at one scale, the least recently used
+// ones are forgotten first when there are too many.  The font is kept
+// referenced so its data can't be reused by another font meanwhile.
+class wxPyFontExtents
+{
+public:
+    wxPyFontExtents(const wxFont& font, double scaleX, double scaleY)
+        : m_font(font), m_scaleX(scaleX), m_scaleY(scaleY),
+          m_first(NULL), m_last(NULL) {}
+    ~wxPyFontExtents()
+    {
+        for (wxPyTextExtentMap::iterator it = m_extents.begin(); it != m_extents.end(); ++it)
+            delete it->second;
+    }
+
+    // the extent of the text, or NULL if it isn't known
+    const wxSize* Find(const wxString& text)
+    {
+        wxPyTextExtentMap::iterator it = m_extents.find(text);
+        if (it == m_extents.end())
+            return NULL;
+        Unlink(it->second);
+        Link(it->second);
+        return &it->second->m_size;
+    }
+
+    void Store(const wxString& text, const wxSize& size, size_t maxStrings)
+    {
+        if (m_extents.size() >= maxStrings && m_last) {
+            wxPyTextExtent* old = m_last;
+            Unlink(old);
+            m_extents.erase(old->m_text);
+            delete old;
+        }
+        wxPyTextExtent* extent = new wxPyTextExtent(text, size);
+        m_extents[text] = extent;
+        Link(extent);
+    }
+
+    wxFont            m_font;
+    double            m_scaleX, m_scaleY;
+
+private:
+    void Link(wxPyTextExtent* extent)
+    {
+        extent->m_prev = NULL;
+        extent->m_next = m_first;
+        if (m_first) m_first->m_prev = extent; else m_last = extent;
+        m_first = extent;
+    }
+
+    void Unlink(wxPyTextExtent* extent)
+    {
+        if (extent->m_prev) extent->m_prev->m_next = extent->m_next; else m_first = extent->m_next;
+        if (extent->m_next) extent->m_next->m_prev = extent->m_prev; else m_last = extent->m_prev;
+    }
+
+    wxPyTextExtentMap m_extents;
+    wxPyTextExtent*   m_first;  // most recently used
+    wxPyTextExtent*   m_last;   // least recently used
+};
+
+WX_DEFINE_ARRAY_PTR(wxPyFontExtents*, wxPyFontExtentsArray);
+
+
+// Text extents by font, scale and string.  A DC measures in logical units,
+// so the same text has another extent when the DC's user or logical scale
+// is not 1, the product of both is part of the key.  The number of fonts
+// and of strings per font is bounded, the least recently used are dropped.
+class wxPyTextExtentCache
+{
+public:
+    wxPyTextExtentCache(size_t maxStrings=4096) : m_maxStrings(maxStrings) {}
+    ~wxPyTextExtentCache() { Clear(); }
+
+    void SetMaxStrings(size_t maxStrings) { m_maxStrings = maxStrings; }
+
+    // measure the text with the current font of the dc
+    void GetTextExtent(wxDC& dc, const wxString& text, wxCoord* w, wxCoord* h)
+    {
+        double userX, userY, logicalX, logicalY;
+        dc.GetUserScale(&userX, &userY);
+        dc.GetLogicalScale(&logicalX, &logicalY);
+        wxPyFontExtents* extents = GetExtents(dc.GetFont(), userX*logicalX, userY*logicalY);
+        const wxSize* size = extents->Find(text);
+        wxSize measured;
+        if (! size) {
+            dc.GetTextExtent(text, &measured.x, &measured.y);
+            extents->Store(text, measured, m_maxStrings);
+            size = &measured;
+        }
+        if (w) *w = size->x;
+        if (h) *h = size->y;
+    }
+
+    // measure the text with the given font through the window, which
+    // measures in device units
+    void GetTextExtent(wxWindow* win, const wxFont& font, const wxString& text,
+                       wxCoord* w, wxCoord* h)
+    {
+        wxPyFontExtents* extents = GetExtents(font, 1.0, 1.0);
+        const wxSize* size = extents->Find(text);
+        wxSize measured;
+        if (! size) {
+            win->GetTextExtent(text, &measured.x, &measured.y, NULL, NULL, &font);
+            extents->Store(text, measured, m_maxStrings);
+            size = &measured;
+        }
+        if (w) *w = size->x;
+        if (h) *h = size->y;
+    }
+
+    void Clear()
+    {
+        for (size_t i=0; i < m_fonts.GetCount(); i++)
+            delete m_fonts[i];
+        m_fonts.Empty();
+    }
+
+private:
+    enum { MAX_FONTS = 8 };
+
+    // the most recently used font is kept last
+    wxPyFontExtents* GetExtents(const wxFont& font, double scaleX, double scaleY)
+    {
+        size_t count = m_fonts.GetCount();
+        for (size_t i=count; i > 0; i--) {
+            wxPyFontExtents* fe = m_fonts[i-1];
+            if (fe->m_font.GetRefData() == font.GetRefData() &&
+                fe->m_scaleX == scaleX && fe->m_scaleY == scaleY) {
+                if (i < count) {
+                    m_fonts.RemoveAt(i-1);
+                    m_fonts.Add(fe);
+                }
+                return fe;
+            }
+        }
+        if (count >= MAX_FONTS) {
+            // forget the least recently used font
+            delete m_fonts[0];
+            m_fonts.RemoveAt(0);
+        }
+        m_fonts.Add(new wxPyFontExtents(font, scaleX, scaleY));
+        return m_fonts.Last();
+    }
+
+    wxPyFontExtentsArray m_fonts;
+    size_t               m_maxStrings;
+};
+
+#endif
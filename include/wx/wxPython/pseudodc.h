@@ -11,6 +11,109 @@
 #ifndef _WX_PSUEDO_DC_H_BASE_
 #define _WX_PSUEDO_DC_H_BASE_
 
+#if wxUSE_GRAPHICS_CONTEXT
+#include <wx/dcgraph.h>
+#else
+class wxGraphicsContext;
+#endif
+
+//----------------------------------------------------------------------------
+// pdcPlayback - the target of a playback that knows the pen, brush and font
+// last selected into the dc, so selecting them again can be skipped.  Given
+// the wxGraphicsContext of a wxGCDC it also collects runs of lines, and of
+// rectangles that don't overlap, drawn with the same pen and brush, and
+// draws each run with a single call to the graphics context.
+//----------------------------------------------------------------------------
+class pdcPlayback
+{
+    public:
+        pdcPlayback(wxDC *dc, wxGraphicsContext *gc=NULL);
+        ~pdcPlayback();
+
+        // The dc, for ops that draw to it themselves.  Anything pending is
+        // drawn first so the drawing order is kept.
+        wxDC *GetDC() {Flush(); return m_dc;}
+        // Read the pen, brush and font back from the dc after something
+        // else has selected them
+        void Reset();
+
+        void SetPen(const wxPen& pen);
+        void SetBrush(const wxBrush& brush);
+        void SetFont(const wxFont& font);
+        void DrawLine(wxCoord x1, wxCoord y1, wxCoord x2, wxCoord y2);
+        void DrawRectangle(wxCoord x, wxCoord y, wxCoord w, wxCoord h);
+
+        // Draw the pending lines and rectangles
+        void Flush() {if (m_lineCount) FlushLines(); if (m_rectCount) FlushRects();}
+    protected:
+        void FlushLines();
+        void FlushRects();
+
+        wxDC *m_dc;
+        wxPen m_pen;        // what is selected into m_dc
+        wxBrush m_brush;
+        wxFont m_font;
+        wxGraphicsContext *m_gc; // NULL when not drawing to a wxGCDC
+        size_t m_lineCount;
+        size_t m_rectCount;
+#if wxUSE_GRAPHICS_CONTEXT
+        wxPoint2DDouble *m_lineBegin; // pending lines
+        wxPoint2DDouble *m_lineEnd;
+        size_t m_lineSize;
+        wxGraphicsPath m_rects;   // pending rectangles
+        wxRect m_rectBounds;      // and their bounding box
+#endif
+};
+
+//----------------------------------------------------------------------------
+// pdcHitTest - the point FindObjects looks for, and the pen, brush and font
+// selected by the ops so far, so the ops can work out from their geometry
+// whether they draw anything near the point
+//----------------------------------------------------------------------------
+enum pdcHitResult
+{
+    pdcHIT_NONE,        // draws nothing near the point
+    pdcHIT_FOUND,       // draws something near the point
+    pdcHIT_UNKNOWN      // only drawing it would tell
+};
+
+class pdcHitTest
+{
+    public:
+        pdcHitTest(wxCoord x, wxCoord y, wxCoord radius, const wxColour& bg);
+        ~pdcHitTest() {delete m_dc;}
+
+        // Each object starts with the pen and brush of the background
+        // colour, as when it is drawn to find it
+        void Reset() {m_pen=m_bgpen; m_brush=m_bgbrush;}
+        void SetPen(const wxPen& pen) {m_pen=pen;}
+        void SetBrush(const wxBrush& brush) {m_brush=brush;}
+        void SetFont(const wxFont& font) {m_font=font;}
+
+        double GetX() {return m_x;}
+        double GetY() {return m_y;}
+        // How far from the point an edge of something drawn may be
+        double GetTolerance() {return m_tolerance;}
+        // How far from the point a line stroked with the pen may be.  A pen
+        // n pixels wide sets the pixels up to (n-1)/2 away from the line.
+        double GetStrokeTolerance() 
+            {return m_tolerance + (wxMax(m_pen.GetWidth(), 1) - 1)/2.0;}
+        // Whether the pen and brush draw something other than background
+        bool IsStroked();
+        bool IsFilled();
+        void GetTextExtent(const wxString& text, wxCoord *w, wxCoord *h);
+    protected:
+        double m_x, m_y;
+        double m_tolerance;
+        wxColour m_bg;
+        wxPen m_bgpen;
+        wxBrush m_bgbrush;
+        wxPen m_pen;
+        wxBrush m_brush;
+        wxFont m_font;
+        wxMemoryDC *m_dc; // for measuring text, made when first needed
+};
+
 //----------------------------------------------------------------------------
 // Base class for all pdcOp classes
 //----------------------------------------------------------------------------
@@ -23,8 +126,19 @@ class pdcOp
 
         // Virtual Drawing Methods
         virtual void DrawToDC(wxDC *dc, bool grey=false)=0;
+        virtual void Play(pdcPlayback& pb, bool grey=false) {DrawToDC(pb.GetDC(), grey);}
         virtual void Translate(wxCoord WXUNUSED(dx), wxCoord WXUNUSED(dy)) {}
         virtual void CacheGrey() {}
+        // true for the ops that select something into the dc, which must
+        // still be done when an object is drawn from its cached bitmap
+        virtual bool SetsState() {return false;}
+        // false for the ops whose result depends on what is already drawn
+        // or reaches outside the object's bounds, such as a logical
+        // function, a flood fill or a clear.  An object with any of them
+        // is always drawn op by op, even if it is set to be cached.
+        virtual bool IsCacheable() {return true;}
+        // Whether the op draws anything near the point of ht
+        virtual pdcHitResult HitTest(pdcHitTest& WXUNUSED(ht)) {return pdcHIT_UNKNOWN;}
 };
 
 //----------------------------------------------------------------------------
@@ -52,6 +166,9 @@ class pdcSetFontOp : public pdcOp
         pdcSetFontOp(const wxFont& font) 
             {m_font=font;}
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->SetFont(m_font);}
+        virtual void Play(pdcPlayback& pb, bool WXUNUSED(grey)=false) {pb.SetFont(m_font);}
+        virtual bool SetsState() {return true;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht) {ht.SetFont(m_font); return pdcHIT_NONE;}
     protected:
         wxFont m_font;
 };
@@ -66,7 +183,11 @@ class pdcSetBrushOp : public pdcOp
             if (!grey) dc->SetBrush(m_brush);
             else dc->SetBrush(m_greybrush);
         }
+        virtual void Play(pdcPlayback& pb, bool grey=false)
+            {pb.SetBrush(grey ? m_greybrush : m_brush);}
         virtual void CacheGrey() {m_greybrush=GetGreyBrush(m_brush);}
+        virtual bool SetsState() {return true;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht) {ht.SetBrush(m_brush); return pdcHIT_NONE;}
     protected:
         wxBrush m_brush;
         wxBrush m_greybrush;
@@ -83,6 +204,8 @@ class pdcSetBackgroundOp : public pdcOp
             else dc->SetBackground(m_greybrush);
         }
         virtual void CacheGrey() {m_greybrush=GetGreyBrush(m_brush);}
+        virtual bool SetsState() {return true;}
+        virtual pdcHitResult HitTest(pdcHitTest& WXUNUSED(ht)) {return pdcHIT_NONE;}
     protected:
         wxBrush m_brush;
         wxBrush m_greybrush;
@@ -98,7 +221,11 @@ class pdcSetPenOp : public pdcOp
             if (!grey) dc->SetPen(m_pen);
             else dc->SetPen(m_greypen);
         }
+        virtual void Play(pdcPlayback& pb, bool grey=false)
+            {pb.SetPen(grey ? m_greypen : m_pen);}
         virtual void CacheGrey() {m_greypen=GetGreyPen(m_pen);}
+        virtual bool SetsState() {return true;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht) {ht.SetPen(m_pen); return pdcHIT_NONE;}
     protected:
         wxPen m_pen;
         wxPen m_greypen;
@@ -114,6 +241,8 @@ class pdcSetTextBackgroundOp : public pdcOp
             if (!grey) dc->SetTextBackground(m_colour);
             else dc->SetTextBackground(MakeColourGrey(m_colour));
         }
+        virtual bool SetsState() {return true;}
+        virtual pdcHitResult HitTest(pdcHitTest& WXUNUSED(ht)) {return pdcHIT_NONE;}
     protected:
         wxColour m_colour;
 };
@@ -128,6 +257,8 @@ class pdcSetTextForegroundOp : public pdcOp
             if (!grey) dc->SetTextForeground(m_colour);
             else dc->SetTextForeground(MakeColourGrey(m_colour));
         }
+        virtual bool SetsState() {return true;}
+        virtual pdcHitResult HitTest(pdcHitTest& WXUNUSED(ht)) {return pdcHIT_NONE;}
     protected:
         wxColour m_colour;
 };
@@ -138,8 +269,10 @@ class pdcDrawRectangleOp : public pdcOp
         pdcDrawRectangleOp(wxCoord x, wxCoord y, wxCoord w, wxCoord h)
             {m_x=x; m_y=y; m_w=w; m_h=h;}
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->DrawRectangle(m_x,m_y,m_w,m_h);}
+        virtual void Play(pdcPlayback& pb, bool WXUNUSED(grey)=false) {pb.DrawRectangle(m_x,m_y,m_w,m_h);}
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x+=dx;m_y+=dy;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         wxCoord m_x,m_y,m_w,m_h;
 };
@@ -150,8 +283,10 @@ class pdcDrawLineOp : public pdcOp
         pdcDrawLineOp(wxCoord x1, wxCoord y1, wxCoord x2, wxCoord y2)
             {m_x1=x1; m_y1=y1; m_x2=x2; m_y2=y2;}
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->DrawLine(m_x1,m_y1,m_x2,m_y2);}
+        virtual void Play(pdcPlayback& pb, bool WXUNUSED(grey)=false) {pb.DrawLine(m_x1,m_y1,m_x2,m_y2);}
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x1+=dx; m_y1+=dy; m_x2+=dx; m_y2+=dy;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         wxCoord m_x1,m_y1,m_x2,m_y2;
 };
@@ -161,6 +296,8 @@ class pdcSetBackgroundModeOp : public pdcOp
     public:
         pdcSetBackgroundModeOp(int mode) {m_mode=mode;}
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->SetBackgroundMode(m_mode);}
+        virtual bool SetsState() {return true;}
+        virtual pdcHitResult HitTest(pdcHitTest& WXUNUSED(ht)) {return pdcHIT_NONE;}
     protected:
         int m_mode;
 };
@@ -173,6 +310,7 @@ class pdcDrawTextOp : public pdcOp
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->DrawText(m_text, m_x, m_y);}
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x+=dx; m_y+=dy;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         wxString m_text;
         wxCoord m_x, m_y;
@@ -183,6 +321,7 @@ class pdcClearOp : public pdcOp
     public:
         pdcClearOp() {}
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->Clear();}
+        virtual bool IsCacheable() {return false;}
 };
 
 class pdcBeginDrawingOp : public pdcOp
@@ -190,6 +329,7 @@ class pdcBeginDrawingOp : public pdcOp
     public:
         pdcBeginDrawingOp() {}
         virtual void DrawToDC(wxDC *WXUNUSED(dc), bool WXUNUSED(grey)=false) {}
+        virtual pdcHitResult HitTest(pdcHitTest& WXUNUSED(ht)) {return pdcHIT_NONE;}
 };
 
 class pdcEndDrawingOp : public pdcOp
@@ -197,6 +337,7 @@ class pdcEndDrawingOp : public pdcOp
     public:
         pdcEndDrawingOp() {}
         virtual void DrawToDC(wxDC *WXUNUSED(dc), bool WXUNUSED(grey)=false) {}
+        virtual pdcHitResult HitTest(pdcHitTest& WXUNUSED(ht)) {return pdcHIT_NONE;}
 };
 
 class pdcFloodFillOp : public pdcOp
@@ -211,6 +352,7 @@ class pdcFloodFillOp : public pdcOp
         }
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x+=dx; m_y+=dy;}
+        virtual bool IsCacheable() {return false;}
     protected:
         wxCoord m_x,m_y;
         wxColour m_col;
@@ -224,6 +366,8 @@ class pdcCrossHairOp : public pdcOp
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->CrossHair(m_x,m_y);}
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x+=dx; m_y+=dy;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
+        virtual bool IsCacheable() {return false;}
     protected:
         wxCoord m_x,m_y;
 };
@@ -280,6 +424,7 @@ class pdcDrawPointOp : public pdcOp
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->DrawPoint(m_x,m_y);}
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x+=dx; m_y+=dy;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         wxCoord m_x,m_y;
 };
@@ -294,6 +439,7 @@ class pdcDrawRoundedRectangleOp : public pdcOp
             {dc->DrawRoundedRectangle(m_x,m_y,m_w,m_h,m_r);}
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x+=dx; m_y+=dy;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         wxCoord m_x,m_y,m_w,m_h;
         double m_r;
@@ -307,6 +453,7 @@ class pdcDrawEllipseOp : public pdcOp
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->DrawEllipse(m_x,m_y,m_w,m_h);}
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x+=dx; m_y+=dy;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         wxCoord m_x,m_y,m_w,m_h;
 };
@@ -346,6 +493,7 @@ class pdcDrawLinesOp : public pdcOp
                 m_points[i].y+=dy;
             }
         }
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         int m_n;
         wxPoint *m_points;
@@ -370,6 +518,7 @@ class pdcDrawPolygonOp : public pdcOp
                 m_points[i].y+=dy;
             }
         }
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         int m_n;
         wxPoint *m_points;
@@ -395,6 +544,7 @@ class pdcDrawPolyPolygonOp : public pdcOp
                 m_points[i].y += dy;
             }
         }
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         int m_n;
         int m_totaln;
@@ -413,6 +563,7 @@ class pdcDrawRotatedTextOp : public pdcOp
             {dc->DrawRotatedText(m_text,m_x,m_y,m_angle);}
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x+=dx; m_y+=dy;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         wxString m_text;
         wxCoord m_x,m_y;
@@ -433,6 +584,7 @@ class pdcDrawBitmapOp : public pdcOp
         virtual void CacheGrey() {m_greybmp=GetGreyBitmap(m_bmp);}
         virtual void Translate(wxCoord dx, wxCoord dy) 
             {m_x+=dx; m_y+=dy;}
+        virtual pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         wxBitmap m_bmp;
         wxBitmap m_greybmp;
@@ -490,6 +642,8 @@ class pdcSetPaletteOp : public pdcOp
     public:
         pdcSetPaletteOp(const wxPalette& palette) {m_palette=palette;}
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->SetPalette(m_palette);}
+        virtual bool SetsState() {return true;}
+        virtual pdcHitResult HitTest(pdcHitTest& WXUNUSED(ht)) {return pdcHIT_NONE;}
     protected:
         wxPalette m_palette;
 };
@@ -500,10 +654,51 @@ class pdcSetLogicalFunctionOp : public pdcOp
     public:
         pdcSetLogicalFunctionOp(wxRasterOperationMode function) {m_function=function;}
         virtual void DrawToDC(wxDC *dc, bool WXUNUSED(grey)=false) {dc->SetLogicalFunction(m_function);}
+        virtual bool SetsState() {return true;}
+        virtual pdcHitResult HitTest(pdcHitTest& WXUNUSED(ht))
+            {return m_function == wxCOPY ? pdcHIT_NONE : pdcHIT_UNKNOWN;}
+        virtual bool IsCacheable() {return false;}
     protected:
         wxRasterOperationMode m_function;
 };
 
+//----------------------------------------------------------------------------
+// pdcBitmapCache - keeps the bitmaps that cached objects are drawn from,
+// within a budget in bytes.  When a new bitmap would exceed the budget the
+// least recently drawn ones are dropped.
+//----------------------------------------------------------------------------
+#define wxPDC_CACHE_BUDGET (32*1024*1024)
+
+class pdcObject;
+
+class pdcBitmapCache
+{
+    public:
+        pdcBitmapCache() 
+            {m_budget=wxPDC_CACHE_BUDGET; m_used=0; m_first=m_last=NULL;}
+
+        void   SetBudget(size_t budget) {m_budget=budget; Evict(0);}
+        size_t GetBudget() {return m_budget;}
+        size_t GetUsed() {return m_used;}
+
+        // Draw obj from its bitmap, rasterizing it first if it has none or
+        // the dc's scale or kind has changed.  Returns false if obj can't be
+        // cached and has to be drawn op by op.
+        bool Draw(pdcObject *obj, wxDC *dc);
+        // Drop the bitmap of obj
+        void Release(pdcObject *obj);
+    protected:
+        bool Rasterize(pdcObject *obj, double sx, double sy, bool gc);
+        void Evict(size_t needed);
+        void Link(pdcObject *obj);
+        void Unlink(pdcObject *obj);
+
+        size_t m_budget;
+        size_t m_used;
+        pdcObject *m_first; // most recently drawn
+        pdcObject *m_last;  // least recently drawn
+};
+
 //----------------------------------------------------------------------------
 // pdcObject type to contain list of operations for each real (Python) object
 //----------------------------------------------------------------------------
@@ -512,32 +707,57 @@ class pdcObject
     public:
         pdcObject(int id) 
             {m_id=id; m_bounded=false; m_oplist.DeleteContents(true);
-             m_greyedout=false;}
+             m_greyedout=false; m_bitmapCache=NULL; m_uncacheable=0;
+             m_cacheScaleX=m_cacheScaleY=1.0; m_cacheGC=false;
+             m_cachePrev=m_cacheNext=NULL;}
 
-        virtual ~pdcObject() {m_oplist.Clear();}
+        virtual ~pdcObject() {SetCache(NULL); m_oplist.Clear();}
         
         // Protected Member Access
         void SetId(int id) {m_id=id;}
         int  GetId() {return m_id;}
-        void   SetBounds(wxRect& rect) {m_bounds=rect; m_bounded=true;}
+        void   SetBounds(wxRect& rect) {m_bounds=rect; m_bounded=true; InvalidateCache();}
         wxRect GetBounds() {return m_bounds;}
-        void SetBounded(bool bounded) {m_bounded=bounded;}
+        void SetBounded(bool bounded) {m_bounded=bounded; InvalidateCache();}
         bool IsBounded() {return m_bounded;}
         void SetGreyedOut(bool greyout=true);
         bool GetGreyedOut() {return m_greyedout;}
     
         // Op List Management Methods
-        void Clear() {m_oplist.Clear();}
+        void Clear() {InvalidateCache(); m_oplist.Clear(); m_uncacheable=0;}
         void AddOp(pdcOp *op) 
         {
             m_oplist.Append(op);
             if (m_greyedout) op->CacheGrey();
+            if (!op->IsCacheable()) m_uncacheable++;
+            InvalidateCache();
         }
         int  GetLen() {return m_oplist.GetCount();}
         virtual void Translate(wxCoord dx, wxCoord dy);
+
+        // Bitmap Cache Methods
+        // draw from a bitmap kept in cache, or op by op if cache is NULL
+        void SetCache(pdcBitmapCache *cache)
+        {
+            if (cache == m_bitmapCache) return;
+            if (m_bitmapCache) m_bitmapCache->Release(this);
+            m_bitmapCache=cache;
+        }
+        pdcBitmapCache *GetCache() {return m_bitmapCache;}
+        bool IsCacheable() {return m_bounded && !m_uncacheable;}
+        // bytes taken by the bitmap, 0 when there is none
+        size_t GetCacheSize()
+        {
+            if (!m_cacheBitmap.IsOk()) return 0;
+            return (size_t)m_cacheBitmap.GetWidth()*m_cacheBitmap.GetHeight()*4;
+        }
+        void InvalidateCache()
+            {if (m_cacheBitmap.IsOk()) m_bitmapCache->Release(this);}
         
-        // Drawing Method
+        // Drawing Methods
         virtual void DrawToDC(wxDC *dc);
+        virtual void Play(pdcPlayback& pb);
+        pdcHitResult HitTest(pdcHitTest& ht);
     protected:
         int m_id; // id of object (associates this pdcObject
                   //               with a Python object with same id)
@@ -545,6 +765,18 @@ class pdcObject
         bool m_bounded;   // true if bounds is valid, false by default
         pdcOpList m_oplist; // list of operations for this object
         bool m_greyedout; // if true then draw this object in greys only
+        int m_uncacheable; // number of ops in m_oplist that aren't IsCacheable
+
+        pdcBitmapCache *m_bitmapCache; // NULL if not cached
+        wxBitmap m_cacheBitmap;   // m_bounds rasterized, if valid
+        double m_cacheScaleX;     // at this scale
+        double m_cacheScaleY;
+        bool m_cacheGC;           // and through a wxGCDC
+        wxArrayPtrVoid m_cacheStateOps; // the ops of m_oplist that SetsState
+        pdcObject *m_cachePrev;   // the cache's LRU list
+        pdcObject *m_cacheNext;
+
+        friend class pdcBitmapCache;
 };
 
 
@@ -573,18 +805,30 @@ WX_DECLARE_HASH_MAP(
 // and plays them back to a real dc using DrawToDC or DrawToDCClipped.
 // Drawing methods are mirrored from wxDC but add nodes to m_list 
 // instead of doing any real drawing.
+//
+// A wxPseudoDC uses no GUI resources of its own, so one can be recorded by a
+// worker thread and then handed to the GUI thread, which exchanges it with
+// the one it draws from using Swap.
 // ----------------------------------------------------------------------------
 class wxPseudoDC : public wxObject
 {
 public:
     wxPseudoDC() 
-        {m_currId=-1; m_lastObject=NULL; m_objectlist.DeleteContents(true);m_objectIndex.clear();}
+        {m_currId=-1; m_lastObject=NULL;
+         m_objectlist=new pdcObjectList; m_objectlist->DeleteContents(true);
+         m_objectIndex=new pdcObjectHash; m_bitmapCache=new pdcBitmapCache;}
     ~wxPseudoDC();
     // ------------------------------------------------------------------------
     // List managment methods
     // 
     void RemoveAll();
     int GetLen();
+    // Exchange the recorded objects and the current id with other
+    void Swap(wxPseudoDC& other);
+    // Set the most memory in bytes to use for the bitmaps of cached objects
+    void SetCacheBudget(size_t budget) {m_bitmapCache->SetBudget(budget);}
+    size_t GetCacheBudget() {return m_bitmapCache->GetBudget();}
+    size_t GetCacheUsed() {return m_bitmapCache->GetUsed();}
     
     // ------------------------------------------------------------------------
     // methods for managing operations by ID
@@ -604,9 +848,15 @@ public:
     // Grey-out an object
     void SetIdGreyedOut(int id, bool greyout=true);
     bool GetIdGreyedOut(int id);
+    // Draw an object from a bitmap of its bounds, rasterized when it is
+    // first drawn and again after it changes
+    void SetIdCached(int id, bool cached=true);
+    bool GetIdCached(int id);
+    size_t GetIdCacheSize(int id);
     // Find Objects at a point.  Returns Python list of id's
     // sorted in reverse drawing order (result[0] is top object)
-    // This version looks at drawn pixels
+    // This version looks at the geometry of the ops, or at drawn
+    // pixels for the ops whose geometry doesn't tell
     PyObject *FindObjects(wxCoord x, wxCoord y, 
                           wxCoord radius=1, const wxColor& bg=*wxWHITE);
     // This version only looks at bounding boxes
@@ -623,6 +873,13 @@ public:
         void DrawToDCClippedRgn(wxDC *dc, const wxRegion& region);
     // draw to dc with no clipping (well the dc will still clip)
     void DrawToDC(wxDC *dc);
+#if wxUSE_GRAPHICS_CONTEXT
+    // draw to a wxGCDC, skipping pens, brushes and fonts that are already
+    // selected and drawing runs of lines and rectangles directly with its
+    // graphics context
+    void DrawToGCDC(wxGCDC *dc);
+    void DrawToGCDCClipped(wxGCDC *dc, const wxRect& rect);
+#endif
     // draw a single object to the dc
     void DrawIdToDC(int id, wxDC *dc);
 
@@ -635,6 +892,15 @@ public:
     // returns list of objects whose bounding boxes include (x,y)
     // PyObject *HitTestBB(wxCoord x, wxCoord y)
     
+    // ------------------------------------------------------------------------
+    // Bulk recording methods.  coords holds n consecutive (x,y) pairs for
+    // points, or (x1,y1,x2,y2) or (x,y,w,h) quads for the others, all
+    // recorded with the current id.
+    //
+    void DrawPointArray(int n, const int* coords);
+    void DrawLineArray(int n, const int* coords);
+    void DrawRectangleArray(int n, const int* coords);
+    void DrawEllipseArray(int n, const int* coords);
         
     // ------------------------------------------------------------------------
     // Methods mirrored from wxDC
@@ -813,14 +1079,16 @@ protected:
     // protected helper methods
     void AddToList(pdcOp *newOp);
     pdcObject *FindObject(int id, bool create=false);
+    void DrawObject(pdcObject *obj, wxDC *dc);
     
     // ------------------------------------------------------------------------
     // Data members
     // 
     int m_currId; // id to use for operations done on the PseudoDC
     pdcObject *m_lastObject; // used to find last used object quickly
-    pdcObjectList m_objectlist; // list of objects
-    pdcObjectHash m_objectIndex; //id->object lookup index
+    pdcObjectList *m_objectlist; // list of objects
+    pdcObjectHash *m_objectIndex; //id->object lookup index
+    pdcBitmapCache *m_bitmapCache; // bitmaps of the cached objects
     
 };
 
@@ -104,6 +104,7 @@
 #include <wx/notifmsg.h>
 #include <wx/commandlinkbutton.h>
 #include <wx/versioninfo.h>
+#include <wx/hashset.h>
 
 #ifdef _MSC_VER
 # pragma warning(disable:4800)
@@ -145,6 +146,15 @@ typedef wxRect2DDouble  wxRect2D;
 #endif
 
 
+// The binding layer can count the calls it makes into Python, the time they
+// take and how often it has to acquire the GIL, see wx.GetBindingStats.  The
+// counters cost a flag test when they are not enabled at runtime; define
+// wxPyUSE_BINDING_STATS as 0 to compile them out altogether.
+#ifndef wxPyUSE_BINDING_STATS
+#define wxPyUSE_BINDING_STATS 1
+#endif
+
+
 #ifndef wxPyUSE_EXPORTED_API
 
 void      __wxPyPreStart(PyObject*);
@@ -154,6 +164,15 @@ PyObject* __wxPySetDictionary(PyObject*, PyObject* args);
 void        wxSetDefaultPyEncoding(const char* encoding);
 const char* wxGetDefaultPyEncoding();
 
+PyObject*   wxGetBindingStats();
+void        wxResetBindingStats();
+void        wxEnableBindingStats(bool enable=true);
+
+#if wxPyUSE_BINDING_STATS
+extern bool wxPyBindingStatsEnabled;
+void        wxPyBindingStatsAddProxy(const wxString& className);
+#endif
+
 
 void wxPyEventThunker(wxObject*, wxEvent& event);
 
@@ -688,6 +707,7 @@ public:
         m_class = NULL;
         m_self = NULL;
         m_lastFound = NULL;
+        m_lastName = NULL;
         m_incRef = false;
     }
 
@@ -712,6 +732,7 @@ private:
     PyObject*   m_self;
     PyObject*   m_class;
     PyObject*   m_lastFound;
+    const char* m_lastName;     // given to findCallback, for the stats
     int         m_incRef;
 
     friend      void wxPyCBH_delete(wxPyCallbackHelper* cbh);
@@ -749,6 +770,11 @@ enum {
     wxPYAPP_ASSERT_LOG       = 8
 };
 
+class wxPyTimerWheel;
+struct wxPyIdleTask;
+
+WX_DECLARE_HASH_SET(int, wxIntegerHash, wxIntegerEqual, wxPyEventTypeSet);
+
 class wxPyApp: public wxApp
 {
     DECLARE_ABSTRACT_CLASS(wxPyApp)
@@ -765,6 +791,11 @@ public:
     bool GetCallFilterEvent() { return m_callFilterEvent; }
     void SetCallFilterEvent(bool callFilterEvent=true) { m_callFilterEvent = callFilterEvent; }
 
+    // Limit the events passed to the Python FilterEvent to these types, or
+    // pass all of them if the array is empty.
+    void SetFilterEventTypes(const wxArrayInt& types);
+    wxArrayInt GetFilterEventTypes();
+
     virtual bool OnInitGui();
     virtual int OnExit();
     virtual void OnEventLoopEnter(wxEventLoopBase* loop);
@@ -803,6 +834,31 @@ public:
 
     void _BootstrapApp();
 
+    // The queue behind wx.CallAfter.  Calls may be queued from any thread
+    // holding the GIL, and are all run by one event on the GUI thread.  A
+    // call with a key other than None replaces a queued call with the same
+    // key.
+    void _CallAfter(PyObject* callable, PyObject* args, PyObject* kw, PyObject* key);
+    PyObject* GetCallAfterStats();
+    void ResetCallAfterStats();
+
+    // The timers behind wx.CallLater, all run by a single wxTimer.  The
+    // ids returned by _CallLater are never reused, and the callable is
+    // called with its id.
+    long _CallLater(PyObject* callable, int millis, bool periodic);
+    bool _RestartCallLater(long id, int millis);
+    bool _CancelCallLater(long id);
+    bool _IsCallLaterPending(long id);
+
+    // Work run by the app's idle handler, a little at a time.  A task is an
+    // iterator, advanced until it is exhausted, or a callable, called until
+    // it returns a false value.  Only for the GUI thread.
+    long AddIdleTask(PyObject* task, int priority=0, int budget=0);
+    bool RemoveIdleTask(long id);
+    int GetIdleTaskCount();
+    void SetIdleSlice(int millis) { m_idleSlice = millis; }
+    int GetIdleSlice() { return m_idleSlice; }
+
     // implementation only
     void SetStartupComplete(bool val) { m_startupComplete = val; };
 
@@ -810,6 +866,31 @@ public:
     int m_assertMode;
     bool m_startupComplete;
     bool m_callFilterEvent;
+    wxPyEventTypeSet m_filterEventTypes;
+
+protected:
+    void OnCallAfter(wxEvent& event);
+    void OnIdleTasks(wxIdleEvent& event);
+    void PurgeIdleTasks();
+
+    PyObject*   m_callAfterQueue;       // list of [callable, args, kw, time]
+    PyObject*   m_callAfterKeys;        // key -> entry of m_callAfterQueue
+    bool        m_callAfterPosted;
+    PyObject*   m_callAfterBatch;       // the batch being run, or NULL
+    Py_ssize_t  m_callAfterNext;        // and the index of its next entry
+    long        m_callAfterDelivered;
+    long        m_callAfterCoalesced;
+    long        m_callAfterBatches;
+    long        m_callAfterMaxDepth;
+    double      m_callAfterLastLatency;
+    double      m_callAfterMaxLatency;
+
+    wxPyTimerWheel* m_timerWheel;
+
+    wxArrayPtrVoid  m_idleTasks;        // wxPyIdleTask*, highest priority first
+    int             m_idleSlice;        // milliseconds per idle event
+    long            m_lastIdleTaskId;
+    bool            m_runningIdleTasks;
 };
 
 extern wxPyApp *wxPythonApp;
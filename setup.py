@@ -633,6 +633,8 @@ wxpExtensions.append(ext)
 if BUILD_STC:
     msg('Preparing STC...')
     STC_H = opj(WXDIR, 'include/wx/stc')
+    # for the Scintilla messages and structs used directly in stc.i
+    SCINTILLA_H = opj(WXDIR, 'src/stc/scintilla/include')
 
     swig_sources = run_swig(['stc.i'], 'src', GENDIR, PKGDIR,
                             USE_SWIG, swig_force, swig_args + ['-I'+STC_H],
@@ -648,7 +650,7 @@ if BUILD_STC:
 
     ext = Extension('_stc',
                     swig_sources,
-                    include_dirs = includes + CONTRIBS_INC,
+                    include_dirs = includes + CONTRIBS_INC + [SCINTILLA_H],
                     define_macros = defines,
                     library_dirs = libdirs,
                     libraries = stcLibs,
@@ -272,6 +272,17 @@ performance penalty when you have overriden FilterEvent, but don't
 want it to be called, and also to reduce the runtime overhead when it
 is not overridden.", "");
 
+    DocDeclStr(
+        void , SetFilterEventTypes(const wxArrayInt& types),
+        "Limits the events passed to your override of FilterEvent to those of
+the given event types, such as ``[wx.wxEVT_KEY_DOWN, wx.wxEVT_CHAR]``.
+The types are checked before calling into Python, so events of other
+types cost nothing.  An empty list passes all events again.", "");
+
+    DocDeclStr(
+        wxArrayInt , GetFilterEventTypes(),
+        "Returns the event types set with `SetFilterEventTypes`.", "");
+
     DocDeclStr(
         virtual bool, Pending(),
         "Returns True if there are unprocessed events in the event queue.", "");
@@ -426,6 +437,71 @@ Hide command.  Mac only.", "");
         void, _BootstrapApp(),
         "For internal use only", "");
 
+    DocDeclStr(
+        void, _CallAfter(PyObject* callable, PyObject* args, PyObject* kw, PyObject* key),
+        "For internal use only, see `wx.CallAfter`", "");
+
+    DocDeclStr(
+        PyObject* , GetCallAfterStats(),
+        "Returns a dictionary describing the queue of `wx.CallAfter` calls:
+its current and largest depth, the number of calls delivered, replaced
+by a later call with the same key and the number of batches they were
+run in, and the latency in milliseconds between queueing and running
+the last call and the slowest one.", "");
+
+    DocDeclStr(
+        void , ResetCallAfterStats(),
+        "Resets the counters returned by `GetCallAfterStats`.", "");
+
+    DocDeclStr(
+        long , _CallLater(PyObject* callable, int millis, bool periodic),
+        "For internal use only, see `wx.CallLater`", "");
+    DocDeclStr(
+        bool , _RestartCallLater(long id, int millis),
+        "For internal use only, see `wx.CallLater`", "");
+    DocDeclStr(
+        bool , _CancelCallLater(long id),
+        "For internal use only, see `wx.CallLater`", "");
+    DocDeclStr(
+        bool , _IsCallLaterPending(long id),
+        "For internal use only, see `wx.CallLater`", "");
+
+
+    DocDeclStr(
+        long , AddIdleTask(PyObject* task, int priority=0, int budget=0),
+        "Adds work to be done when the application is idle and returns an id
+for `RemoveIdleTask`.  The task is either an iterator, such as a
+generator, which is advanced until it is exhausted, or a callable,
+which is called until it returns a false value.  Each idle event runs
+the pending tasks, highest priority first and taking turns within a
+priority, for up to `GetIdleSlice` milliseconds, with one task
+running for at most budget milliseconds if budget is not 0.  More
+idle events are requested only while some tasks are pending, so there
+is no need for an EVT_IDLE handler calling RequestMore.
+
+The idle tasks must only be added and removed from the GUI thread, use
+`wx.CallAfter` to add one from another thread.", "");
+
+    DocDeclStr(
+        bool , RemoveIdleTask(long id),
+        "Removes a task added with `AddIdleTask` that has not finished yet.
+Only for the GUI thread.", "");
+
+    DocDeclStr(
+        int , GetIdleTaskCount(),
+        "Returns the number of tasks added with `AddIdleTask` that have not
+finished yet.", "");
+
+    DocDeclStr(
+        void , SetIdleSlice(int millis),
+        "Sets how long the idle tasks may run for per idle event, 20
+milliseconds by default.", "");
+
+    DocDeclStr(
+        int , GetIdleSlice(),
+        "Returns how long the idle tasks may run for per idle event, in
+milliseconds.  See `SetIdleSlice`.", "");
+
     DocStr(GetComCtl32Version,
            "Returns 400, 470, 471, etc. for comctl32.dll 4.00, 4.70, 4.71 or 0 if
 it wasn't found at all.  Raises an exception on non-Windows platforms.", "");
@@ -575,6 +651,46 @@ DocDeclAStr(
 convert a Python string or unicode object to or from a wxString.", "");
 
 
+
+DocDeclStr(
+    PyObject* , wxGetBindingStats(),
+    "Returns a dictionary of the counters kept by the binding layer while
+they are enabled with `wx.EnableBindingStats`:
+
+    ==============  ================================================
+    callbacks       {name: (lookups, calls, seconds)} for the C++
+                    virtuals that look for an override in Python,
+                    how often one was called and the time it took
+    callbackTimes   a histogram of the time of those calls
+    gil             (acquired, nested, seconds): how often the GIL
+                    was acquired to call into Python or to return
+                    to it from a wrapped method that released it,
+                    how often it was already held, and the time
+                    spent waiting
+    gilWaits        a histogram of the waits for the GIL
+    proxies         {className: count} of the Python proxy objects
+                    made for C++ objects passed to Python
+    events          {eventType: count} of the events dispatched to
+                    Python handlers
+    enabled         whether the counters are being updated
+    available       False if wxPython was built without them
+    ==============  ================================================
+
+Bucket 0 of a histogram counts times under a microsecond, bucket n
+those from 2**(n-1) up to 2**n microseconds, and the last bucket all
+the longer ones.", "");
+
+DocDeclStr(
+    void , wxResetBindingStats(),
+    "Resets the counters returned by `wx.GetBindingStats`.", "");
+
+DocDeclStr(
+    void , wxEnableBindingStats(bool enable=true),
+    "Starts or stops updating the counters returned by
+`wx.GetBindingStats`.  They are off by default, and cost a flag test
+per call into Python while they are off.", "");
+
+
 //---------------------------------------------------------------------------
 // Include some extra wxApp related python code here
 
@@ -82,6 +82,10 @@ PyObject* wxPyConstructObject(void* ptr,
     swig_type_info* swigType = wxPyFindSwigType(className);
     wxCHECK_MSG(swigType != NULL, NULL, wxT("Unknown type in wxPyConstructObject"));
 
+#if wxPyUSE_BINDING_STATS
+    if (wxPyBindingStatsEnabled)
+        wxPyBindingStatsAddProxy(className);
+#endif
     return SWIG_Python_NewPointerObj(ptr, swigType, setThisOwn);
 }
 
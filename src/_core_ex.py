@@ -152,22 +152,29 @@ def CallAfter(callableObj, *args, **kw):
     method calls from non-GUI threads.  Any extra positional or
     keyword args are passed on to the callable when it is called.
 
-    :see: `wx.CallLater`
+    The calls are kept in a queue owned by the application object, and
+    all the calls queued by the time the GUI thread gets to them are
+    run in one batch, in the order they were queued.
+
+    :see: `wx.CallAfterCoalesced`, `wx.CallLater`
     """
     assert callable(callableObj), "callableObj is not callable"
     app = wx.GetApp()
     assert app is not None, 'No wx.App created yet'
+    app._CallAfter(callableObj, args, kw, None)
 
-    if not hasattr(app, "_CallAfterId"):
-        app._CallAfterId = wx.NewEventType()
-        app.Connect(-1, -1, app._CallAfterId,
-                    lambda event: event.callable(*event.args, **event.kw) )
-    evt = wx.PyEvent()
-    evt.SetEventType(app._CallAfterId)
-    evt.callable = callableObj
-    evt.args = args
-    evt.kw = kw
-    wx.PostEvent(app, evt)
+
+def CallAfterCoalesced(key, callableObj, *args, **kw):
+    """
+    Like `wx.CallAfter`, but if a call queued with the same (hashable)
+    key has not been run yet it is replaced by this one, which keeps
+    its place in the queue.  This is useful for progress updates from
+    worker threads, where only the latest value matters.
+    """
+    assert callable(callableObj), "callableObj is not callable"
+    app = wx.GetApp()
+    assert app is not None, 'No wx.App created yet'
+    app._CallAfter(callableObj, args, kw, key)
 
 #----------------------------------------------------------------------------
 
@@ -182,10 +189,15 @@ class CallLater:
     If you don't need to get the return value or restart the timer
     then there is no need to hold a reference to this object.
 
-    :see: `wx.CallAfter`
+    All the pending calls share one native timer owned by the
+    application object, so starting, restarting and stopping them is
+    cheap even when there are many of them.
+
+    :see: `wx.CallAfter`, `wx.CallEvery`
     """
 
     __RUNNING = set()
+    _periodic = False
     
     def __init__(self, millis, callableObj, *args, **kwargs):
         assert callable(callableObj), "callableObj is not callable"
@@ -209,9 +221,10 @@ class CallLater:
             self.millis = millis
         if args or kwargs:
             self.SetArgs(*args, **kwargs)
-        self.Stop()
-        self.timer = wx.PyTimer(self.Notify)
-        self.timer.Start(self.millis, wx.TIMER_ONE_SHOT)
+        app = wx.GetApp()
+        assert app is not None, 'No wx.App created yet'
+        if self.timer is None or not app._RestartCallLater(self.timer, self.millis):
+            self.timer = app._CallLater(self._Notify, self.millis, self._periodic)
         self.running = True
         self.__RUNNING.add(self)
     Restart = Start
@@ -219,23 +232,27 @@ class CallLater:
 
     def Stop(self):
         """
-        Stop and destroy the timer.
+        Stop the timer.
         """
-        if self.timer is not None:
-            self.timer.Stop()
-            self.timer = None
+        app = wx.GetApp()
+        if self.timer is not None and app is not None:
+            app._CancelCallLater(self.timer)
+        self.timer = None
+        self.running = False
         self.__RUNNING.discard(self)
 
 
     def GetInterval(self):
         if self.timer is not None:
-            return self.timer.GetInterval()
+            return self.millis
         else:
             return 0
 
 
     def IsRunning(self):
-        return self.timer is not None and self.timer.IsRunning()
+        app = wx.GetApp()
+        return self.timer is not None and app is not None and \
+               app._IsCallLaterPending(self.timer)
 
 
     def SetArgs(self, *args, **kwargs):
@@ -257,23 +274,43 @@ class CallLater:
         return self.result
 
     
+    def _Notify(self, timer):
+        # The app calls this with the id of the timer that ran, which is not
+        # ours any more if it was stopped or started again meanwhile.
+        if timer != self.timer:
+            return
+        self.Notify()
+
+
     def Notify(self):
         """
         The timer has expired so call the callable.
         """
+        if not self._periodic:
+            self.running = False
         if self.callable and getattr(self.callable, 'im_self', True):
             self.runCount += 1
-            self.running = False
             self.result = self.callable(*self.args, **self.kwargs)
         self.hasRun = True
         if not self.running:
             # if it wasn't restarted, then cleanup
-            wx.CallAfter(self.Stop)
+            self.timer = None
+            self.__RUNNING.discard(self)
 
     Interval = property(GetInterval)
     Result = property(GetResult)
 
 
+class CallEvery(CallLater):
+    """
+    Like `wx.CallLater`, but calls the callable object every millis
+    milliseconds until it is stopped.  The calls are scheduled from the
+    time the previous one was due, not from when it ran, so they don't
+    drift; periods that are missed entirely are skipped.
+    """
+    _periodic = True
+
+
 class FutureCall(CallLater):
     """A compatibility alias for `CallLater`."""
 
@@ -718,11 +718,15 @@ clipped.", "
     wxFontMetrics GetFontMetrics() const;
 
 
-    DocDeclAStr(
-        void, GetTextExtent(const wxString& string, wxCoord *OUTPUT, wxCoord *OUTPUT),
+    DocAStr(GetTextExtent,
         "GetTextExtent(wxString string) -> (width, height)",
         "Get the width and height of the text using the current font. Only
-works for single line strings.", "");
+works for single line strings.  The result is taken from the text
+extent cache if it has been enabled with `wx.EnableTextExtentCache`.", "");
+    %extend {
+        void GetTextExtent(const wxString& string, wxCoord *OUTPUT, wxCoord *OUTPUT);
+        // See below for implementation
+    }
 
     DocDeclAStrName(
         void, GetTextExtent(const wxString& string,
@@ -1415,9 +1419,66 @@ static void wxDC_GetBoundingBox(wxDC* dc, int* x1, int* y1, int* x2, int* y2) {
     *x2 = dc->MaxX();
     *y2 = dc->MaxY();
 }
+
+
+// The optional text extent cache shared by all DCs, see extentcache.h
+#include "wx/wxPython/extentcache.h"
+
+static wxPyTextExtentCache wxPyTextExtents;
+static bool wxPyTextExtentCacheEnabled = false;
+
+
+void wxClearTextExtentCache()
+{
+    wxPyTextExtents.Clear();
+}
+
+
+void wxEnableTextExtentCache(bool enable, size_t maxStrings)
+{
+    wxPyTextExtentCacheEnabled = enable;
+    wxPyTextExtents.SetMaxStrings(maxStrings);
+    if (! enable)
+        wxClearTextExtentCache();
+}
+
+
+bool wxIsTextExtentCacheEnabled()
+{
+    return wxPyTextExtentCacheEnabled;
+}
+
+
+static void wxDC_GetTextExtent(wxDC* dc, const wxString& string, wxCoord* w, wxCoord* h) {
+    if (! wxPyTextExtentCacheEnabled)
+        dc->GetTextExtent(string, w, h);
+    else
+        wxPyTextExtents.GetTextExtent(*dc, string, w, h);
+}
 %}
 
 
+DocDeclStr(
+    void , wxEnableTextExtentCache(bool enable=true, size_t maxStrings=4096),
+    "Enables or disables the cache of text extents used by
+`wx.DC.GetTextExtent`.  The extents are kept for each font and string,
+up to maxStrings strings for each of the last few fonts used.  Code
+measuring the same strings over and over, such as column auto-sizing
+of report mode list controls, can opt in to avoid the expensive text
+measuring of the platform.  The user and logical scale of the DC are
+part of the key, but otherwise the cache assumes that a text has the
+same extent with a font on all DCs, which does not hold for DCs with a
+different resolution such as printer DCs.", "");
+
+DocDeclStr(
+    bool , wxIsTextExtentCacheEnabled(),
+    "Returns True if the text extent cache is enabled.", "");
+
+DocDeclStr(
+    void , wxClearTextExtentCache(),
+    "Discards all the text extents cached so far.", "");
+
+
 //---------------------------------------------------------------------------
 %newgroup
 
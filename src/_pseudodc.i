@@ -12,6 +12,20 @@
 
 %{
 #include "wx/wxPython/pseudodc.h"
+
+// Checks that a buffer passed to the DrawXXXBuffer methods holds whole
+// records of count native ints, and returns how many in n.
+static bool wxPyPseudoDC_CheckBuffer(int size, int count, int* n)
+{
+    int recordSize = count * sizeof(int);
+    if (size % recordSize != 0) {
+        wxPyErr_SetString(PyExc_ValueError,
+                          "The buffer size is not a multiple of the record size.");
+        return false;
+    }
+    *n = size / recordSize;
+    return true;
+}
 %}
 
 %newgroup;
@@ -22,7 +36,14 @@ commands issued to the PseudoDC are stored in a list.  You can then
 play these commands back to a real DC object using the DrawToDC
 method.  Commands in the command list are indexed by ID.  You can use
 this to clear the operations associated with a single ID and then
-re-draw the object associated with that ID.", "");
+re-draw the object associated with that ID.
+
+A PseudoDC does not use any GUI resources, so a worker thread can
+record one while the GUI thread draws from another, and hand it over
+to be exchanged with `Swap`.  The pens, brushes and fonts it records
+are kept by reference, and their reference counts are not thread safe,
+so the recording thread must use its own ones: not stock objects such
+as wx.BLACK_PEN, nor ones the GUI thread or another PseudoDC uses.", "");
 
 class wxPseudoDC : public wxObject
 {
@@ -52,6 +73,17 @@ current platform.", "");
     DocDeclStr(
         int, GetLen(),
         "Returns the number of operations in the recorded list.", "");
+    DocDeclStr(
+        void, Swap(wxPseudoDC& other),
+        "Exchanges the recorded objects and current id of this PseudoDC with
+those of other.  This takes the same short time however much has been
+recorded, so a display list can be double-buffered: a worker thread
+records into a second PseudoDC, and the GUI thread swaps it in (for
+example from a `wx.CallAfter`) and hands the old one back to be
+cleared with `RemoveAll` and recorded again.  Neither PseudoDC may
+be in use by another thread during the swap, and the pens, brushes
+and fonts recorded by the worker thread must not be shared with the
+GUI thread (see `wx.PseudoDC`).", "");
     DocDeclStr(
         void, SetId(int id),
         "Sets the id to be associated with subsequent operations.", "");
@@ -70,6 +102,39 @@ current platform.", "");
     DocDeclStr(
         bool, GetIdGreyedOut(int id),
         "Get whether an object is drawn greyed out or not.", "");
+    DocDeclStr(
+        void, SetIdCached(int id, bool cached=true),
+        "Set whether an object is drawn from a cached bitmap, for objects with
+many operations that rarely change.  The object's bounds, set with
+`SetIdBounds`, are rasterized with an alpha channel at the dc's scale
+the first time it is drawn, and the bitmap is drawn from then on until
+the object is changed, greyed out or translated by a fraction of a
+pixel, or the scale changes, or it is drawn to a `wx.GCDC` after a
+plain DC or the other way round.  The object must select the pen,
+brush and font it draws with itself, and draw nothing outside its
+bounds.  Objects that set a logical function, flood fill, clear or
+draw a cross hair are always drawn op by op.", "");
+    DocDeclStr(
+        bool, GetIdCached(int id),
+        "Get whether an object is drawn from a cached bitmap or not.", "");
+    DocDeclStr(
+        size_t, GetIdCacheSize(int id),
+        "Get the bytes taken by the cached bitmap of an object, 0 if it
+has none yet or its bitmap was dropped because the object changed or
+to stay within the budget.", "");
+    DocDeclStr(
+        void, SetCacheBudget(size_t budget),
+        "Sets the most memory in bytes to use for the bitmaps of cached
+objects, 32MB by default.  The bitmaps drawn least recently are
+dropped first to make room for new ones.", "");
+    DocDeclStr(
+        size_t, GetCacheBudget(),
+        "Gets the most memory in bytes to use for the bitmaps of cached
+objects.", "");
+    DocDeclStr(
+        size_t, GetCacheUsed(),
+        "Gets the memory in bytes taken by the bitmaps of cached objects
+now.", "");
     KeepGIL(FindObjects);
     DocDeclStr(
         PyObject*, FindObjects(wxCoord x, wxCoord y, 
@@ -77,7 +142,12 @@ current platform.", "");
         "Returns a list of all the id's that draw a pixel with color
 not equal to bg within radius of (x,y).
 Returns an empty list if nothing is found.  The list is in
-reverse drawing order so list[0] is the top id.","");
+reverse drawing order so list[0] is the top id.","
+Lines, rectangles, ellipses, polygons, text and unmasked bitmaps are
+tested from their geometry, taking the width of the pen into account.
+Objects that also draw arcs, splines, icons, masked bitmaps or use a
+logical function other than wx.COPY are drawn to a small bitmap to
+see which pixels they change, which is much slower.");
     KeepGIL(FindObjectsByBBox);
     DocDeclStr(
         PyObject*, FindObjectsByBBox(wxCoord x, wxCoord y),
@@ -113,6 +183,85 @@ be outside rect.", "");
     DocDeclStr(
         void, DrawToDC(wxDC *dc),
         "Draws the recorded operations to dc.", "");
+
+    %extend {
+        DocStr(DrawToGCDC,
+               "Draws the recorded operations to a `wx.GCDC`, like `DrawToDC`
+but faster: pens, brushes and fonts that are already selected are not
+selected again, and runs of lines, and of rectangles that don't
+overlap, drawn with the same pen and brush are each drawn with one
+call to the dc's `wx.GraphicsContext`.", "");
+        void DrawToGCDC(wxGCDC *dc)
+        {
+        %#if wxUSE_GRAPHICS_CONTEXT
+            self->DrawToGCDC(dc);
+        %#else
+            self->DrawToDC(dc);
+        %#endif
+        }
+
+        DocStr(DrawToGCDCClipped,
+               "Draws the recorded operations to a `wx.GCDC` like `DrawToGCDC`,
+skipping the objects known to be outside rect like `DrawToDCClipped`.", "");
+        void DrawToGCDCClipped(wxGCDC *dc, const wxRect& rect)
+        {
+        %#if wxUSE_GRAPHICS_CONTEXT
+            self->DrawToGCDCClipped(dc, rect);
+        %#else
+            self->DrawToDCClipped(dc, rect);
+        %#endif
+        }
+    }
+
+    // The buffer's memory is only valid while the GIL is held, another
+    // thread could resize an array.array meanwhile.
+    KeepGIL(DrawPointBuffer);
+    KeepGIL(DrawLineBuffer);
+    KeepGIL(DrawRectangleBuffer);
+    KeepGIL(DrawEllipseBuffer);
+    %extend {
+        DocStr(DrawPointBuffer,
+               "Records a point for each (x,y) pair of native ints in a string,
+``array.array('i')`` or other object supporting the buffer interface,
+with the current id.  Recording a large number of primitives this way
+is much faster than calling `DrawPoint` for each.", "");
+        void DrawPointBuffer(buffer data, int DATASIZE)
+        {
+            int n;
+            if (wxPyPseudoDC_CheckBuffer(DATASIZE, 2, &n))
+                self->DrawPointArray(n, (const int*)data);
+        }
+
+        DocStr(DrawLineBuffer,
+               "Records a line for each (x1,y1, x2,y2) quad of native ints in the
+buffer, see `DrawPointBuffer`.", "");
+        void DrawLineBuffer(buffer data, int DATASIZE)
+        {
+            int n;
+            if (wxPyPseudoDC_CheckBuffer(DATASIZE, 4, &n))
+                self->DrawLineArray(n, (const int*)data);
+        }
+
+        DocStr(DrawRectangleBuffer,
+               "Records a rectangle for each (x,y, w,h) quad of native ints in the
+buffer, see `DrawPointBuffer`.", "");
+        void DrawRectangleBuffer(buffer data, int DATASIZE)
+        {
+            int n;
+            if (wxPyPseudoDC_CheckBuffer(DATASIZE, 4, &n))
+                self->DrawRectangleArray(n, (const int*)data);
+        }
+
+        DocStr(DrawEllipseBuffer,
+               "Records an ellipse for each (x,y, w,h) quad of native ints in the
+buffer, see `DrawPointBuffer`.", "");
+        void DrawEllipseBuffer(buffer data, int DATASIZE)
+        {
+            int n;
+            if (wxPyPseudoDC_CheckBuffer(DATASIZE, 4, &n))
+                self->DrawEllipseArray(n, (const int*)data);
+        }
+    }
     
     //-------------------------------------------------------------------------
     // Methods Mirrored from wxDC
@@ -602,4 +751,6 @@ colour.
     
     %property(IdBounds, GetIdBounds, SetIdBounds, doc="See `GetIdBounds` and `SetIdBounds`");
     %property(Len, GetLen, doc="See `GetLen`");
+    %property(CacheBudget, GetCacheBudget, SetCacheBudget, doc="See `GetCacheBudget` and `SetCacheBudget`");
+    %property(CacheUsed, GetCacheUsed, doc="See `GetCacheUsed`");
 };
@@ -838,6 +838,40 @@ internal format, i.e. a single character selection is denoted by (n,n).", "");
         virtual wxRichTextRange , AddParagraph(const wxString& text),
         "Add a new paragraph of text to the end of the buffer", "");
 
+    %extend {
+        DocStr(AppendParagraphs,
+               "Add a paragraph for each string in the sequence and return the range
+they occupy.  Like AddParagraph they are added to the end of the object
+being edited, which is the buffer unless the focus is in a text box or
+table cell.  Unlike calling AddParagraph for each of them, the object's
+ranges are updated once and only the new paragraphs are laid out, which
+is done when the control is thawed if it is frozen.  Newlines within a
+string start further paragraphs.  This does not create an undo
+command.", "");
+        wxRichTextRange AppendParagraphs(const wxArrayString& paragraphs)
+        {
+            if (paragraphs.IsEmpty())
+                return wxRICHTEXT_NONE;
+
+            wxString text;
+            for (size_t i = 0; i < paragraphs.GetCount(); i++) {
+                if (i)
+                    text += wxT('\n');
+                text += paragraphs[i];
+            }
+            // the same container as AddParagraph adds to
+            wxRichTextParagraphLayoutBox* container = self->GetFocusObject();
+            wxRichTextRange range = container->AddParagraphs(text);
+            container->Invalidate(range);
+            if (!self->IsFrozen()) {
+                self->LayoutContent();
+                self->SetupScrollbars();
+                self->Refresh(false);
+            }
+            return range;
+        }
+    }
+
 
     DocDeclStr(
         virtual wxRichTextRange , AddImage(const wxImage& image),
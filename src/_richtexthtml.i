@@ -17,6 +17,25 @@
 
 %{
 #include <wx/richtext/richtexthtml.h>
+#include <wx/stream.h>
+
+// Saves through a buffer, so the many small writes of the base class don't
+// each reach the output stream.
+class wxPyRichTextHTMLHandler : public wxRichTextHTMLHandler
+{
+public:
+    wxPyRichTextHTMLHandler(const wxString& name, const wxString& ext, int type)
+        : wxRichTextHTMLHandler(name, ext, type) {}
+
+protected:
+    virtual bool DoSaveFile(wxRichTextBuffer *buffer, wxOutputStream& stream)
+    {
+        wxBufferedOutputStream buffered(stream, wxPY_RICHTEXT_STREAM_BUFSIZE);
+        bool success = wxRichTextHTMLHandler::DoSaveFile(buffer, buffered);
+        buffered.Sync();
+        return success && stream.IsOk();
+    }
+};
 %}
 
 //---------------------------------------------------------------------------
@@ -28,9 +47,14 @@ MAKE_CONST_WXSTRING2(HtmlExt,  wxT("html"));
 class wxRichTextHTMLHandler: public wxRichTextFileHandler
 {
 public:
-    wxRichTextHTMLHandler(const wxString& name = wxPyHtmlName,
-                          const wxString& ext = wxPyHtmlExt,
-                          int type = wxRICHTEXT_TYPE_HTML);
+    %extend {
+        wxRichTextHTMLHandler(const wxString& name = wxPyHtmlName,
+                              const wxString& ext = wxPyHtmlExt,
+                              int type = wxRICHTEXT_TYPE_HTML)
+        {
+            return new wxPyRichTextHTMLHandler(name, ext, type);
+        }
+    }
 
     DocDeclStr(
         virtual bool , CanSave() const,
@@ -17,6 +17,492 @@
 
 %{
 #include <wx/richtext/richtextxml.h>
+#include <wx/richtext/richtextstyles.h>
+#include <wx/xml/xml.h>
+#include <wx/stream.h>
+
+
+// A small pull parser for the documents written by wxRichTextXMLHandler.  It
+// reads the stream a block at a time and hands out one tag or text run at a
+// time, so the buffer can be filled paragraph by paragraph instead of
+// building a wxXmlDocument for the whole file first.
+class wxPyRichTextXMLReader
+{
+public:
+    enum Token { Error = -1, End, StartTag, EndTag, Text };
+
+    wxPyRichTextXMLReader(wxInputStream& stream)
+        : m_stream(stream), m_pos(0), m_len(0), m_isEmpty(false),
+          m_conv(&wxConvUTF8), m_ownedConv(NULL), m_decodeFailed(false)
+    {
+        m_buf = (unsigned char*)malloc(wxPY_RICHTEXT_STREAM_BUFSIZE);
+    }
+    ~wxPyRichTextXMLReader()
+    {
+        free(m_buf);
+        delete m_ownedConv;
+    }
+
+    // Read the next tag or text, skipping declarations and comments.  Bytes
+    // that are not valid in the document encoding are an Error.
+    Token Next()
+    {
+        Token token = ReadToken();
+        return m_decodeFailed ? Error : token;
+    }
+
+    // Read the children of the element whose start tag was just returned by
+    // Next, up to and including its end tag, into node.  Whitespace-only
+    // text is dropped like wxXmlDocument does.
+    bool ReadElement(wxXmlNode* node);
+
+    // Create an element node for the start tag just returned by Next.
+    wxXmlNode* CreateNode() const;
+
+    const wxString& GetName() const { return m_name; }
+    const wxString& GetText() const { return m_text; }
+    bool IsEmptyElement() const { return m_isEmpty; }
+
+private:
+    int GetByte() {
+        if (m_pos == m_len && !Fill())
+            return EOF;
+        return m_buf[m_pos++];
+    }
+    int PeekByte() {
+        if (m_pos == m_len && !Fill())
+            return EOF;
+        return m_buf[m_pos];
+    }
+    Token ReadToken();
+    bool Fill();
+    void SkipSpaces();
+    bool ReadUntil(const char* delim, wxMemoryBuffer& bytes);
+    bool ReadName(wxMemoryBuffer& bytes);
+    wxString Decode(const wxMemoryBuffer& bytes, bool expand, bool isAttr) const;
+    void SetEncoding(const wxString& declaration);
+
+    wxInputStream&  m_stream;
+    unsigned char*  m_buf;
+    size_t          m_pos;
+    size_t          m_len;
+
+    wxString        m_name;
+    wxString        m_text;
+    wxArrayString   m_attrNames;
+    wxArrayString   m_attrValues;
+    bool            m_isEmpty;
+
+    wxMBConv*       m_conv;
+    wxMBConv*       m_ownedConv;
+    mutable bool    m_decodeFailed;
+};
+
+
+bool wxPyRichTextXMLReader::Fill()
+{
+    if (m_stream.Eof())
+        return false;
+    m_stream.Read(m_buf, wxPY_RICHTEXT_STREAM_BUFSIZE);
+    m_len = m_stream.LastRead();
+    m_pos = 0;
+    return m_len != 0;
+}
+
+void wxPyRichTextXMLReader::SkipSpaces()
+{
+    int c;
+    while ((c = PeekByte()) == ' ' || c == '\t' || c == '\r' || c == '\n')
+        m_pos++;
+}
+
+// Read up to and past delim, which is not stored.
+bool wxPyRichTextXMLReader::ReadUntil(const char* delim, wxMemoryBuffer& bytes)
+{
+    size_t delimLen = strlen(delim);
+    int c;
+    while ((c = GetByte()) != EOF) {
+        bytes.AppendByte((char)c);
+        size_t len = bytes.GetDataLen();
+        if (len >= delimLen &&
+            memcmp((char*)bytes.GetData() + len - delimLen, delim, delimLen) == 0) {
+            bytes.SetDataLen(len - delimLen);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool wxPyRichTextXMLReader::ReadName(wxMemoryBuffer& bytes)
+{
+    int c;
+    while ((c = PeekByte()) != EOF && c != '>' && c != '/' && c != '=' &&
+           c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+        bytes.AppendByte((char)c);
+        m_pos++;
+    }
+    return bytes.GetDataLen() != 0;
+}
+
+// Convert from the document encoding, normalizing line ends (and, in
+// attribute values, all whitespace) and expanding character references.
+// If the bytes can't be converted, m_decodeFailed is set.
+wxString wxPyRichTextXMLReader::Decode(const wxMemoryBuffer& bytes, bool expand, bool isAttr) const
+{
+    if (bytes.GetDataLen() == 0)
+        return wxEmptyString;
+
+    size_t outLen = 0;
+    wxWCharBuffer wide(m_conv->cMB2WC((const char*)bytes.GetData(), bytes.GetDataLen(), &outLen));
+    if (!wide.data() || outLen == wxCONV_FAILED) {
+        m_decodeFailed = true;
+        return wxEmptyString;
+    }
+    wxString str(wide.data(), outLen);
+    str.Replace(wxT("\r\n"), wxT("\n"));
+    str.Replace(wxT("\r"), wxT("\n"));
+    if (isAttr) {
+        str.Replace(wxT("\n"), wxT(" "));
+        str.Replace(wxT("\t"), wxT(" "));
+    }
+    if (!expand || str.Find(wxT('&')) == wxNOT_FOUND)
+        return str;
+
+    wxString result;
+    result.reserve(str.length());
+    size_t len = str.length();
+    for (size_t i = 0; i < len; i++) {
+        wxChar ch = str[i];
+        size_t semi;
+        if (ch != wxT('&') || (semi = str.find(wxT(';'), i)) == wxString::npos) {
+            result += ch;
+            continue;
+        }
+        wxString entity = str.Mid(i + 1, semi - i - 1);
+        unsigned long code;
+        if (entity == wxT("amp"))       result += wxT('&');
+        else if (entity == wxT("lt"))   result += wxT('<');
+        else if (entity == wxT("gt"))   result += wxT('>');
+        else if (entity == wxT("quot")) result += wxT('"');
+        else if (entity == wxT("apos")) result += wxT('\'');
+        else if (entity.StartsWith(wxT("#x")) && entity.Mid(2).ToULong(&code, 16))
+            result += wxUniChar((unsigned)code);
+        else if (entity.StartsWith(wxT("#")) && entity.Mid(1).ToULong(&code, 10))
+            result += wxUniChar((unsigned)code);
+        else {
+            result += ch;
+            continue;
+        }
+        i = semi;
+    }
+    return result;
+}
+
+void wxPyRichTextXMLReader::SetEncoding(const wxString& declaration)
+{
+    int pos = declaration.Find(wxT("encoding"));
+    if (pos == wxNOT_FOUND)
+        return;
+    wxString rest = declaration.Mid(pos + 8).Trim(false);
+    if (!rest.StartsWith(wxT("=")))
+        return;
+    rest = rest.Mid(1).Trim(false);
+    if (rest.empty() || (rest[0] != wxT('"') && rest[0] != wxT('\'')))
+        return;
+    wxString encoding = rest.Mid(1).BeforeFirst(rest[0]);
+    if (encoding.empty() || encoding.CmpNoCase(wxT("UTF-8")) == 0)
+        return;
+    delete m_ownedConv;
+    m_conv = m_ownedConv = new wxCSConv(encoding);
+}
+
+wxPyRichTextXMLReader::Token wxPyRichTextXMLReader::ReadToken()
+{
+    for (;;) {
+        m_name.clear();
+        m_text.clear();
+        m_attrNames.Clear();
+        m_attrValues.Clear();
+        m_isEmpty = false;
+
+        wxMemoryBuffer bytes;
+        int c = GetByte();
+        if (c == EOF)
+            return End;
+
+        if (c != '<') {
+            bytes.AppendByte((char)c);
+            while ((c = PeekByte()) != EOF && c != '<') {
+                bytes.AppendByte((char)c);
+                m_pos++;
+            }
+            m_text = Decode(bytes, true, false);
+            return Text;
+        }
+
+        c = PeekByte();
+        if (c == '?') {
+            m_pos++;
+            if (!ReadUntil("?>", bytes))
+                return Error;
+            wxString decl = Decode(bytes, false, false);
+            if (decl.StartsWith(wxT("xml ")))
+                SetEncoding(decl);
+            continue;
+        }
+        if (c == '!') {
+            m_pos++;
+            if (!ReadUntil(">", bytes))
+                return Error;
+            size_t len = bytes.GetDataLen();
+            const char* data = (const char*)bytes.GetData();
+            if (len >= 2 && memcmp(data, "--", 2) == 0) {
+                // a comment can contain '>', so make sure it ended with "-->"
+                while (len < 4 || memcmp(data + len - 2, "--", 2) != 0) {
+                    bytes.AppendByte('>');
+                    if (!ReadUntil(">", bytes))
+                        return Error;
+                    len = bytes.GetDataLen();
+                    data = (const char*)bytes.GetData();
+                }
+                continue;
+            }
+            if (len >= 7 && memcmp(data, "[CDATA[", 7) == 0) {
+                while (len < 2 || memcmp(data + len - 2, "]]", 2) != 0) {
+                    bytes.AppendByte('>');
+                    if (!ReadUntil(">", bytes))
+                        return Error;
+                    len = bytes.GetDataLen();
+                    data = (const char*)bytes.GetData();
+                }
+                wxMemoryBuffer cdata;
+                cdata.AppendData(data + 7, len - 9);
+                m_text = Decode(cdata, false, false);
+                return Text;
+            }
+            // a DOCTYPE or other declaration
+            continue;
+        }
+        if (c == '/') {
+            m_pos++;
+            if (!ReadUntil(">", bytes))
+                return Error;
+            m_name = Decode(bytes, false, false).Trim();
+            return EndTag;
+        }
+
+        if (!ReadName(bytes))
+            return Error;
+        m_name = Decode(bytes, false, false);
+        for (;;) {
+            SkipSpaces();
+            c = GetByte();
+            if (c == '>')
+                return StartTag;
+            if (c == '/') {
+                if (GetByte() != '>')
+                    return Error;
+                m_isEmpty = true;
+                return StartTag;
+            }
+            if (c == EOF)
+                return Error;
+
+            wxMemoryBuffer attrName;
+            attrName.AppendByte((char)c);
+            ReadName(attrName);
+            SkipSpaces();
+            if (GetByte() != '=')
+                return Error;
+            SkipSpaces();
+            int quote = GetByte();
+            if (quote != '"' && quote != '\'')
+                return Error;
+            wxMemoryBuffer value;
+            char delim[2] = { (char)quote, 0 };
+            if (!ReadUntil(delim, value))
+                return Error;
+            m_attrNames.Add(Decode(attrName, false, false));
+            m_attrValues.Add(Decode(value, true, true));
+        }
+    }
+}
+
+wxXmlNode* wxPyRichTextXMLReader::CreateNode() const
+{
+    wxXmlNode* node = new wxXmlNode(wxXML_ELEMENT_NODE, m_name);
+    for (size_t i = 0; i < m_attrNames.GetCount(); i++)
+        node->AddAttribute(m_attrNames[i], m_attrValues[i]);
+    return node;
+}
+
+bool wxPyRichTextXMLReader::ReadElement(wxXmlNode* node)
+{
+    wxXmlNode* last = NULL;
+    for (;;) {
+        wxXmlNode* child;
+        switch (Next()) {
+            case StartTag:
+                child = CreateNode();
+                if (!m_isEmpty && !ReadElement(child)) {
+                    delete child;
+                    return false;
+                }
+                break;
+
+            case Text:
+                if (m_text.find_first_not_of(wxT(" \t\r\n")) == wxString::npos)
+                    continue;
+                child = new wxXmlNode(wxXML_TEXT_NODE, wxEmptyString, m_text);
+                break;
+
+            case EndTag:
+                return true;
+
+            default:
+                return false;
+        }
+        if (last)
+            node->InsertChildAfter(child, last);
+        else
+            node->AddChild(child);
+        last = child;
+    }
+}
+
+
+// Loads without building a document for the whole file: only the element
+// of one child of the buffer (usually a paragraph) exists at a time, and it
+// is imported and freed before the next one is read.  Saving goes through a
+// buffer, so the many small writes of the base class don't each reach the
+// output stream.
+class wxPyRichTextXMLHandler : public wxRichTextXMLHandler
+{
+public:
+    wxPyRichTextXMLHandler(const wxString& name, const wxString& ext, int type)
+        : wxRichTextXMLHandler(name, ext, type) {}
+
+protected:
+    virtual bool DoLoadFile(wxRichTextBuffer *buffer, wxInputStream& stream);
+    virtual bool DoSaveFile(wxRichTextBuffer *buffer, wxOutputStream& stream);
+
+    bool LoadParagraphLayout(wxRichTextBuffer *buffer, wxPyRichTextXMLReader& reader);
+};
+
+
+bool wxPyRichTextXMLHandler::DoLoadFile(wxRichTextBuffer *buffer, wxInputStream& stream)
+{
+    if (!stream.IsOk())
+        return false;
+
+    buffer->ResetAndClearCommands();
+    buffer->Clear();
+
+    wxPyRichTextXMLReader reader(stream);
+    wxPyRichTextXMLReader::Token token;
+    while ((token = reader.Next()) == wxPyRichTextXMLReader::Text)
+        ;
+
+    bool success = token == wxPyRichTextXMLReader::StartTag &&
+                   reader.GetName() == wxT("richtext");
+    while (success && !reader.IsEmptyElement()) {
+        token = reader.Next();
+        if (token == wxPyRichTextXMLReader::EndTag)
+            break;
+        if (token == wxPyRichTextXMLReader::Text)
+            continue;
+        if (token != wxPyRichTextXMLReader::StartTag) {
+            success = false;
+            break;
+        }
+
+        if (reader.GetName() == wxT("paragraphlayout")) {
+            success = LoadParagraphLayout(buffer, reader);
+            continue;
+        }
+
+        wxXmlNode* node = reader.CreateNode();
+        success = reader.IsEmptyElement() || reader.ReadElement(node);
+        if (success && node->GetName() != wxT("richtext-version"))
+            ImportXML(buffer, buffer, node);
+        delete node;
+    }
+
+    if (!success)
+        buffer->ResetAndClearCommands();
+    buffer->UpdateRanges();
+    return success;
+}
+
+// Does what ImportXML(buffer, buffer, node) does for the paragraphlayout
+// element, reading its children one at a time.  The properties and style
+// sheet elements that the buffer itself imports are written before the
+// content, and are kept until the first content child is seen.
+bool wxPyRichTextXMLHandler::LoadParagraphLayout(wxRichTextBuffer *buffer,
+                                                 wxPyRichTextXMLReader& reader)
+{
+    wxXmlNode* layout = reader.CreateNode();
+    bool isEmpty = reader.IsEmptyElement();
+    bool recurse = false;
+    bool imported = false;
+    bool success = true;
+    wxXmlNode* last = NULL;
+
+    while (success && !isEmpty) {
+        wxPyRichTextXMLReader::Token token = reader.Next();
+        if (token == wxPyRichTextXMLReader::EndTag)
+            break;
+        if (token == wxPyRichTextXMLReader::Text)
+            continue;
+        if (token != wxPyRichTextXMLReader::StartTag) {
+            success = false;
+            break;
+        }
+
+        wxXmlNode* child = reader.CreateNode();
+        if (!reader.IsEmptyElement() && !reader.ReadElement(child)) {
+            delete child;
+            success = false;
+            break;
+        }
+
+        wxString name = child->GetName();
+        if (!imported && (name == wxT("properties") || name == wxT("stylesheet"))) {
+            if (last)
+                layout->InsertChildAfter(child, last);
+            else
+                layout->AddChild(child);
+            last = child;
+            continue;
+        }
+
+        if (!imported) {
+            buffer->ImportFromXML(buffer, layout, this, &recurse);
+            imported = true;
+        }
+        if (recurse && name != wxT("stylesheet")) {
+            wxRichTextObject* childObj = CreateObjectForXMLName(buffer, name);
+            if (childObj) {
+                buffer->AppendChild(childObj);
+                ImportXML(buffer, childObj, child);
+            }
+        }
+        delete child;
+    }
+
+    if (success && !imported)
+        buffer->ImportFromXML(buffer, layout, this, &recurse);
+    delete layout;
+    return success;
+}
+
+bool wxPyRichTextXMLHandler::DoSaveFile(wxRichTextBuffer *buffer, wxOutputStream& stream)
+{
+    wxBufferedOutputStream buffered(stream, wxPY_RICHTEXT_STREAM_BUFSIZE);
+    bool success = wxRichTextXMLHandler::DoSaveFile(buffer, buffered);
+    buffered.Sync();
+    return success && stream.IsOk();
+}
 %}
 
 //---------------------------------------------------------------------------
@@ -26,12 +512,26 @@ MAKE_CONST_WXSTRING2(XmlName, wxT("XML"));
 MAKE_CONST_WXSTRING2(XmlExt,  wxT("xml"));
 
 
+DocStr(wxRichTextXMLHandler,
+"Loads and saves the XML format of `RichTextBuffer`.  Loading reads the
+stream incrementally, importing the buffer's paragraphs as they are
+read instead of parsing the whole document first, and fails if the
+document has bytes that are not valid in its encoding.  Saving goes
+through a buffer, so the stream gets large writes; the output is only
+written as the buffer is exported if wxWidgets was built with
+wxRICHTEXT_HAVE_DIRECT_OUTPUT, otherwise it is built in memory first.", "");
+
 class wxRichTextXMLHandler: public wxRichTextFileHandler
 {
 public:
-    wxRichTextXMLHandler(const wxString& name = wxPyXmlName,
-                         const wxString& ext = wxPyXmlExt,
-                         int type = wxRICHTEXT_TYPE_XML);
+    %extend {
+        wxRichTextXMLHandler(const wxString& name = wxPyXmlName,
+                             const wxString& ext = wxPyXmlExt,
+                             int type = wxRICHTEXT_TYPE_XML)
+        {
+            return new wxPyRichTextXMLHandler(name, ext, type);
+        }
+    }
 
 // #if wxUSE_STREAMS
 //     /// Recursively export an object
@@ -442,18 +442,163 @@ public:
 //---------------------------------------------------------------------------
 
 %{
+// The answers of the Python art providers to GetMetric, GetColour and
+// GetFont, which wxAuiManager asks for over and over while laying out and
+// painting the panes.
+WX_DECLARE_HASH_MAP(int, int, wxIntegerHash, wxIntegerEqual, wxPyAuiMetricCache);
+WX_DECLARE_HASH_MAP(int, wxColour, wxIntegerHash, wxIntegerEqual, wxPyAuiColourCache);
+WX_DECLARE_HASH_MAP(int, wxFont, wxIntegerHash, wxIntegerEqual, wxPyAuiFontCache);
+
+// Call the Python override name(id) through the callback helper, so it is
+// counted by wx.GetBindingStats like the other overrides, and convert the
+// result to a T of the given class.  found is set to whether there is an
+// override.  Returns false if calling it or converting the result failed,
+// in which case the Python error has been cleared.
+template <class T>
+static bool wxPyAuiCallGetter(const wxPyCallbackHelper& cbh, const char* name,
+                              const wxString& className, int id, bool& found, T& rv)
+{
+    bool ok = true;
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    if ((found = wxPyCBH_findCallback(cbh, name))) {
+        PyObject* ro;
+        T* ptr;
+        ro = wxPyCBH_callCallbackObj(cbh, Py_BuildValue("(i)", id));
+        ok = false;
+        if (ro) {
+            if (wxPyConvertSwigPtr(ro, (void **)&ptr, className)) {
+                rv = *ptr;
+                ok = true;
+            }
+            PyErr_Clear();
+            Py_DECREF(ro);
+        }
+    }
+    wxPyEndBlockThreads(blocked);
+    return ok;
+}
+
+
 // A wxDocArt class that knows how to forward virtuals to Python methods
 class wxPyAuiDockArt :  public wxAuiDefaultDockArt
 {
 public:
     wxPyAuiDockArt() : wxAuiDefaultDockArt() {}
 
-    DEC_PYCALLBACK_INT_INT(GetMetric);
-    DEC_PYCALLBACK_VOID_INTINT(SetMetric);
-    DEC_PYCALLBACK__INTFONT(SetFont);
-    DEC_PYCALLBACK_FONT_INT(GetFont);
-    DEC_PYCALLBACK_COLOUR_INT(GetColour);
-    DEC_PYCALLBACK__INTCOLOUR(SetColour);
+    // The metrics, colours and fonts are only asked from Python the first
+    // time, after that they come from the cache until one of the setters
+    // or InvalidateCache is called.
+    virtual int GetMetric(int id)
+    {
+        wxPyAuiMetricCache::iterator it = m_metrics.find(id);
+        if (it != m_metrics.end())
+            return it->second;
+
+        int rval=-1;
+        bool found;
+        bool ok = true;
+        wxPyBlock_t blocked = wxPyBeginBlockThreads();
+        if ((found = wxPyCBH_findCallback(m_myInst, "GetMetric"))) {
+            PyObject* ro;
+            ro = wxPyCBH_callCallbackObj(m_myInst, Py_BuildValue("(i)", id));
+            ok = false;
+            if (ro) {
+                rval = PyInt_AsLong(ro);
+                ok = !PyErr_Occurred();
+                PyErr_Clear();
+                Py_DECREF(ro);
+            }
+        }
+        wxPyEndBlockThreads(blocked);
+        if (! found)
+            rval = wxAuiDefaultDockArt::GetMetric(id);
+        if (ok)
+            m_metrics[id] = rval;
+        return rval;
+    }
+
+    virtual wxColour GetColour(int id)
+    {
+        wxPyAuiColourCache::iterator it = m_colours.find(id);
+        if (it != m_colours.end())
+            return it->second;
+
+        wxColour rv;
+        bool found;
+        bool ok = wxPyAuiCallGetter(m_myInst, "GetColour", wxT("wxColour"), id, found, rv);
+        if (! found)
+            rv = wxAuiDefaultDockArt::GetColour(id);
+        if (ok)
+            m_colours[id] = rv;
+        return rv;
+    }
+
+    virtual wxFont GetFont(int id)
+    {
+        wxPyAuiFontCache::iterator it = m_fonts.find(id);
+        if (it != m_fonts.end())
+            return it->second;
+
+        wxFont rv;
+        bool found;
+        bool ok = wxPyAuiCallGetter(m_myInst, "GetFont", wxT("wxFont"), id, found, rv);
+        if (! found)
+            rv = wxAuiDefaultDockArt::GetFont(id);
+        if (ok)
+            m_fonts[id] = rv;
+        return rv;
+    }
+
+    // Setting any value may change what the getters return for the others
+    // too, so the whole cache is dropped.
+    virtual void SetMetric(int id, int new_val)
+    {
+        InvalidateCache();
+        bool found;
+        wxPyBlock_t blocked = wxPyBeginBlockThreads();
+        if ((found = wxPyCBH_findCallback(m_myInst, "SetMetric")))
+            wxPyCBH_callCallback(m_myInst, Py_BuildValue("(ii)", id, new_val));
+        wxPyEndBlockThreads(blocked);
+        if (! found)
+            wxAuiDefaultDockArt::SetMetric(id, new_val);
+    }
+
+    virtual void SetColour(int id, const wxColour& colour)
+    {
+        InvalidateCache();
+        bool found;
+        wxPyBlock_t blocked = wxPyBeginBlockThreads();
+        if ((found = wxPyCBH_findCallback(m_myInst, "SetColour"))) {
+            PyObject* obj = wxPyConstructObject((void*)&colour, wxT("wxColour"), 0);
+            wxPyCBH_callCallbackObj(m_myInst, Py_BuildValue("(iO)", id, obj));
+            Py_DECREF(obj);
+        }
+        wxPyEndBlockThreads(blocked);
+        if (! found)
+            wxAuiDefaultDockArt::SetColour(id, colour);
+    }
+
+    virtual void SetFont(int id, const wxFont& font)
+    {
+        InvalidateCache();
+        bool found;
+        wxPyBlock_t blocked = wxPyBeginBlockThreads();
+        if ((found = wxPyCBH_findCallback(m_myInst, "SetFont"))) {
+            PyObject* obj = wxPyConstructObject((void*)&font, wxT("wxFont"), 0);
+            wxPyCBH_callCallbackObj(m_myInst, Py_BuildValue("(iO)", id, obj));
+            Py_DECREF(obj);
+        }
+        wxPyEndBlockThreads(blocked);
+        if (! found)
+            wxAuiDefaultDockArt::SetFont(id, font);
+    }
+
+    void InvalidateCache()
+    {
+        m_metrics.clear();
+        m_colours.clear();
+        m_fonts.clear();
+    }
 
     virtual void DrawSash(wxDC& dc,
                           wxWindow* window,
@@ -600,15 +745,12 @@ public:
 
     PYPRIVATE;
 
+private:
+    wxPyAuiMetricCache m_metrics;
+    wxPyAuiColourCache m_colours;
+    wxPyAuiFontCache   m_fonts;
 };
 
-IMP_PYCALLBACK_INT_INT(wxPyAuiDockArt, wxAuiDefaultDockArt, GetMetric);
-IMP_PYCALLBACK_VOID_INTINT(wxPyAuiDockArt, wxAuiDefaultDockArt, SetMetric);
-IMP_PYCALLBACK__INTFONT(wxPyAuiDockArt, wxAuiDefaultDockArt, SetFont);
-IMP_PYCALLBACK_FONT_INT(wxPyAuiDockArt, wxAuiDefaultDockArt, GetFont);
-IMP_PYCALLBACK_COLOUR_INT(wxPyAuiDockArt, wxAuiDefaultDockArt, GetColour);
-IMP_PYCALLBACK__INTCOLOUR(wxPyAuiDockArt, wxAuiDefaultDockArt, SetColour);
-
 %}
 
 
@@ -624,6 +766,14 @@ public:
     wxPyAuiDockArt();
 
     void _setCallbackInfo(PyObject* self, PyObject* _class);
+
+    DocDeclStr(
+        void , InvalidateCache(),
+        "The values returned by the GetMetric, GetColour and GetFont methods
+are remembered after they are first called, until SetMetric, SetColour
+or SetFont is called on the base class.  Call this method if they
+change in some other way, for example when those setters are
+overridden without calling the base class versions.", "");
 };
 
 
@@ -726,7 +876,7 @@ public:
 class wxPyAuiTabArt :  public wxAuiDefaultTabArt
 {
 public:
-    wxPyAuiTabArt() : wxAuiDefaultTabArt() {}
+    wxPyAuiTabArt() : wxAuiDefaultTabArt(), m_indentSize(-1) {}
 
 
     virtual void DrawBackground( wxDC& dc,
@@ -928,22 +1078,52 @@ public:
     }
 
 
+    // The indent size is only asked from Python the first time, and again
+    // after the fonts, flags or sizing info are set or InvalidateCache is
+    // called.
     virtual int GetIndentSize()
     {
+        if (m_indentSize != -1)
+            return m_indentSize;
+
         int rval=0;
         bool found;
+        bool ok = true;
         wxPyBlock_t blocked = wxPyBeginBlockThreads();
-        if ((found = wxPyCBH_findCallback(m_myInst, "GetIndentSize")))
-            rval = wxPyCBH_callCallback(m_myInst, Py_BuildValue("()"));
+        if ((found = wxPyCBH_findCallback(m_myInst, "GetIndentSize"))) {
+            PyObject* ro;
+            ro = wxPyCBH_callCallbackObj(m_myInst, Py_BuildValue("()"));
+            ok = false;
+            if (ro) {
+                rval = PyInt_AsLong(ro);
+                ok = !PyErr_Occurred();
+                PyErr_Clear();
+                Py_DECREF(ro);
+            }
+        }
         wxPyEndBlockThreads(blocked);
         if (! found)
             rval = wxAuiDefaultTabArt::GetIndentSize();
+        if (ok)
+            m_indentSize = rval;
         return rval;
     }
 
+    virtual void SetFlags(unsigned int flags)
+    {
+        InvalidateCache();
+        wxAuiDefaultTabArt::SetFlags(flags);
+    }
+
+    void InvalidateCache()
+    {
+        m_indentSize = -1;
+    }
+
     virtual void SetSizingInfo(const wxSize& tab_ctrl_size,
                                size_t tab_count)
     {
+        InvalidateCache();
         bool found;
         wxPyBlock_t blocked = wxPyBeginBlockThreads();
         if ((found = wxPyCBH_findCallback(m_myInst, "SetSizingInfo"))) {
@@ -979,17 +1159,56 @@ public:
     int GetFlags() const { return (int)m_flags; }
 
 
-    DEC_PYCALLBACK__FONT(SetNormalFont);
-    DEC_PYCALLBACK__FONT(SetSelectedFont);
-    DEC_PYCALLBACK__FONT(SetMeasuringFont);
+    virtual void SetNormalFont(const wxFont& font)
+    {
+        InvalidateCache();
+        bool found;
+        wxPyBlock_t blocked = wxPyBeginBlockThreads();
+        if ((found = wxPyCBH_findCallback(m_myInst, "SetNormalFont"))) {
+            PyObject* obj = wxPyConstructObject((void*)&font, wxT("wxFont"), 0);
+            wxPyCBH_callCallback(m_myInst, Py_BuildValue("(O)", obj));
+            Py_DECREF(obj);
+        }
+        wxPyEndBlockThreads(blocked);
+        if (! found)
+            wxAuiDefaultTabArt::SetNormalFont(font);
+    }
 
-    PYPRIVATE;
-};
+    virtual void SetSelectedFont(const wxFont& font)
+    {
+        InvalidateCache();
+        bool found;
+        wxPyBlock_t blocked = wxPyBeginBlockThreads();
+        if ((found = wxPyCBH_findCallback(m_myInst, "SetSelectedFont"))) {
+            PyObject* obj = wxPyConstructObject((void*)&font, wxT("wxFont"), 0);
+            wxPyCBH_callCallback(m_myInst, Py_BuildValue("(O)", obj));
+            Py_DECREF(obj);
+        }
+        wxPyEndBlockThreads(blocked);
+        if (! found)
+            wxAuiDefaultTabArt::SetSelectedFont(font);
+    }
+
+    virtual void SetMeasuringFont(const wxFont& font)
+    {
+        InvalidateCache();
+        bool found;
+        wxPyBlock_t blocked = wxPyBeginBlockThreads();
+        if ((found = wxPyCBH_findCallback(m_myInst, "SetMeasuringFont"))) {
+            PyObject* obj = wxPyConstructObject((void*)&font, wxT("wxFont"), 0);
+            wxPyCBH_callCallback(m_myInst, Py_BuildValue("(O)", obj));
+            Py_DECREF(obj);
+        }
+        wxPyEndBlockThreads(blocked);
+        if (! found)
+            wxAuiDefaultTabArt::SetMeasuringFont(font);
+    }
 
+    PYPRIVATE;
 
-IMP_PYCALLBACK__FONT(wxPyAuiTabArt, wxAuiDefaultTabArt, SetNormalFont);
-IMP_PYCALLBACK__FONT(wxPyAuiTabArt, wxAuiDefaultTabArt, SetSelectedFont);
-IMP_PYCALLBACK__FONT(wxPyAuiTabArt, wxAuiDefaultTabArt, SetMeasuringFont);
+private:
+    int m_indentSize;
+};
 %}
 
 
@@ -1011,6 +1230,12 @@ public:
     wxFont GetMeasuringFont() const;
 
     int GetFlags() const;
+
+    DocDeclStr(
+        void , InvalidateCache(),
+        "The value returned by the GetIndentSize method is remembered after it
+is first called, until the fonts, flags or sizing info are set on the
+base class.  Call this method if it changes in some other way.", "");
 };
 
 
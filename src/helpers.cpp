@@ -47,6 +47,9 @@
 
 #ifdef __WXMAC__
 #include <wx/osx/private.h>
+#include <mach/mach_time.h>
+#elif !defined(__WXMSW__)
+#include <time.h>
 #endif
 
 #include <wx/clipbrd.h>
@@ -180,17 +183,374 @@ BOOL WINAPI DllMain(
 // Classes for implementing the wxp main application shell.
 //----------------------------------------------------------------------
 
+//----------------------------------------------------------------------
+// wxPyTimerWheel runs all the wx.CallLater calls from one wxTimer.  The
+// pending calls are hashed by the tick they are due in into a ring of slots,
+// each a doubly linked list, so scheduling, restarting and cancelling a call
+// are O(1).  The timer is only started for the earliest pending tick.
+//----------------------------------------------------------------------
+
+#define wxPY_WHEEL_TICK     5       // milliseconds
+#define wxPY_WHEEL_SLOTS    512
+
+struct wxPyTimerEntry
+{
+    long            id;
+    PyObject*       callable;
+    wxLongLong_t    due;            // in milliseconds
+    wxLongLong_t    dueTick;
+    long            period;         // 0 if not periodic
+    wxPyTimerEntry* prev;
+    wxPyTimerEntry* next;
+    bool            inBatch;        // Notify has it in the calls it runs
+    bool            skip;           // and must not run it, it was restarted
+    bool            dead;           // or it was cancelled, and Notify deletes it
+};
+
+
+// Microseconds from some fixed time, which unlike the time of day don't
+// jump when the clock is set.
+static wxLongLong_t wxPyMonotonicMicros()
+{
+#if defined(__WXMSW__)
+    static LARGE_INTEGER freq;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER count;
+    QueryPerformanceCounter(&count);
+    // in two parts so that count * 1000000 can't overflow
+    return (count.QuadPart / freq.QuadPart) * 1000000 +
+           (count.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart;
+#elif defined(__WXMAC__)
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return (wxLongLong_t)(mach_absolute_time() * timebase.numer / timebase.denom / 1000);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (wxLongLong_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static wxLongLong_t wxPyMonotonicMillis()
+{
+    return wxPyMonotonicMicros() / 1000;
+}
+
+WX_DECLARE_HASH_MAP(long, wxPyTimerEntry*, wxIntegerHash, wxIntegerEqual, wxPyTimerEntryMap);
+
+
+class wxPyTimerWheel : public wxTimer
+{
+public:
+    wxPyTimerWheel();
+    ~wxPyTimerWheel();
+
+    long Schedule(PyObject* callable, int millis, bool periodic);
+    bool Restart(long id, int millis);
+    bool Cancel(long id);
+    bool IsPending(long id) { return m_entries.find(id) != m_entries.end(); }
+
+    virtual void Notify();
+
+private:
+    void SetDue(wxPyTimerEntry* entry, wxLongLong_t due);
+    void Link(wxPyTimerEntry* entry);
+    void Unlink(wxPyTimerEntry* entry);
+    void Arm(wxLongLong_t tick, wxLongLong_t now);
+    void ArmEarliest(wxLongLong_t now);
+
+    wxPyTimerEntry*     m_slots[wxPY_WHEEL_SLOTS];
+    wxPyTimerEntryMap   m_entries;
+    wxLongLong_t        m_tick;         // the last tick that was run
+    wxLongLong_t        m_armedTick;    // the tick the timer is started for, or -1
+    long                m_lastId;
+};
+
+
+wxPyTimerWheel::wxPyTimerWheel()
+    : m_tick(wxPyMonotonicMillis() / wxPY_WHEEL_TICK),
+      m_armedTick(-1), m_lastId(0)
+{
+    memset(m_slots, 0, sizeof(m_slots));
+}
+
+
+wxPyTimerWheel::~wxPyTimerWheel()
+{
+    Stop();
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    for (wxPyTimerEntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        Py_DECREF(it->second->callable);
+        delete it->second;
+    }
+    wxPyEndBlockThreads(blocked);
+}
+
+
+// Calls are run in the first tick starting at or after their due time, and
+// never in a tick that has already been run.
+void wxPyTimerWheel::SetDue(wxPyTimerEntry* entry, wxLongLong_t due)
+{
+    entry->due = due;
+    entry->dueTick = (due + wxPY_WHEEL_TICK - 1) / wxPY_WHEEL_TICK;
+    if (entry->dueTick <= m_tick)
+        entry->dueTick = m_tick + 1;
+}
+
+
+void wxPyTimerWheel::Link(wxPyTimerEntry* entry)
+{
+    wxPyTimerEntry** slot = &m_slots[entry->dueTick % wxPY_WHEEL_SLOTS];
+    entry->prev = NULL;
+    entry->next = *slot;
+    if (*slot)
+        (*slot)->prev = entry;
+    *slot = entry;
+}
+
+
+void wxPyTimerWheel::Unlink(wxPyTimerEntry* entry)
+{
+    wxPyTimerEntry** slot = &m_slots[entry->dueTick % wxPY_WHEEL_SLOTS];
+    if (!entry->prev && *slot != entry)
+        return;     // not linked, Notify took it out
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        *slot = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+
+void wxPyTimerWheel::Arm(wxLongLong_t tick, wxLongLong_t now)
+{
+    wxLongLong_t delay = tick * wxPY_WHEEL_TICK - now;
+    m_armedTick = tick;
+    Start(delay > 0 ? (int)delay : 1, wxTIMER_ONE_SHOT);
+}
+
+
+// Start the timer for the earliest tick with a call due in it, looking at
+// most one turn of the wheel ahead.
+void wxPyTimerWheel::ArmEarliest(wxLongLong_t now)
+{
+    if (m_entries.empty()) {
+        Stop();
+        m_armedTick = -1;
+        return;
+    }
+    for (wxLongLong_t tick = m_tick + 1; tick <= m_tick + wxPY_WHEEL_SLOTS; tick++) {
+        for (wxPyTimerEntry* entry = m_slots[tick % wxPY_WHEEL_SLOTS]; entry; entry = entry->next) {
+            if (entry->dueTick == tick) {
+                Arm(tick, now);
+                return;
+            }
+        }
+    }
+    Arm(m_tick + wxPY_WHEEL_SLOTS, now);
+}
+
+
+long wxPyTimerWheel::Schedule(PyObject* callable, int millis, bool periodic)
+{
+    wxLongLong_t now = wxPyMonotonicMillis();
+    if (m_entries.empty())
+        m_tick = wxMax(m_tick, now / wxPY_WHEEL_TICK);
+
+    wxPyTimerEntry* entry = new wxPyTimerEntry;
+    entry->id = ++m_lastId;
+    entry->callable = callable;
+    entry->period = periodic ? wxMax(millis, 1) : 0;
+    entry->prev = entry->next = NULL;
+    entry->inBatch = entry->skip = entry->dead = false;
+    SetDue(entry, now + millis);
+    Link(entry);
+    m_entries[entry->id] = entry;
+
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    Py_INCREF(callable);
+    wxPyEndBlockThreads(blocked);
+
+    if (m_armedTick < 0 || entry->dueTick < m_armedTick)
+        Arm(entry->dueTick, now);
+    return entry->id;
+}
+
+
+bool wxPyTimerWheel::Restart(long id, int millis)
+{
+    wxPyTimerEntryMap::iterator it = m_entries.find(id);
+    if (it == m_entries.end())
+        return false;
+
+    wxPyTimerEntry* entry = it->second;
+    wxLongLong_t now = wxPyMonotonicMillis();
+    Unlink(entry);
+    // if it is about to be run by Notify, it now runs when restarted for
+    entry->skip = entry->inBatch;
+    if (entry->period)
+        entry->period = wxMax(millis, 1);
+    SetDue(entry, now + millis);
+    Link(entry);
+    if (m_armedTick < 0 || entry->dueTick < m_armedTick)
+        Arm(entry->dueTick, now);
+    return true;
+}
+
+
+bool wxPyTimerWheel::Cancel(long id)
+{
+    wxPyTimerEntryMap::iterator it = m_entries.find(id);
+    if (it == m_entries.end())
+        return false;
+
+    wxPyTimerEntry* entry = it->second;
+    Unlink(entry);
+    m_entries.erase(it);
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    Py_DECREF(entry->callable);
+    wxPyEndBlockThreads(blocked);
+    // Notify may still have it, it deletes it then
+    if (entry->inBatch)
+        entry->dead = true;
+    else
+        delete entry;
+
+    if (m_entries.empty()) {
+        Stop();
+        m_armedTick = -1;
+    }
+    return true;
+}
+
+
+// Run every call due by now with one acquisition of the GIL.  Periodic calls
+// are rescheduled from their due time rather than from now, skipping the
+// periods that were missed entirely, so they don't drift.
+//
+// The calls may cancel or restart any of the others that are due.  So the
+// entries stay in the batch until they are run, and Cancel and Restart mark
+// them to be deleted or skipped instead.  The callables are called with
+// their id, so a Python wrapper can tell which of its timers ran.
+void wxPyTimerWheel::Notify()
+{
+    wxLongLong_t now = wxPyMonotonicMillis();
+    wxLongLong_t nowTick = now / wxPY_WHEEL_TICK;
+    m_armedTick = -1;
+
+    wxArrayPtrVoid due;
+    wxLongLong_t first = m_tick + 1;
+    if (nowTick - m_tick > wxPY_WHEEL_SLOTS)
+        first = nowTick - wxPY_WHEEL_SLOTS + 1;
+    for (wxLongLong_t tick = first; tick <= nowTick; tick++) {
+        wxPyTimerEntry* entry = m_slots[tick % wxPY_WHEEL_SLOTS];
+        while (entry) {
+            wxPyTimerEntry* next = entry->next;
+            if (entry->dueTick <= nowTick) {
+                Unlink(entry);
+                entry->inBatch = true;
+                due.Add(entry);
+            }
+            entry = next;
+        }
+    }
+    m_tick = nowTick;
+
+    // the periodic calls are due again whatever happens to them meanwhile
+    size_t count = due.GetCount();
+    for (size_t i = 0; i < count; i++) {
+        wxPyTimerEntry* entry = (wxPyTimerEntry*)due[i];
+        if (entry->period) {
+            wxLongLong_t next = entry->due + entry->period;
+            if (next <= now)
+                next += ((now - next) / entry->period + 1) * entry->period;
+            SetDue(entry, next);
+            Link(entry);
+        }
+    }
+
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    for (size_t i = 0; i < count; i++) {
+        wxPyTimerEntry* entry = (wxPyTimerEntry*)due[i];
+        entry->inBatch = false;
+        if (entry->dead) {
+            delete entry;
+            continue;
+        }
+        if (entry->skip) {
+            entry->skip = false;
+            continue;
+        }
+
+        // the entry may be gone once the call returns
+        long id = entry->id;
+        PyObject* callable = entry->callable;
+        Py_INCREF(callable);
+        if (!entry->period) {
+            m_entries.erase(id);
+            Py_DECREF(entry->callable);
+            delete entry;
+        }
+        PyObject* result = PyObject_CallFunction(callable, "(l)", id);
+        if (result)
+            Py_DECREF(result);
+        else
+            PyErr_Print();
+        Py_DECREF(callable);
+    }
+    wxPyEndBlockThreads(blocked);
+
+    ArmEarliest(wxPyMonotonicMillis());
+}
+
+//----------------------------------------------------------------------
+
+struct wxPyIdleTask
+{
+    long        id;
+    PyObject*   task;
+    bool        isIterator;
+    int         priority;
+    int         budget;         // milliseconds per idle event, 0 for the slice
+    bool        removed;
+};
+
+//----------------------------------------------------------------------
+
 IMPLEMENT_ABSTRACT_CLASS(wxPyApp, wxApp);
 
+// Posted to the app when the CallAfter queue stops being empty.
+static wxEventType wxEVT_PY_CALL_AFTER = wxNewEventType();
+
 
 wxPyApp::wxPyApp() {
     m_assertMode = wxPYAPP_ASSERT_EXCEPTION;
     m_startupComplete = false;
     m_callFilterEvent = false;
+
+    m_callAfterQueue = NULL;
+    m_callAfterKeys = NULL;
+    m_callAfterPosted = false;
+    m_callAfterBatch = NULL;
+    m_callAfterNext = 0;
+    ResetCallAfterStats();
+    m_timerWheel = NULL;
+    m_idleSlice = 20;
+    m_lastIdleTaskId = 0;
+    m_runningIdleTasks = false;
+    Connect(wxID_ANY, wxID_ANY, wxEVT_PY_CALL_AFTER,
+            wxEventHandler(wxPyApp::OnCallAfter));
+    Connect(wxID_ANY, wxID_ANY, wxEVT_IDLE,
+            wxIdleEventHandler(wxPyApp::OnIdleTasks));
 }
 
 
 wxPyApp::~wxPyApp() {
+    delete m_timerWheel;
     wxPyDoingCleanup = true;
     wxPythonApp = NULL;
     wxApp::SetInstance(NULL);
@@ -271,7 +631,16 @@ int wxPyApp::OnExit() {
     wxPyBlock_t blocked = wxPyBeginBlockThreads();
     if (wxPyCBH_findCallback(m_myInst, "OnExit"))
         rval = wxPyCBH_callCallback(m_myInst, Py_BuildValue("()"));
+    // calls still queued will never run
+    Py_XDECREF(m_callAfterQueue);
+    Py_XDECREF(m_callAfterKeys);
+    m_callAfterQueue = m_callAfterKeys = NULL;
     wxPyEndBlockThreads(blocked);
+    delete m_timerWheel;
+    m_timerWheel = NULL;
+    for (size_t i = 0; i < m_idleTasks.GetCount(); i++)
+        ((wxPyIdleTask*)m_idleTasks[i])->removed = true;
+    PurgeIdleTasks();
     wxApp::OnExit();  // in this case always call the base class version
     return rval;
 }
@@ -305,7 +674,9 @@ void wxPyApp::ExitMainLoop() {
 int wxPyApp::FilterEvent(wxEvent& event) {
     int result = -1;
 
-    if (m_callFilterEvent) {
+    if (m_callFilterEvent &&
+        (m_filterEventTypes.empty() ||
+         m_filterEventTypes.find(event.GetEventType()) != m_filterEventTypes.end())) {
         wxPyBlock_t blocked = wxPyBeginBlockThreads();
         if (wxPyCBH_findCallback(m_myInst, "FilterEvent")) {
             wxString className = event.GetClassInfo()->GetClassName();
@@ -319,6 +690,331 @@ int wxPyApp::FilterEvent(wxEvent& event) {
 }
 
 
+void wxPyApp::_CallAfter(PyObject* callable, PyObject* args, PyObject* kw, PyObject* key)
+{
+    bool post = false;
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    // an unhashable key is left as a TypeError for the caller
+    if (key != Py_None && PyObject_Hash(key) == -1) {
+        wxPyEndBlockThreads(blocked);
+        return;
+    }
+    if (!m_callAfterQueue) {
+        m_callAfterQueue = PyList_New(0);
+        m_callAfterKeys = PyDict_New();
+    }
+
+    PyObject* entry = NULL;
+    if (key != Py_None)
+        entry = PyDict_GetItem(m_callAfterKeys, key);
+    if (entry) {
+        // keep the place and time of the queued call, but run this one
+        PyList_SetItem(entry, 0, (Py_INCREF(callable), callable));
+        PyList_SetItem(entry, 1, (Py_INCREF(args), args));
+        PyList_SetItem(entry, 2, (Py_INCREF(kw), kw));
+        m_callAfterCoalesced += 1;
+    }
+    else {
+        entry = Py_BuildValue("[OOOd]", callable, args, kw,
+                              wxGetLocalTimeMillis().ToDouble());
+        PyList_Append(m_callAfterQueue, entry);
+        if (key != Py_None)
+            PyDict_SetItem(m_callAfterKeys, key, entry);
+        Py_DECREF(entry);
+
+        long depth = (long)PyList_GET_SIZE(m_callAfterQueue);
+        if (depth > m_callAfterMaxDepth)
+            m_callAfterMaxDepth = depth;
+        post = !m_callAfterPosted;
+        m_callAfterPosted = true;
+    }
+    wxPyEndBlockThreads(blocked);
+
+    if (post) {
+        wxEvent* event = new wxCommandEvent(wxEVT_PY_CALL_AFTER);
+        QueueEvent(event);
+    }
+}
+
+
+// Run everything queued so far.  Calls queued while doing so are run by the
+// next event, so that a callable queueing itself can't starve the loop.
+//
+// A call may run a nested event loop, a modal dialog for example, which
+// gets here again.  The rest of the batch being run is then moved in front
+// of the nested batch, so the calls are still run in the order they were
+// queued, and the outer loop stops where the nested one took over.
+void wxPyApp::OnCallAfter(wxEvent& WXUNUSED(event))
+{
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    if (!m_callAfterQueue) {
+        wxPyEndBlockThreads(blocked);
+        return;
+    }
+    PyObject* batch = m_callAfterQueue;
+    m_callAfterQueue = PyList_New(0);
+    PyDict_Clear(m_callAfterKeys);
+    m_callAfterPosted = false;
+
+    PyObject* outerBatch = m_callAfterBatch;
+    Py_ssize_t outerNext = m_callAfterNext;
+    if (outerBatch) {
+        Py_ssize_t size = PyList_GET_SIZE(outerBatch);
+        PyObject* rest = PyList_GetSlice(outerBatch, outerNext, size);
+        PyList_SetSlice(batch, 0, 0, rest);
+        Py_DECREF(rest);
+        PyList_SetSlice(outerBatch, outerNext, size, NULL);
+    }
+
+    double now = wxGetLocalTimeMillis().ToDouble();
+    if (PyList_GET_SIZE(batch))
+        m_callAfterBatches += 1;
+    m_callAfterBatch = batch;
+    for (m_callAfterNext = 0; m_callAfterNext < PyList_GET_SIZE(batch); ) {
+        // a nested loop may cut the batch short while the entry runs
+        PyObject* entry = PyList_GET_ITEM(batch, m_callAfterNext);
+        Py_INCREF(entry);
+        m_callAfterNext += 1;
+
+        double latency = now - PyFloat_AsDouble(PyList_GET_ITEM(entry, 3));
+        m_callAfterLastLatency = latency;
+        if (latency > m_callAfterMaxLatency)
+            m_callAfterMaxLatency = latency;
+        m_callAfterDelivered += 1;
+
+        PyObject* kw = PyList_GET_ITEM(entry, 2);
+        PyObject* result = PyObject_Call(PyList_GET_ITEM(entry, 0),
+                                         PyList_GET_ITEM(entry, 1),
+                                         kw == Py_None ? NULL : kw);
+        if (result)
+            Py_DECREF(result);
+        else
+            PyErr_Print();
+        Py_DECREF(entry);
+    }
+    m_callAfterBatch = outerBatch;
+    m_callAfterNext = outerNext;
+    Py_DECREF(batch);
+    wxPyEndBlockThreads(blocked);
+}
+
+
+PyObject* wxPyApp::GetCallAfterStats()
+{
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    long depth = m_callAfterQueue ? (long)PyList_GET_SIZE(m_callAfterQueue) : 0;
+    PyObject* stats = Py_BuildValue("{s:l,s:l,s:l,s:l,s:l,s:d,s:d}",
+                                    "depth", depth,
+                                    "maxDepth", m_callAfterMaxDepth,
+                                    "delivered", m_callAfterDelivered,
+                                    "coalesced", m_callAfterCoalesced,
+                                    "batches", m_callAfterBatches,
+                                    "lastLatency", m_callAfterLastLatency,
+                                    "maxLatency", m_callAfterMaxLatency);
+    wxPyEndBlockThreads(blocked);
+    return stats;
+}
+
+
+void wxPyApp::ResetCallAfterStats()
+{
+    m_callAfterDelivered = 0;
+    m_callAfterCoalesced = 0;
+    m_callAfterBatches = 0;
+    m_callAfterMaxDepth = 0;
+    m_callAfterLastLatency = 0;
+    m_callAfterMaxLatency = 0;
+}
+
+
+long wxPyApp::_CallLater(PyObject* callable, int millis, bool periodic)
+{
+    if (!m_timerWheel)
+        m_timerWheel = new wxPyTimerWheel;
+    return m_timerWheel->Schedule(callable, millis, periodic);
+}
+
+
+bool wxPyApp::_RestartCallLater(long id, int millis)
+{
+    return m_timerWheel && m_timerWheel->Restart(id, millis);
+}
+
+
+bool wxPyApp::_CancelCallLater(long id)
+{
+    return m_timerWheel && m_timerWheel->Cancel(id);
+}
+
+
+bool wxPyApp::_IsCallLaterPending(long id)
+{
+    return m_timerWheel && m_timerWheel->IsPending(id);
+}
+
+
+// The idle tasks are only used from the GUI thread, so m_idleTasks needs no
+// lock.  A task added by an event handler runs at the next idle event
+// anyway, there is no need to wake the loop up.
+long wxPyApp::AddIdleTask(PyObject* task, int priority, int budget)
+{
+    wxCHECK_MSG(wxIsMainThread(), 0,
+                wxT("AddIdleTask must be called from the GUI thread"));
+    wxPyIdleTask* entry = new wxPyIdleTask;
+    entry->id = ++m_lastIdleTaskId;
+    entry->task = task;
+    entry->priority = priority;
+    entry->budget = budget;
+    entry->removed = false;
+
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    entry->isIterator = PyIter_Check(task);
+    Py_INCREF(task);
+    wxPyEndBlockThreads(blocked);
+
+    // after the tasks of the same priority
+    size_t pos = 0;
+    while (pos < m_idleTasks.GetCount() &&
+           ((wxPyIdleTask*)m_idleTasks[pos])->priority >= priority)
+        pos++;
+    m_idleTasks.Insert(entry, pos);
+    return entry->id;
+}
+
+
+bool wxPyApp::RemoveIdleTask(long id)
+{
+    wxCHECK_MSG(wxIsMainThread(), false,
+                wxT("RemoveIdleTask must be called from the GUI thread"));
+    for (size_t i = 0; i < m_idleTasks.GetCount(); i++) {
+        wxPyIdleTask* entry = (wxPyIdleTask*)m_idleTasks[i];
+        if (entry->id == id && !entry->removed) {
+            entry->removed = true;
+            if (!m_runningIdleTasks)
+                PurgeIdleTasks();
+            return true;
+        }
+    }
+    return false;
+}
+
+
+int wxPyApp::GetIdleTaskCount()
+{
+    int count = 0;
+    for (size_t i = 0; i < m_idleTasks.GetCount(); i++)
+        if (!((wxPyIdleTask*)m_idleTasks[i])->removed)
+            count++;
+    return count;
+}
+
+
+void wxPyApp::PurgeIdleTasks()
+{
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    for (size_t i = m_idleTasks.GetCount(); i > 0; i--) {
+        wxPyIdleTask* entry = (wxPyIdleTask*)m_idleTasks[i-1];
+        if (entry->removed) {
+            m_idleTasks.RemoveAt(i-1);
+            Py_DECREF(entry->task);
+            delete entry;
+        }
+    }
+    wxPyEndBlockThreads(blocked);
+}
+
+
+// Run the idle tasks, highest priority first, until the slice is used up.
+// Each task runs until it is done or its budget is used, and then goes after
+// the other tasks of its priority so they take turns.  More idle events are
+// only requested while some tasks are left.
+void wxPyApp::OnIdleTasks(wxIdleEvent& event)
+{
+    event.Skip();
+    if (m_idleTasks.IsEmpty() || m_runningIdleTasks)
+        return;
+
+    m_runningIdleTasks = true;
+    wxLongLong_t start = wxPyMonotonicMillis();
+    wxLongLong_t end = start + m_idleSlice;
+    wxArrayPtrVoid ran;
+
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    for (size_t i = 0; i < m_idleTasks.GetCount(); i++) {
+        wxPyIdleTask* entry = (wxPyIdleTask*)m_idleTasks[i];
+        // a task added by another one may have moved this one along
+        if (entry->removed || ran.Index(entry) != wxNOT_FOUND)
+            continue;
+
+        wxLongLong_t now = wxPyMonotonicMillis();
+        if (now >= end && !ran.IsEmpty())
+            break;
+        wxLongLong_t stop = end;
+        if (entry->budget > 0 && now + entry->budget < end)
+            stop = now + entry->budget;
+
+        // always do at least one step, so a task can't be starved by a
+        // slice that is too small for it
+        do {
+            PyObject* result;
+            if (entry->isIterator)
+                result = PyIter_Next(entry->task);
+            else
+                result = PyObject_CallObject(entry->task, NULL);
+
+            if (!result) {
+                if (PyErr_Occurred())
+                    PyErr_Print();
+                entry->removed = true;
+            }
+            else {
+                if (!entry->isIterator && !PyObject_IsTrue(result))
+                    entry->removed = true;
+                Py_DECREF(result);
+            }
+        } while (!entry->removed && wxPyMonotonicMillis() < stop);
+        ran.Add(entry);
+    }
+    wxPyEndBlockThreads(blocked);
+
+    // move the tasks that ran after the others of the same priority
+    for (size_t i = 0; i < ran.GetCount(); i++) {
+        wxPyIdleTask* entry = (wxPyIdleTask*)ran[i];
+        if (entry->removed)
+            continue;
+        m_idleTasks.Remove(entry);
+        size_t pos = 0;
+        while (pos < m_idleTasks.GetCount() &&
+               ((wxPyIdleTask*)m_idleTasks[pos])->priority >= entry->priority)
+            pos++;
+        m_idleTasks.Insert(entry, pos);
+    }
+
+    m_runningIdleTasks = false;
+    PurgeIdleTasks();
+    if (!m_idleTasks.IsEmpty())
+        event.RequestMore();
+}
+
+
+void wxPyApp::SetFilterEventTypes(const wxArrayInt& types)
+{
+    m_filterEventTypes.clear();
+    for (size_t i = 0; i < types.GetCount(); i++)
+        m_filterEventTypes.insert(types[i]);
+}
+
+
+wxArrayInt wxPyApp::GetFilterEventTypes()
+{
+    wxArrayInt types;
+    for (wxPyEventTypeSet::iterator it = m_filterEventTypes.begin();
+         it != m_filterEventTypes.end(); ++it)
+        types.Add(*it);
+    return types;
+}
+
+
 void wxPyApp::OnAssertFailure(const wxChar *file,
                               int line,
                               const wxChar *func,
@@ -1150,6 +1846,175 @@ void wxPySaveThreadState(PyThreadState* tstate) {
 #endif
 
 
+//----------------------------------------------------------------------
+// Counters for the binding layer's hot paths, see wx.GetBindingStats.  They
+// are only updated while holding the GIL, so they need no lock of their own.
+//----------------------------------------------------------------------
+
+#if wxPyUSE_BINDING_STATS
+
+#define wxPY_STATS_BUCKETS  24      // histogram buckets, by powers of 2 usec
+
+struct wxPyCallbackStats
+{
+    wxPyCallbackStats() : lookups(0), calls(0), usec(0) {}
+
+    long            lookups;        // findCallback calls
+    long            calls;          // calls of an override found in Python
+    wxLongLong_t    usec;           // time spent in those calls
+};
+
+// The callbacks are keyed by the name given to findCallback, which is always
+// a string literal in one of the extension modules.
+WX_DECLARE_HASH_MAP(const char*, wxPyCallbackStats, wxStringHash, wxStringEqual, wxPyCallbackStatsMap);
+WX_DECLARE_HASH_MAP(int, long, wxIntegerHash, wxIntegerEqual, wxPyEventCountMap);
+WX_DECLARE_STRING_HASH_MAP(long, wxPyProxyCountMap);
+
+bool wxPyBindingStatsEnabled = false;
+
+static wxPyCallbackStatsMap gs_statsCallbacks;
+static wxPyEventCountMap    gs_statsEvents;
+static wxPyProxyCountMap    gs_statsProxies;
+static long                 gs_statsCallbackTimes[wxPY_STATS_BUCKETS];
+static long                 gs_statsGILAcquired = 0;
+static long                 gs_statsGILNested = 0;
+static wxLongLong_t         gs_statsGILWait = 0;
+static long                 gs_statsGILWaits[wxPY_STATS_BUCKETS];
+
+
+static inline wxLongLong_t wxPyStatsNow()
+{
+    return wxPyMonotonicMicros();
+}
+
+
+// Bucket 0 counts durations under a microsecond, bucket n those from 2**(n-1)
+// up to 2**n microseconds, and the last one everything longer.
+static void wxPyStatsAddTime(long* histogram, wxLongLong_t usec)
+{
+    int bucket = 0;
+    while (usec > 0 && bucket < wxPY_STATS_BUCKETS-1) {
+        usec >>= 1;
+        bucket += 1;
+    }
+    histogram[bucket] += 1;
+}
+
+
+// The GIL was acquired after waiting for it since start.
+static void wxPyStatsGILAcquired(wxLongLong_t start)
+{
+    wxLongLong_t wait = wxPyStatsNow() - start;
+    gs_statsGILAcquired += 1;
+    gs_statsGILWait += wait;
+    wxPyStatsAddTime(gs_statsGILWaits, wait);
+}
+
+
+static PyObject* wxPyStatsHistogram(const long* histogram)
+{
+    PyObject* list = PyList_New(wxPY_STATS_BUCKETS);
+    for (int i=0; i < wxPY_STATS_BUCKETS; i++)
+        PyList_SET_ITEM(list, i, PyInt_FromLong(histogram[i]));
+    return list;
+}
+
+
+static void wxPyStatsSetItem(PyObject* dict, const char* key, PyObject* value)
+{
+    PyDict_SetItemString(dict, key, value);
+    Py_DECREF(value);
+}
+
+
+void wxPyBindingStatsAddProxy(const wxString& className)
+{
+    gs_statsProxies[className] += 1;
+}
+
+#endif // wxPyUSE_BINDING_STATS
+
+
+PyObject* wxGetBindingStats()
+{
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    PyObject* stats = PyDict_New();
+#if wxPyUSE_BINDING_STATS
+    wxPyStatsSetItem(stats, "available", PyBool_FromLong(true));
+    wxPyStatsSetItem(stats, "enabled", PyBool_FromLong(wxPyBindingStatsEnabled));
+
+    PyObject* callbacks = PyDict_New();
+    for (wxPyCallbackStatsMap::iterator it = gs_statsCallbacks.begin();
+         it != gs_statsCallbacks.end(); ++it) {
+        PyObject* value = Py_BuildValue("(lld)", it->second.lookups, it->second.calls,
+                                        (double)it->second.usec / 1e6);
+        PyDict_SetItemString(callbacks, (char*)it->first, value);
+        Py_DECREF(value);
+    }
+    wxPyStatsSetItem(stats, "callbacks", callbacks);
+    wxPyStatsSetItem(stats, "callbackTimes", wxPyStatsHistogram(gs_statsCallbackTimes));
+
+    wxPyStatsSetItem(stats, "gil", Py_BuildValue("(lld)", gs_statsGILAcquired, gs_statsGILNested,
+                                                 (double)gs_statsGILWait / 1e6));
+    wxPyStatsSetItem(stats, "gilWaits", wxPyStatsHistogram(gs_statsGILWaits));
+
+    PyObject* proxies = PyDict_New();
+    for (wxPyProxyCountMap::iterator it = gs_statsProxies.begin();
+         it != gs_statsProxies.end(); ++it) {
+        PyObject* key = wx2PyString(it->first);
+        PyObject* value = PyInt_FromLong(it->second);
+        PyDict_SetItem(proxies, key, value);
+        Py_DECREF(key);
+        Py_DECREF(value);
+    }
+    wxPyStatsSetItem(stats, "proxies", proxies);
+
+    PyObject* events = PyDict_New();
+    for (wxPyEventCountMap::iterator it = gs_statsEvents.begin();
+         it != gs_statsEvents.end(); ++it) {
+        PyObject* key = PyInt_FromLong(it->first);
+        PyObject* value = PyInt_FromLong(it->second);
+        PyDict_SetItem(events, key, value);
+        Py_DECREF(key);
+        Py_DECREF(value);
+    }
+    wxPyStatsSetItem(stats, "events", events);
+#else
+    PyDict_SetItemString(stats, "available", Py_False);
+    PyDict_SetItemString(stats, "enabled", Py_False);
+#endif
+    wxPyEndBlockThreads(blocked);
+    return stats;
+}
+
+
+void wxResetBindingStats()
+{
+#if wxPyUSE_BINDING_STATS
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    gs_statsCallbacks.clear();
+    gs_statsEvents.clear();
+    gs_statsProxies.clear();
+    memset(gs_statsCallbackTimes, 0, sizeof(gs_statsCallbackTimes));
+    memset(gs_statsGILWaits, 0, sizeof(gs_statsGILWaits));
+    gs_statsGILAcquired = 0;
+    gs_statsGILNested = 0;
+    gs_statsGILWait = 0;
+    wxPyEndBlockThreads(blocked);
+#endif
+}
+
+
+void wxEnableBindingStats(bool enable)
+{
+#if wxPyUSE_BINDING_STATS
+    wxPyBindingStatsEnabled = enable;
+#else
+    wxUnusedVar(enable);
+#endif
+}
+
+
 
 // Calls from Python to wxWindows code are wrapped in calls to these
 // functions:
@@ -1168,7 +2033,14 @@ PyThreadState* wxPyBeginAllowThreads() {
 
 void wxPyEndAllowThreads(PyThreadState* saved) {
 #ifdef WXP_WITH_THREAD
+#if wxPyUSE_BINDING_STATS
+    wxLongLong_t start = wxPyBindingStatsEnabled ? wxPyStatsNow() : 0;
+#endif
     PyEval_RestoreThread(saved);   // Py_END_ALLOW_THREADS;
+#if wxPyUSE_BINDING_STATS
+    if (start)
+        wxPyStatsGILAcquired(start);
+#endif
 #endif
 }
 
@@ -1182,8 +2054,19 @@ wxPyBlock_t wxPyBeginBlockThreads() {
     if (! Py_IsInitialized()) {
         return (wxPyBlock_t)0;
     }
+#if wxPyUSE_BINDING_STATS
+    wxLongLong_t start = wxPyBindingStatsEnabled ? wxPyStatsNow() : 0;
+#endif
 #if wxPyUSE_GIL_STATE
     PyGILState_STATE state = PyGILState_Ensure();
+#if wxPyUSE_BINDING_STATS
+    if (start) {
+        if (state == PyGILState_UNLOCKED)
+            wxPyStatsGILAcquired(start);
+        else
+            gs_statsGILNested += 1;
+    }
+#endif
     return state;
 #else
     PyThreadState *current = _PyThreadState_Current;
@@ -1197,6 +2080,14 @@ wxPyBlock_t wxPyBeginBlockThreads() {
         PyEval_RestoreThread(tstate->tstate);
         blocked = true;
     }
+#if wxPyUSE_BINDING_STATS
+    if (start) {
+        if (blocked)
+            wxPyStatsGILAcquired(start);
+        else
+            gs_statsGILNested += 1;
+    }
+#endif
     return blocked;
 #endif
 #else
@@ -1772,6 +2663,10 @@ void wxPyCallback::EventThunker(wxEvent& event) {
 
     wxPyBlock_t blocked = wxPyBeginBlockThreads();
     wxString className = event.GetClassInfo()->GetClassName();
+#if wxPyUSE_BINDING_STATS
+    if (wxPyBindingStatsEnabled)
+        gs_statsEvents[event.GetEventType()] += 1;
+#endif
 
     // If the event is one of these types then pass the original
     // event object instead of the one passed to us.
@@ -1854,6 +2749,7 @@ void wxPyCallback::EventThunker(wxEvent& event) {
 wxPyCallbackHelper::wxPyCallbackHelper(const wxPyCallbackHelper& other) {
       wxPyThreadBlocker blocker;
       m_lastFound = NULL;
+      m_lastName = NULL;
       m_self = other.m_self;
       m_class = other.m_class;
       if (m_self) {
@@ -1991,6 +2887,11 @@ bool wxPyCallbackHelper::findCallback(const char* name, bool setGuard) const {
     PyObject *method, *klass;
     PyObject* nameo = PyString_FromString(name);
     self->m_lastFound = NULL;
+    self->m_lastName = name;
+#if wxPyUSE_BINDING_STATS
+    if (wxPyBindingStatsEnabled)
+        gs_statsCallbacks[name].lookups += 1;
+#endif
 
     // If the object (m_self) has an attibute of the given name...
     if (m_self && PyObject_HasAttr(m_self, nameo)) {
@@ -2042,9 +2943,23 @@ PyObject* wxPyCallbackHelper::callCallbackObj(PyObject* argTuple) const {
     // callback.  In that case m_lastFound will have a different value when
     // it gets back here...
     PyObject* method = m_lastFound;
+#if wxPyUSE_BINDING_STATS
+    const char* name = m_lastName;
+    wxLongLong_t start = wxPyBindingStatsEnabled ? wxPyStatsNow() : 0;
+#endif
 
     result = PyEval_CallObject(method, argTuple);
     clearRecursionGuard(method);
+
+#if wxPyUSE_BINDING_STATS
+    if (start && name) {
+        wxLongLong_t usec = wxPyStatsNow() - start;
+        wxPyCallbackStats& stats = gs_statsCallbacks[name];
+        stats.calls += 1;
+        stats.usec += usec;
+        wxPyStatsAddTime(gs_statsCallbackTimes, usec);
+    }
+#endif
     
     Py_DECREF(argTuple);
     Py_DECREF(method);
@@ -28,6 +28,7 @@
 #include <wx/html/helpwnd.h>
 #include <wx/html/helpfrm.h>
 #include <wx/html/helpdlg.h>
+#include <wx/uri.h>
 
 %}
 
@@ -918,6 +919,360 @@ public:
 
 
 %{
+// Sent while a page is being laid out progressively, with the percentage
+// of the source done so far in GetInt.
+wxEventType wxEVT_COMMAND_HTML_PAGE_PROGRESS = wxNewEventType();
+
+// The size of the pieces that progressively set pages are parsed in.
+#define wxPY_HTML_CHUNK_SIZE 16384
+
+// Tags that are not counted when looking for the top level of the document,
+// because they have no end tag, or it is optional, or they enclose the
+// whole body.
+static const wxChar* wxPyHtmlFlatTags[] = {
+    wxT("html"), wxT("head"), wxT("body"),
+    wxT("br"), wxT("hr"), wxT("img"), wxT("input"), wxT("meta"), wxT("link"),
+    wxT("area"), wxT("base"), wxT("basefont"), wxT("col"), wxT("param"),
+    wxT("wbr"), wxT("frame"), wxT("p"), wxT("li"), wxT("dt"), wxT("dd"),
+    wxT("tr"), wxT("td"), wxT("th"), wxT("option"),
+    NULL
+};
+
+static bool wxPyHtmlIsFlatTag(const wxString& name)
+{
+    for (const wxChar** tag = wxPyHtmlFlatTags; *tag; tag++)
+        if (name == *tag)
+            return true;
+    return false;
+}
+
+// Does the text at it start with str (which must be lower case)?
+static bool wxPyHtmlStartsWith(wxString::const_iterator it,
+                               wxString::const_iterator end,
+                               const wxChar* str)
+{
+    for ( ; *str; str++, ++it)
+        if (it == end || (wxChar)wxTolower(*it) != *str)
+            return false;
+    return true;
+}
+
+// Tags starting a block, a piece split inside an element starts with one of
+// them so the split doesn't break a line of text in two.
+static const wxChar* wxPyHtmlBlockTags[] = {
+    wxT("p"), wxT("div"), wxT("table"), wxT("tr"), wxT("pre"), wxT("center"),
+    wxT("blockquote"), wxT("ul"), wxT("ol"), wxT("dl"), wxT("li"), wxT("dt"),
+    wxT("dd"), wxT("hr"), wxT("h1"), wxT("h2"), wxT("h3"), wxT("h4"),
+    wxT("h5"), wxT("h6"),
+    NULL
+};
+
+static bool wxPyHtmlIsTagIn(const wxString& name, const wxChar** tags)
+{
+    for ( ; *tags; tags++)
+        if (name == *tags)
+            return true;
+    return false;
+}
+
+// Elements whose rows or items are not tracked (see wxPyHtmlFlatTags), so
+// a piece can only be split right inside them, before the next row or item.
+static const wxChar* wxPyHtmlRowTags[] = {
+    wxT("ul"), wxT("ol"), wxT("dl"), wxT("menu"), wxT("dir"), wxT("pre"),
+    NULL
+};
+
+// Tables are never split, the pieces would be laid out as separate tables
+// with columns of their own widths.
+static const wxChar* wxPyHtmlTableTags[] = {
+    wxT("table"), wxT("tbody"), wxT("thead"), wxT("tfoot"),
+    NULL
+};
+
+// Can a piece inside the first count open elements start with the tag name?
+static bool wxPyHtmlCanSplitAt(const wxArrayString& openNames, size_t count,
+                               const wxString& name)
+{
+    if (count == 0)
+        return true;
+    for (size_t i=0; i < count; i++)
+        if (wxPyHtmlIsTagIn(openNames[i], wxPyHtmlTableTags))
+            return false;
+    for (size_t i=0; i < count-1; i++)
+        if (wxPyHtmlIsTagIn(openNames[i], wxPyHtmlRowTags))
+            return false;
+
+    const wxString& inner = openNames[count-1];
+    if (inner == wxT("ul") || inner == wxT("ol") ||
+        inner == wxT("menu") || inner == wxT("dir"))
+        return name == wxT("li");
+    if (inner == wxT("dl"))
+        return name == wxT("dt") || name == wxT("dd");
+    if (inner == wxT("pre"))
+        return false;
+    return wxPyHtmlIsTagIn(name, wxPyHtmlBlockTags);
+}
+
+// Add text as a piece, closing the elements open at its end, and set reopen
+// to the body tag and their start tags for the next piece.
+static void wxPyHtmlAddPiece(wxArrayString& chunks, const wxString& text,
+                             wxString& reopen, const wxString& body,
+                             const wxArrayString& openNames,
+                             const wxArrayString& openTags)
+{
+    wxString piece = reopen + text;
+    for (size_t i=openNames.GetCount(); i > 0; i--)
+        piece += wxT("</") + openNames[i-1] + wxT(">");
+    chunks.Add(piece);
+    reopen = body;
+    for (size_t i=0; i < openTags.GetCount(); i++)
+        reopen += openTags[i];
+}
+
+// Split HTML source into pieces of roughly chunkSize characters, so that
+// each of them can be parsed on its own.  Pieces are split between tags at
+// the top level of the body, or inside big elements before a block tag
+// (before an item of a list or a line of a pre), but never inside a table.
+// The elements open at such a split are closed at the end of the piece and
+// opened again, with their attributes, at the start of the next one.  The
+// body tag is repeated too, the parser forgets its colours between pieces.
+static void wxPyHtmlSplitSource(const wxString& source, size_t chunkSize,
+                                wxArrayString& chunks)
+{
+    wxString::const_iterator start = source.begin();
+    wxString::const_iterator it = source.begin();
+    wxString::const_iterator end = source.end();
+    size_t length = 0;
+    wxArrayString openNames;    // the elements open at it
+    wxArrayString openTags;     // and their start tags
+    wxString reopen;            // the start tags the piece begins with
+    wxString body;              // the body tag, once it was seen
+
+    while (it != end) {
+        if (*it != wxT('<')) {
+            bool newline = *it == wxT('\n');
+            ++it; ++length;
+            // the lines of a pre can be split as well
+            if (newline && length >= chunkSize && it != end &&
+                !openNames.IsEmpty() && openNames.Last() == wxT("pre") &&
+                wxPyHtmlCanSplitAt(openNames, openNames.GetCount()-1, wxT("pre"))) {
+                wxPyHtmlAddPiece(chunks, wxString(start, it), reopen, body, openNames, openTags);
+                start = it;
+                length = 0;
+            }
+            continue;
+        }
+
+        if (length >= chunkSize) {
+            wxString::const_iterator n = it;
+            ++n;
+            wxString next;
+            while (n != end && wxIsalnum(*n))
+                next += (wxChar)wxTolower(*n++);
+            // at the top level any tag will do
+            if (openNames.IsEmpty() ||
+                (!next.empty() && wxPyHtmlCanSplitAt(openNames, openNames.GetCount(), next))) {
+                wxPyHtmlAddPiece(chunks, wxString(start, it), reopen, body, openNames, openTags);
+                start = it;
+                length = 0;
+            }
+        }
+
+        if (wxPyHtmlStartsWith(it, end, wxT("<!--"))) {
+            while (it != end && !wxPyHtmlStartsWith(it, end, wxT("-->"))) {
+                ++it; ++length;
+            }
+            continue;
+        }
+
+        wxString::const_iterator tagStart = it;
+        ++it; ++length;
+        bool closing = false;
+        if (it != end && *it == wxT('/')) {
+            closing = true;
+            ++it; ++length;
+        }
+        wxString name;
+        while (it != end && wxIsalnum(*it)) {
+            name += (wxChar)wxTolower(*it);
+            ++it; ++length;
+        }
+
+        // skip the attributes, minding quoted '>'
+        wxChar quote = 0;
+        wxChar last = 0;
+        while (it != end && (quote || *it != wxT('>'))) {
+            if (quote) {
+                if (*it == quote)
+                    quote = 0;
+            }
+            else if (*it == wxT('"') || *it == wxT('\''))
+                quote = *it;
+            last = *it;
+            ++it; ++length;
+        }
+        if (it != end) {
+            ++it; ++length;
+        }
+
+        if (!closing && name == wxT("body"))
+            body = wxString(tagStart, it);
+        if (name.empty() || wxPyHtmlIsFlatTag(name))
+            continue;
+        if (closing) {
+            // close it and whatever was left open inside it
+            for (size_t i=openNames.GetCount(); i > 0; i--) {
+                if (openNames[i-1] == name) {
+                    openNames.RemoveAt(i-1, openNames.GetCount()-i+1);
+                    openTags.RemoveAt(i-1, openTags.GetCount()-i+1);
+                    break;
+                }
+            }
+        }
+        else if (last != wxT('/')) {
+            openNames.Add(name);
+            openTags.Add(wxString(tagStart, it));
+
+            // the contents of these can contain anything
+            if (name == wxT("script") || name == wxT("style")) {
+                wxString endTag = wxT("</") + name;
+                while (it != end && !wxPyHtmlStartsWith(it, end, endTag.c_str())) {
+                    ++it; ++length;
+                }
+            }
+        }
+    }
+
+    if (start != end)
+        chunks.Add(reopen + wxString(start, end));
+}
+
+
+// Collect the image URLs (the src of img tags and background attributes)
+// that parsing the source will ask OnOpeningURL about.
+static void wxPyHtmlFindImageURLs(const wxString& source, wxArrayString& urls)
+{
+    wxString::const_iterator it = source.begin();
+    wxString::const_iterator end = source.end();
+
+    while (it != end) {
+        if (*it++ != wxT('<'))
+            continue;
+
+        wxString name;
+        while (it != end && wxIsalnum(*it))
+            name += (wxChar)wxTolower(*it++);
+        if (name.empty())
+            continue;
+
+        while (it != end && *it != wxT('>')) {
+            if (wxIsspace(*it)) {
+                ++it;
+                continue;
+            }
+            wxString attr;
+            while (it != end && *it != wxT('=') && *it != wxT('>') && !wxIsspace(*it))
+                attr += (wxChar)wxTolower(*it++);
+            if (it == end || *it != wxT('='))
+                continue;
+            ++it;
+
+            wxString value;
+            if (it != end && (*it == wxT('"') || *it == wxT('\''))) {
+                wxChar quote = *it++;
+                while (it != end && *it != quote)
+                    value += *it++;
+                if (it != end)
+                    ++it;
+            }
+            else {
+                while (it != end && *it != wxT('>') && !wxIsspace(*it))
+                    value += *it++;
+            }
+
+            if ((attr == wxT("src") && name == wxT("img")) || attr == wxT("background")) {
+                value.Replace(wxT("&amp;"), wxT("&"));
+                if (!value.empty())
+                    urls.Add(value);
+            }
+        }
+    }
+}
+
+// Make the URL of a page element absolute the same way wxHtmlWinParser does
+// before passing it to OnOpeningURL.
+static wxString wxPyHtmlResolveURL(const wxString& url, wxFileSystem* fs)
+{
+    wxURI current(url);
+    wxString fullurl = current.BuildUnescapedURI();
+    if (current.IsReference() && fs) {
+        wxString basepath = fs->GetPath();
+        wxURI base(basepath);
+        if (!base.IsReference()) {
+            wxURI path(fullurl);
+            path.Resolve(base);
+            fullurl = path.BuildUnescapedURI();
+        }
+        else if (!current.GetPath().Contains(base.GetPath())) {
+            basepath += url;
+            wxURI connected(basepath);
+            fullurl = connected.BuildUnescapedURI();
+        }
+    }
+    return fullurl;
+}
+
+// Convert what OnOpeningURL(s) returned in Python: a string is a redirect,
+// anything else should be a wxHtmlOpeningStatus. Returns false if it is
+// neither.
+static bool wxPyHtmlConvertURLStatus(PyObject* ro, wxHtmlOpeningStatus* status,
+                                     wxString* redirect)
+{
+    if (!ro)
+        return false;
+    if (PyString_Check(ro)
+#if PYTHON_API_VERSION >= 1009
+        || PyUnicode_Check(ro)
+#endif
+        ) {
+        *redirect = Py2wxString(ro);
+        *status = wxHTML_REDIRECT;
+        return true;
+    }
+    PyObject* num = PyNumber_Int(ro);
+    if (!num) {
+        PyErr_Clear();
+        return false;
+    }
+    *status = (wxHtmlOpeningStatus)PyInt_AsLong(num);
+    Py_DECREF(num);
+    return true;
+}
+
+
+// An answer of OnOpeningURL, and when it was given.
+class wxPyHtmlURLDecision
+{
+public:
+    wxPyHtmlURLDecision() : m_status(wxHTML_OPEN) {}
+    wxPyHtmlURLDecision(wxHtmlOpeningStatus status, const wxString& redirect)
+        : m_status(status), m_redirect(redirect),
+          m_time(wxGetLocalTimeMillis()) {}
+
+    wxHtmlOpeningStatus m_status;
+    wxString            m_redirect;
+    wxLongLong          m_time;
+};
+
+// Keyed by the URL type and the URL.
+WX_DECLARE_STRING_HASH_MAP(wxPyHtmlURLDecision, wxPyHtmlURLDecisionMap);
+
+static wxString wxPyHtmlURLKey(wxHtmlURLType type, const wxString& url)
+{
+    return wxString::Format(wxT("%d "), (int)type) + url;
+}
+
+
 class wxPyHtmlWindow : public wxHtmlWindow {
     DECLARE_ABSTRACT_CLASS(wxPyHtmlWindow)
 public:
@@ -926,8 +1281,28 @@ public:
                    const wxSize& size = wxDefaultSize,
                    long style = wxHW_DEFAULT_STYLE,
                    const wxString& name = wxPyHtmlWindowNameStr)
-        : wxHtmlWindow(parent, id, pos, size, style, name)  {};
-    wxPyHtmlWindow() : wxHtmlWindow() {};
+        : wxHtmlWindow(parent, id, pos, size, style, name),
+          m_progressiveSlice(0), m_progressivePage(false),
+          m_nextChunk(0), m_progressiveCell(NULL),
+          m_progressiveDone(0), m_progressiveTotal(0),
+          m_urlCacheTimeout(0) {};
+    wxPyHtmlWindow() : wxHtmlWindow(),
+          m_progressiveSlice(0), m_progressivePage(false),
+          m_nextChunk(0), m_progressiveCell(NULL),
+          m_progressiveDone(0), m_progressiveTotal(0),
+          m_urlCacheTimeout(0) {};
+
+    virtual bool SetPage(const wxString& source);
+    bool AppendToPage(const wxString& source);
+
+    void SetProgressiveLayout(int sliceMillis) { m_progressiveSlice = sliceMillis; }
+    int GetProgressiveLayout() const { return m_progressiveSlice; }
+    bool IsLayoutInProgress() const { return m_nextChunk < m_chunks.GetCount(); }
+    void CancelProgressiveLayout();
+
+    void SetURLCacheTimeout(int millis) { m_urlCacheTimeout = millis; ClearURLCache(); }
+    int GetURLCacheTimeout() const { return m_urlCacheTimeout; }
+    void ClearURLCache() { m_urlCache.clear(); }
 
     bool ScrollToAnchor(const wxString& anchor) {
         return wxHtmlWindow::ScrollToAnchor(anchor);
@@ -948,10 +1323,194 @@ public:
     DEC_PYCALLBACK__CELLINTINT(OnCellMouseHover);
     DEC_PYCALLBACK_BOOL_CELLINTINTME(OnCellClicked);
 
+protected:
+    bool LayoutChunks(long millis);
+    void SendProgressEvent();
+    void OnProgressiveIdle(wxIdleEvent& event);
+
+    int             m_progressiveSlice;     // 0 if not progressive
+    bool            m_progressivePage;      // the page was set progressively
+    wxArrayString   m_chunks;               // pieces of the source,
+    size_t          m_nextChunk;            // the ones before this are shown
+    wxHtmlContainerCell* m_progressiveCell; // m_Cell they were added to
+    wxString        m_lastChunk;            // last source m_Parser parsed
+    size_t          m_progressiveDone;
+    size_t          m_progressiveTotal;
+
+    void PrefetchURLs(const wxString& source);
+
+    // 0 if OnOpeningURL answers are not cached, -1 if they never expire
+    int             m_urlCacheTimeout;
+    mutable wxPyHtmlURLDecisionMap m_urlCache;
+    // answers of OnOpeningURLs for the page being parsed
+    wxPyHtmlURLDecisionMap m_prefetchedURLs;
+
+    DECLARE_EVENT_TABLE()
     PYPRIVATE;
 };
 
 IMPLEMENT_ABSTRACT_CLASS( wxPyHtmlWindow, wxHtmlWindow );
+
+BEGIN_EVENT_TABLE(wxPyHtmlWindow, wxHtmlWindow)
+    EVT_IDLE(wxPyHtmlWindow::OnProgressiveIdle)
+END_EVENT_TABLE()
+
+
+// With progressive layout the page is split in pieces between block
+// elements, see wxPyHtmlSplitSource.  Only the pieces that fill the first
+// screen are parsed right away, the rest are parsed and laid out a slice of
+// time at a time from idle events.
+bool wxPyHtmlWindow::SetPage(const wxString& source)
+{
+    CancelProgressiveLayout();
+    m_prefetchedURLs.clear();
+    PrefetchURLs(source);
+    if (m_progressiveSlice <= 0)
+        return wxHtmlWindow::SetPage(source);
+
+    wxPyHtmlSplitSource(source, wxPY_HTML_CHUNK_SIZE, m_chunks);
+    if (m_chunks.GetCount() < 2) {
+        m_chunks.Clear();
+        return wxHtmlWindow::SetPage(source);
+    }
+
+    m_progressiveTotal = source.length();
+    m_progressiveDone = m_chunks[0].length();
+    m_nextChunk = 1;
+    bool rval = wxHtmlWindow::SetPage(m_chunks[0]);
+    if (!rval || !m_Cell) {
+        CancelProgressiveLayout();
+        return rval;
+    }
+    m_progressivePage = true;
+    m_progressiveCell = m_Cell;
+    m_lastChunk = *m_Parser->GetSource();
+
+    // Show the first screenful straight away
+    while (IsLayoutInProgress() &&
+           m_Cell->GetHeight() < GetClientSize().GetHeight())
+        LayoutChunks(0);
+
+    SendProgressEvent();
+    if (IsLayoutInProgress())
+        wxWakeUpIdle();
+    return rval;
+}
+
+
+bool wxPyHtmlWindow::AppendToPage(const wxString& source)
+{
+    // The parser only knows the last piece of a progressive page, so the
+    // appended source must be laid out as more pieces instead.  Otherwise
+    // wxHtmlWindow sets the whole page again, and SetPage prefetches it.
+    if (!m_progressivePage || !m_Cell)
+        return wxHtmlWindow::AppendToPage(source);
+    PrefetchURLs(source);
+
+    bool loading = IsLayoutInProgress();
+    if (!loading) {
+        m_chunks.Clear();
+        m_nextChunk = 0;
+        m_progressiveDone = m_progressiveTotal = 0;
+    }
+    wxPyHtmlSplitSource(source, wxPY_HTML_CHUNK_SIZE, m_chunks);
+    m_progressiveTotal += source.length();
+
+    // Only defer behind a load that is still going, otherwise show the
+    // first piece now like wxHtmlWindow would and leave the rest for idle.
+    if (!loading && IsLayoutInProgress()) {
+        LayoutChunks(0);
+        SendProgressEvent();
+    }
+    if (IsLayoutInProgress())
+        wxWakeUpIdle();
+    return true;
+}
+
+
+void wxPyHtmlWindow::CancelProgressiveLayout()
+{
+    m_chunks.Clear();
+    m_nextChunk = 0;
+    m_progressiveCell = NULL;
+    m_progressivePage = false;
+    m_lastChunk.clear();
+    m_progressiveDone = m_progressiveTotal = 0;
+}
+
+
+// Parse and lay out the next pieces for about the given time, always doing
+// at least one. Returns true if any were done.
+bool wxPyHtmlWindow::LayoutChunks(long millis)
+{
+    // Something else may have replaced the page behind our back.
+    if (m_Cell != m_progressiveCell || !m_Parser ||
+        *m_Parser->GetSource() != m_lastChunk) {
+        CancelProgressiveLayout();
+        return false;
+    }
+
+    wxStopWatch sw;
+    wxClientDC dc(this);
+    dc.SetMapMode(wxMM_TEXT);
+    m_Parser->SetDC(&dc);
+    // the width the root gives its children, see wxHtmlContainerCell::Layout
+    int width = GetClientSize().GetWidth() -
+                m_Cell->GetIndent(wxHTML_INDENT_LEFT) -
+                m_Cell->GetIndent(wxHTML_INDENT_RIGHT);
+    while (IsLayoutInProgress()) {
+        const wxString& chunk = m_chunks[m_nextChunk++];
+        wxHtmlContainerCell* cell = (wxHtmlContainerCell*)m_Parser->Parse(chunk);
+        if (!cell) {
+            // the parser gave up, the rest can't be shown either
+            CancelProgressiveLayout();
+            break;
+        }
+        // Lay out the new piece here so its time counts in the slice.  The
+        // pieces already shown keep their layout, so CreateLayout below only
+        // has to place the root's children one under the other.
+        cell->Layout(width);
+        m_Cell->InsertCell(cell);
+        m_lastChunk = *m_Parser->GetSource();
+        m_progressiveDone += chunk.length();
+        if (sw.Time() >= millis)
+            break;
+    }
+
+    if (!IsLayoutInProgress()) {
+        m_chunks.Clear();
+        m_nextChunk = 0;
+    }
+
+    CreateLayout();
+    Refresh();
+    return true;
+}
+
+
+void wxPyHtmlWindow::SendProgressEvent()
+{
+    wxCommandEvent event(wxEVT_COMMAND_HTML_PAGE_PROGRESS, GetId());
+    event.SetEventObject(this);
+    // The pieces repeat the tags that are open where they were split, so
+    // they add up to more than the source.  Only the end makes it 100.
+    if (IsLayoutInProgress() && m_progressiveTotal)
+        event.SetInt(wxMin(99, (int)(100.0 * m_progressiveDone / m_progressiveTotal)));
+    else
+        event.SetInt(100);
+    GetEventHandler()->ProcessEvent(event);
+}
+
+
+void wxPyHtmlWindow::OnProgressiveIdle(wxIdleEvent& event)
+{
+    if (IsLayoutInProgress() && LayoutChunks(m_progressiveSlice)) {
+        SendProgressEvent();
+        if (IsLayoutInProgress())
+            event.RequestMore();
+    }
+    event.Skip();
+}
 IMP_PYCALLBACK__STRING(wxPyHtmlWindow, wxHtmlWindow, OnSetTitle);
 IMP_PYCALLBACK__CELLINTINT(wxPyHtmlWindow, wxHtmlWindow, OnCellMouseHover);
 IMP_PYCALLBACK_BOOL_CELLINTINTME(wxPyHtmlWindow, wxHtmlWindow, OnCellClicked);
@@ -971,39 +1530,118 @@ void wxPyHtmlWindow::OnLinkClicked(const wxHtmlLinkInfo& link) {
 }
 
 
+// The answers are looked up in those given by OnOpeningURLs for the
+// current page, then in the cache, before asking OnOpeningURL.  Both are
+// keyed by the resolved URL, as PrefetchURLs has it, whether the parser
+// passes url resolved or as written in the page.
 wxHtmlOpeningStatus wxPyHtmlWindow::OnOpeningURL(wxHtmlURLType type,
                                                  const wxString& url,
                                                  wxString *redirect) const {
+    wxString key = wxPyHtmlURLKey(type, wxPyHtmlResolveURL(url, m_Parser ? m_Parser->GetFS() : NULL));
+    wxPyHtmlURLDecisionMap::const_iterator it = m_prefetchedURLs.find(key);
+    if (it == m_prefetchedURLs.end() && m_urlCacheTimeout != 0) {
+        it = m_urlCache.find(key);
+        if (it != m_urlCache.end() && m_urlCacheTimeout > 0 &&
+            wxGetLocalTimeMillis() - it->second.m_time > m_urlCacheTimeout) {
+            m_urlCache.erase(key);
+            it = m_urlCache.end();
+        }
+        if (it == m_urlCache.end())
+            it = m_prefetchedURLs.end();
+    }
+    if (it != m_prefetchedURLs.end()) {
+        if (it->second.m_status == wxHTML_REDIRECT)
+            *redirect = it->second.m_redirect;
+        return it->second.m_status;
+    }
+
     bool found;
-    wxHtmlOpeningStatus rval;
+    bool ok = true;
+    wxHtmlOpeningStatus rval = wxHTML_OPEN;
     wxPyBlock_t blocked = wxPyBeginBlockThreads();
     if ((found = wxPyCBH_findCallback(m_myInst, "OnOpeningURL"))) {
         PyObject* ro;
         PyObject* s = wx2PyString(url);
         ro = wxPyCBH_callCallbackObj(m_myInst, Py_BuildValue("(iO)", type, s));
         Py_DECREF(s);
-        if (PyString_Check(ro)
-#if PYTHON_API_VERSION >= 1009
-            || PyUnicode_Check(ro)
-#endif
-            ) {
-            *redirect = Py2wxString(ro);
-            rval = wxHTML_REDIRECT;
-        }
-        else {
-            PyObject* num = PyNumber_Int(ro);
-            rval = (wxHtmlOpeningStatus)PyInt_AsLong(num);
-            Py_DECREF(num);
-        }
-        Py_DECREF(ro);
+        ok = wxPyHtmlConvertURLStatus(ro, &rval, redirect);
+        Py_XDECREF(ro);
     }
     wxPyEndBlockThreads(blocked);
     if (! found)
         rval = wxHtmlWindow::OnOpeningURL(type, url, redirect);
+    if (ok && m_urlCacheTimeout != 0)
+        m_urlCache[key] = wxPyHtmlURLDecision(rval, *redirect);
     return rval;
 }
 
 
+// Give all the image URLs of the source to OnOpeningURLs at once, if it is
+// overridden, and keep the answers for when the parser asks about them.
+void wxPyHtmlWindow::PrefetchURLs(const wxString& source)
+{
+    wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    if (!wxPyCBH_findCallback2(m_myInst, "OnOpeningURLs", false)) {
+        wxPyEndBlockThreads(blocked);
+        return;
+    }
+    wxPyEndBlockThreads(blocked);
+
+    wxArrayString found;
+    wxPyHtmlFindImageURLs(source, found);
+
+    wxArrayString urls;
+    for (size_t i = 0; i < found.GetCount(); i++) {
+        wxString url = wxPyHtmlResolveURL(found[i], m_Parser ? m_Parser->GetFS() : NULL);
+        wxString key = wxPyHtmlURLKey(wxHTML_URL_IMAGE, url);
+        if (m_prefetchedURLs.find(key) == m_prefetchedURLs.end()) {
+            // a placeholder until the answer is known, to skip duplicates
+            m_prefetchedURLs[key] = wxPyHtmlURLDecision();
+            urls.Add(url);
+        }
+    }
+    if (urls.IsEmpty())
+        return;
+
+    bool ok = false;
+    blocked = wxPyBeginBlockThreads();
+    if (wxPyCBH_findCallback(m_myInst, "OnOpeningURLs")) {
+        PyObject* list = PyList_New(urls.GetCount());
+        for (size_t i = 0; i < urls.GetCount(); i++)
+            PyList_SET_ITEM(list, i, Py_BuildValue("(iN)", wxHTML_URL_IMAGE,
+                                                   wx2PyString(urls[i])));
+        PyObject* ro = wxPyCBH_callCallbackObj(m_myInst, Py_BuildValue("(N)", list));
+        if (ro && PySequence_Check(ro) &&
+            (size_t)PySequence_Length(ro) == urls.GetCount()) {
+            ok = true;
+            for (size_t i = 0; i < urls.GetCount(); i++) {
+                PyObject* item = PySequence_GetItem(ro, i);
+                wxHtmlOpeningStatus status;
+                wxString redirect;
+                wxString key = wxPyHtmlURLKey(wxHTML_URL_IMAGE, urls[i]);
+                if (wxPyHtmlConvertURLStatus(item, &status, &redirect))
+                    m_prefetchedURLs[key] = wxPyHtmlURLDecision(status, redirect);
+                else
+                    m_prefetchedURLs.erase(key);
+                Py_XDECREF(item);
+            }
+        }
+        else
+            PyErr_SetString(PyExc_TypeError,
+                            "OnOpeningURLs should return a sequence with one item per URL");
+        Py_XDECREF(ro);
+        if (PyErr_Occurred())
+            PyErr_Print();
+    }
+    wxPyEndBlockThreads(blocked);
+
+    if (!ok) {
+        for (size_t i = 0; i < urls.GetCount(); i++)
+            m_prefetchedURLs.erase(wxPyHtmlURLKey(wxHTML_URL_IMAGE, urls[i]));
+    }
+}
+
+
 %}
 
 
@@ -1063,6 +1701,59 @@ public:
     // Append to current page
     bool AppendToPage(const wxString& source);
 
+    DocDeclStr(
+        void , SetProgressiveLayout(int sliceMillis),
+        "Makes SetPage, LoadPage and AppendToPage lay out big pages
+progressively when sliceMillis is greater than zero.  The page is then
+split in pieces between block elements, also inside big elements:
+lists are split before an item and preformatted text between lines,
+but tables are never split.  Enough pieces to fill the window are shown right
+away, and the rest are parsed and laid out in idle time, at most about
+sliceMillis milliseconds at a time.  Setting another page cancels the
+layout of the rest of the previous one.  When no page is loading,
+AppendToPage shows the first piece of the new source right away too.
+EVT_HTML_PAGE_PROGRESS events report the percentage done.
+
+Each piece reopens the elements that were open where it was split, and
+repeats the body tag, so their attributes still apply.", "");
+
+    DocDeclStr(
+        int , GetProgressiveLayout() const,
+        "Returns the time slice set with `SetProgressiveLayout`, or 0.", "");
+
+    DocDeclStr(
+        bool , IsLayoutInProgress() const,
+        "Returns True while parts of a progressively set page are still
+waiting to be laid out.", "");
+
+    DocDeclStr(
+        void , CancelProgressiveLayout(),
+        "Stops laying out the rest of a progressively set page, keeping what
+is already shown.", "");
+
+    DocDeclStr(
+        void , SetURLCacheTimeout(int millis),
+        "Makes the window remember what `OnOpeningURL` returned for each URL
+type and URL for millis milliseconds, or until `ClearURLCache` is
+called if millis is -1.  The default of 0 asks OnOpeningURL every time.
+
+Independently of this, if the derived class has an OnOpeningURLs
+method it is called once by SetPage and AppendToPage, with a list of
+(type, url) tuples for all the images of the page.  It should return a
+list with the OnOpeningURL result for each of them, which are then used
+while that page is parsed.  Only images are prefetched, that is the src
+of img tags and the background attributes, with the URLs made absolute
+against the page's location.  Other URLs, such as the pages opened by
+`LoadPage`, still go to OnOpeningURL one at a time.", "");
+
+    DocDeclStr(
+        int , GetURLCacheTimeout() const,
+        "", "");
+
+    DocDeclStr(
+        void , ClearURLCache(),
+        "Forgets the remembered `OnOpeningURL` results.", "");
+
      // Returns full location of opened page
     wxString GetOpenedPage();
 
@@ -1609,6 +2300,7 @@ public:
 %constant wxEventType wxEVT_COMMAND_HTML_CELL_CLICKED;
 %constant wxEventType wxEVT_COMMAND_HTML_CELL_HOVER;
 %constant wxEventType wxEVT_COMMAND_HTML_LINK_CLICKED;
+%constant wxEventType wxEVT_COMMAND_HTML_PAGE_PROGRESS;
 
 
 class wxHtmlCellEvent : public wxCommandEvent
@@ -1640,6 +2332,7 @@ public:
     EVT_HTML_CELL_CLICKED = wx.PyEventBinder( wxEVT_COMMAND_HTML_CELL_CLICKED, 1 )
     EVT_HTML_CELL_HOVER   = wx.PyEventBinder( wxEVT_COMMAND_HTML_CELL_HOVER, 1 )
     EVT_HTML_LINK_CLICKED = wx.PyEventBinder( wxEVT_COMMAND_HTML_LINK_CLICKED, 1 )
+    EVT_HTML_PAGE_PROGRESS = wx.PyEventBinder( wxEVT_COMMAND_HTML_PAGE_PROGRESS, 1 )
 }
         
 //---------------------------------------------------------------------------
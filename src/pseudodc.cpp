@@ -16,6 +16,7 @@
 #include <Python.h>
 #include "wx/wxPython/wxPython.h"
 #include "wx/wxPython/pseudodc.h"
+#include <wx/math.h>
 
 // wxList based class definitions
 #include <wx/listimpl.cpp>
@@ -105,6 +106,177 @@ wxBitmap &GetGreyBitmap(wxBitmap &bmp)
     return rval;
 }
 
+// ============================================================================
+// pdcPlayback implementation
+// ============================================================================
+pdcPlayback::pdcPlayback(wxDC *dc, wxGraphicsContext *gc)
+{
+    m_dc = dc;
+    Reset();
+    m_gc = gc;
+    m_lineCount = 0;
+    m_rectCount = 0;
+#if wxUSE_GRAPHICS_CONTEXT
+    m_lineBegin = NULL;
+    m_lineEnd = NULL;
+    m_lineSize = 0;
+#endif
+}
+
+pdcPlayback::~pdcPlayback()
+{
+    Flush();
+#if wxUSE_GRAPHICS_CONTEXT
+    delete [] m_lineBegin;
+    delete [] m_lineEnd;
+#endif
+}
+
+void pdcPlayback::Reset()
+{
+    m_pen = m_dc->GetPen();
+    m_brush = m_dc->GetBrush();
+    m_font = m_dc->GetFont();
+}
+
+// ----------------------------------------------------------------------------
+// SetPen, SetBrush, SetFont - select into the dc unless already selected.
+//                             What is pending was drawn with the old ones.
+// ----------------------------------------------------------------------------
+void pdcPlayback::SetPen(const wxPen& pen)
+{
+    if (pen == m_pen)
+        return;
+    Flush();
+    m_pen = pen;
+    m_dc->SetPen(pen);
+}
+
+void pdcPlayback::SetBrush(const wxBrush& brush)
+{
+    if (brush == m_brush)
+        return;
+    Flush();
+    m_brush = brush;
+    m_dc->SetBrush(brush);
+}
+
+void pdcPlayback::SetFont(const wxFont& font)
+{
+    if (font == m_font)
+        return;
+    Flush();
+    m_font = font;
+    m_dc->SetFont(font);
+}
+
+// ----------------------------------------------------------------------------
+// DrawLine, DrawRectangle - add to the pending run, or draw to the dc when
+//                           there is no graphics context or it could not
+//                           draw them the same way
+// ----------------------------------------------------------------------------
+void pdcPlayback::DrawLine(wxCoord x1, wxCoord y1, wxCoord x2, wxCoord y2)
+{
+#if wxUSE_GRAPHICS_CONTEXT
+    if (m_gc && m_dc->GetLogicalFunction() == wxCOPY)
+    {
+        if (m_rectCount)
+            FlushRects();
+        if (m_lineCount == m_lineSize)
+        {
+            size_t size = m_lineSize ? 2*m_lineSize : 64;
+            wxPoint2DDouble *begin = new wxPoint2DDouble[size];
+            wxPoint2DDouble *end = new wxPoint2DDouble[size];
+            for (size_t i=0; i<m_lineCount; i++)
+            {
+                begin[i] = m_lineBegin[i];
+                end[i] = m_lineEnd[i];
+            }
+            delete [] m_lineBegin;
+            delete [] m_lineEnd;
+            m_lineBegin = begin;
+            m_lineEnd = end;
+            m_lineSize = size;
+        }
+        m_lineBegin[m_lineCount] = wxPoint2DDouble(x1, y1);
+        m_lineEnd[m_lineCount] = wxPoint2DDouble(x2, y2);
+        m_lineCount += 1;
+        m_dc->CalcBoundingBox(x1, y1);
+        m_dc->CalcBoundingBox(x2, y2);
+        return;
+    }
+#endif
+    GetDC()->DrawLine(x1, y1, x2, y2);
+}
+
+void pdcPlayback::DrawRectangle(wxCoord x, wxCoord y, wxCoord w, wxCoord h)
+{
+#if wxUSE_GRAPHICS_CONTEXT
+    if (m_gc && m_dc->GetLogicalFunction() == wxCOPY)
+    {
+        if (m_lineCount)
+            FlushLines();
+        if (w == 0 || h == 0)
+            return;
+        // what the outline covers, half of the pen is outside the rectangle.
+        // wxRect needs a positive size.  A negative one is drawn reaching a
+        // pixel further with the adjustment below, so that pixel is included;
+        // a bound that is too big only costs an early flush.
+        wxRect rect(x, y, w, h);
+        if (rect.width < 0)
+        {
+            rect.x += rect.width - 1;
+            rect.width = 1 - rect.width;
+        }
+        if (rect.height < 0)
+        {
+            rect.y += rect.height - 1;
+            rect.height = 1 - rect.height;
+        }
+        if (m_pen.IsOk() && m_pen.GetStyle() != wxPENSTYLE_TRANSPARENT)
+            rect.Inflate((wxMax(m_pen.GetWidth(), 1) + 1) / 2);
+        // A filled rectangle has to cover the ones drawn before it, which
+        // one path filled and stroked at once would not do
+        if (m_rectCount && !m_brush.IsTransparent() && rect.Intersects(m_rectBounds))
+            FlushRects();
+        if (m_rectCount == 0)
+        {
+            m_rects = m_gc->CreatePath();
+            m_rectBounds = rect;
+        }
+        else
+            m_rectBounds.Union(rect);
+        // the same adjustment as wxGCDC::DrawRectangle makes
+        if (m_gc->ShouldOffset())
+            m_rects.AddRectangle(x, y, w-1, h-1);
+        else
+            m_rects.AddRectangle(x, y, w, h);
+        m_rectCount += 1;
+        m_dc->CalcBoundingBox(x, y);
+        m_dc->CalcBoundingBox(x + w, y + h);
+        return;
+    }
+#endif
+    GetDC()->DrawRectangle(x, y, w, h);
+}
+
+void pdcPlayback::FlushLines()
+{
+#if wxUSE_GRAPHICS_CONTEXT
+    m_gc->StrokeLines(m_lineCount, m_lineBegin, m_lineEnd);
+#endif
+    m_lineCount = 0;
+}
+
+void pdcPlayback::FlushRects()
+{
+#if wxUSE_GRAPHICS_CONTEXT
+    m_gc->DrawPath(m_rects, wxWINDING_RULE);
+    m_rects = wxNullGraphicsPath;
+#endif
+    m_rectCount = 0;
+}
+
 // ============================================================================
 // various pdcOp class implementation methods
 // ============================================================================
@@ -228,6 +400,300 @@ pdcDrawSplineOp::~pdcDrawSplineOp()
 }
 #endif // wxUSE_SPLINES
 
+// ============================================================================
+// pdcHitTest implementation
+// ============================================================================
+pdcHitTest::pdcHitTest(wxCoord x, wxCoord y, wxCoord radius, const wxColour& bg)
+    : m_x(x), m_y(y), m_bg(bg), m_bgpen(bg), m_bgbrush(bg), m_dc(NULL)
+{
+    // with no radius the pixel at (x,y) is looked at, which is within
+    // half a pixel of the point
+    m_tolerance = radius > 0 ? radius : 0.5;
+    Reset();
+}
+
+bool pdcHitTest::IsStroked()
+{
+    return m_pen.IsOk() && m_pen.GetStyle() != wxPENSTYLE_TRANSPARENT &&
+           m_pen.GetColour() != m_bg;
+}
+
+bool pdcHitTest::IsFilled()
+{
+    return m_brush.IsOk() && !m_brush.IsTransparent() &&
+           m_brush.GetColour() != m_bg;
+}
+
+// ----------------------------------------------------------------------------
+// GetTextExtent - the size of text drawn with the current font
+// ----------------------------------------------------------------------------
+void pdcHitTest::GetTextExtent(const wxString& text, wxCoord *w, wxCoord *h)
+{
+    if (!m_dc)
+        m_dc = new wxMemoryDC;
+    m_dc->SetFont(m_font.IsOk() ? m_font : *wxNORMAL_FONT);
+    m_dc->GetMultiLineTextExtent(text, w, h);
+}
+
+// ----------------------------------------------------------------------------
+// Geometry used by the ops' HitTest
+// ----------------------------------------------------------------------------
+// Points are the centres of pixels.  A DC draws a w by h shape at (x,y) on
+// the pixels from x to x+w-1 and from y to y+h-1, so this is the extent of
+// the shape in points, with negative sizes made positive.
+static void pdcPixelExtent(double& x, double& y, double& w, double& h)
+{
+    if (w < 0) {x += w; w = -w;}
+    if (h < 0) {y += h; h = -h;}
+    w = wxMax(w - 1, 0.0);
+    h = wxMax(h - 1, 0.0);
+}
+
+// distance from (px,py) to the segment from (x1,y1) to (x2,y2)
+static double pdcSegmentDistance(double px, double py,
+                                 double x1, double y1, double x2, double y2)
+{
+    double dx = x2-x1, dy = y2-y1;
+    double len2 = dx*dx + dy*dy;
+    double t = len2 > 0 ? ((px-x1)*dx + (py-y1)*dy) / len2 : 0;
+    if (t < 0) t = 0;
+    else if (t > 1) t = 1;
+    double ex = x1 + t*dx - px, ey = y1 + t*dy - py;
+    return sqrt(ex*ex + ey*ey);
+}
+
+// distance from (px,py) to the lines joining n points, and back to the
+// first point if closed
+static double pdcPolylineDistance(double px, double py, int n, wxPoint *points,
+                                  wxCoord xoff, wxCoord yoff, bool closed)
+{
+    if (n == 1)
+        closed = true;
+    double d = -1;
+    for (int i = closed ? 0 : 1; i < n; i++)
+    {
+        int j = i > 0 ? i-1 : n-1;
+        double dd = pdcSegmentDistance(px, py,
+                                       points[j].x+xoff, points[j].y+yoff,
+                                       points[i].x+xoff, points[i].y+yoff);
+        if (d < 0 || dd < d)
+            d = dd;
+    }
+    return d;
+}
+
+// add the winding number of the ring of n points around (px,py), and the
+// number of its edges a ray from (px,py) crosses
+static void pdcRingWinding(double px, double py, int n, wxPoint *points,
+                           wxCoord xoff, wxCoord yoff, int *winding, int *crossings)
+{
+    for (int i = 0, j = n-1; i < n; j = i++)
+    {
+        double xi = points[i].x+xoff, yi = points[i].y+yoff;
+        double xj = points[j].x+xoff, yj = points[j].y+yoff;
+        if ((yi > py) != (yj > py) && px < xj + (py-yj)*(xi-xj)/(yi-yj))
+        {
+            *crossings += 1;
+            *winding += yi > yj ? 1 : -1;
+        }
+    }
+}
+
+// signed distance from (px,py) to a rectangle with corners rounded with
+// radius r, negative inside it
+static double pdcRoundedRectDistance(double px, double py, double x, double y,
+                                     double w, double h, double r)
+{
+    pdcPixelExtent(x, y, w, h);
+    r = wxMin(wxMax(r, 0.0), wxMin(w, h)/2);
+    double qx = fabs(px - (x + w/2)) - (w/2 - r);
+    double qy = fabs(py - (y + h/2)) - (h/2 - r);
+    double ox = wxMax(qx, 0.0), oy = wxMax(qy, 0.0);
+    return sqrt(ox*ox + oy*oy) + wxMin(wxMax(qx, qy), 0.0) - r;
+}
+
+// signed distance from (px,py) to the ellipse in a rectangle, negative
+// inside it.  This is the usual first order approximation, good enough
+// near the outline, which is all that is asked of it
+static double pdcEllipseDistance(double px, double py, double x, double y,
+                                 double w, double h)
+{
+    pdcPixelExtent(x, y, w, h);
+    double a = w/2, b = h/2;
+    if (a == 0 || b == 0)
+        return pdcSegmentDistance(px, py, x, y, x+w, y+h);
+    double dx = px - (x+a), dy = py - (y+b);
+    double k0 = sqrt((dx*dx)/(a*a) + (dy*dy)/(b*b));
+    double k1 = sqrt((dx*dx)/(a*a*a*a) + (dy*dy)/(b*b*b*b));
+    if (k1 == 0)
+        return -wxMin(a, b);
+    return k0*(k0-1)/k1;
+}
+
+// whether a shape at signed distance d from the point, filled with the
+// current brush and outlined with the current pen, draws near it
+static pdcHitResult pdcShapeHit(pdcHitTest& ht, double d)
+{
+    if (ht.IsFilled() && d <= ht.GetTolerance())
+        return pdcHIT_FOUND;
+    if (ht.IsStroked() && fabs(d) <= ht.GetStrokeTolerance())
+        return pdcHIT_FOUND;
+    return pdcHIT_NONE;
+}
+
+// whether text with its top left corner at (x,y) rotated by angle degrees
+// anticlockwise covers the point
+static pdcHitResult pdcTextHit(pdcHitTest& ht, const wxString& text,
+                               wxCoord x, wxCoord y, double angle)
+{
+    wxCoord w, h;
+    ht.GetTextExtent(text, &w, &h);
+    double rad = angle * M_PI / 180.0;
+    double c = cos(rad), s = sin(rad);
+    double dx = ht.GetX() - x, dy = ht.GetY() - y;
+    // the point in the coordinates of the text
+    double u = dx*c - dy*s;
+    double v = dx*s + dy*c;
+    double tol = ht.GetTolerance();
+    if (u >= -tol && u <= w-1+tol && v >= -tol && v <= h-1+tol)
+        return pdcHIT_FOUND;
+    return pdcHIT_NONE;
+}
+
+// ----------------------------------------------------------------------------
+// HitTest - whether the op draws anything near the point
+// ----------------------------------------------------------------------------
+pdcHitResult pdcDrawPointOp::HitTest(pdcHitTest& ht)
+{
+    // DrawPoint sets one pixel whatever the width of the pen
+    double dx = ht.GetX() - m_x, dy = ht.GetY() - m_y;
+    if (ht.IsStroked() && sqrt(dx*dx + dy*dy) <= ht.GetTolerance())
+        return pdcHIT_FOUND;
+    return pdcHIT_NONE;
+}
+
+pdcHitResult pdcDrawLineOp::HitTest(pdcHitTest& ht)
+{
+    if (ht.IsStroked() &&
+        pdcSegmentDistance(ht.GetX(), ht.GetY(), m_x1, m_y1, m_x2, m_y2) <= ht.GetStrokeTolerance())
+        return pdcHIT_FOUND;
+    return pdcHIT_NONE;
+}
+
+pdcHitResult pdcCrossHairOp::HitTest(pdcHitTest& ht)
+{
+    double tol = ht.GetStrokeTolerance();
+    if (ht.IsStroked() &&
+        (fabs(ht.GetX() - m_x) <= tol || fabs(ht.GetY() - m_y) <= tol))
+        return pdcHIT_FOUND;
+    return pdcHIT_NONE;
+}
+
+pdcHitResult pdcDrawLinesOp::HitTest(pdcHitTest& ht)
+{
+    if (m_n > 0 && ht.IsStroked() &&
+        pdcPolylineDistance(ht.GetX(), ht.GetY(), m_n, m_points,
+                            m_xoffset, m_yoffset, false) <= ht.GetStrokeTolerance())
+        return pdcHIT_FOUND;
+    return pdcHIT_NONE;
+}
+
+pdcHitResult pdcDrawPolygonOp::HitTest(pdcHitTest& ht)
+{
+    if (m_n <= 0)
+        return pdcHIT_NONE;
+    double px = ht.GetX(), py = ht.GetY();
+    if (ht.IsFilled())
+    {
+        int winding = 0, crossings = 0;
+        pdcRingWinding(px, py, m_n, m_points, m_xoffset, m_yoffset,
+                       &winding, &crossings);
+        if (m_fillStyle == wxODDEVEN_RULE ? (crossings & 1) : winding != 0)
+            return pdcHIT_FOUND;
+    }
+    double d = pdcPolylineDistance(px, py, m_n, m_points, m_xoffset, m_yoffset, true);
+    if ((ht.IsFilled() && d <= ht.GetTolerance()) ||
+        (ht.IsStroked() && d <= ht.GetStrokeTolerance()))
+        return pdcHIT_FOUND;
+    return pdcHIT_NONE;
+}
+
+pdcHitResult pdcDrawPolyPolygonOp::HitTest(pdcHitTest& ht)
+{
+    double px = ht.GetX(), py = ht.GetY();
+    int winding = 0, crossings = 0;
+    double d = -1;
+    wxPoint *ring = m_points;
+    for (int i = 0; i < m_n; i++)
+    {
+        if (m_count[i] > 0)
+        {
+            pdcRingWinding(px, py, m_count[i], ring, m_xoffset, m_yoffset,
+                           &winding, &crossings);
+            double dd = pdcPolylineDistance(px, py, m_count[i], ring,
+                                            m_xoffset, m_yoffset, true);
+            if (d < 0 || dd < d)
+                d = dd;
+        }
+        ring += m_count[i];
+    }
+    if (d < 0)
+        return pdcHIT_NONE;
+    if (ht.IsFilled() &&
+        ((m_fillStyle == wxODDEVEN_RULE ? (crossings & 1) : winding != 0) ||
+         d <= ht.GetTolerance()))
+        return pdcHIT_FOUND;
+    if (ht.IsStroked() && d <= ht.GetStrokeTolerance())
+        return pdcHIT_FOUND;
+    return pdcHIT_NONE;
+}
+
+pdcHitResult pdcDrawRectangleOp::HitTest(pdcHitTest& ht)
+{
+    return pdcShapeHit(ht, pdcRoundedRectDistance(ht.GetX(), ht.GetY(),
+                                                  m_x, m_y, m_w, m_h, 0));
+}
+
+pdcHitResult pdcDrawRoundedRectangleOp::HitTest(pdcHitTest& ht)
+{
+    // a negative radius is a proportion of the smaller side
+    double r = m_r;
+    if (r < 0)
+        r = -r * wxMin(abs(m_w), abs(m_h));
+    return pdcShapeHit(ht, pdcRoundedRectDistance(ht.GetX(), ht.GetY(),
+                                                  m_x, m_y, m_w, m_h, r));
+}
+
+pdcHitResult pdcDrawEllipseOp::HitTest(pdcHitTest& ht)
+{
+    return pdcShapeHit(ht, pdcEllipseDistance(ht.GetX(), ht.GetY(),
+                                              m_x, m_y, m_w, m_h));
+}
+
+pdcHitResult pdcDrawTextOp::HitTest(pdcHitTest& ht)
+{
+    return pdcTextHit(ht, m_text, m_x, m_y, 0);
+}
+
+pdcHitResult pdcDrawRotatedTextOp::HitTest(pdcHitTest& ht)
+{
+    return pdcTextHit(ht, m_text, m_x, m_y, m_angle);
+}
+
+pdcHitResult pdcDrawBitmapOp::HitTest(pdcHitTest& ht)
+{
+    // only the pixels tell which parts of a masked or transparent
+    // bitmap are drawn
+    if ((m_useMask && m_bmp.GetMask()) || m_bmp.HasAlpha())
+        return pdcHIT_UNKNOWN;
+    double tol = ht.GetTolerance();
+    double px = ht.GetX(), py = ht.GetY();
+    if (px >= m_x - tol && px <= m_x + m_bmp.GetWidth() - 1 + tol &&
+        py >= m_y - tol && py <= m_y + m_bmp.GetHeight() - 1 + tol)
+        return pdcHIT_FOUND;
+    return pdcHIT_NONE;
+}
+
 // ============================================================================
 // pdcObject implementation
 // ============================================================================
@@ -244,6 +710,36 @@ void pdcObject::DrawToDC(wxDC *dc)
     }
 }
 
+// ----------------------------------------------------------------------------
+// Play - play back the op list through a pdcPlayback
+// ----------------------------------------------------------------------------
+void pdcObject::Play(pdcPlayback& pb)
+{
+    pdcOpList::compatibility_iterator node = m_oplist.GetFirst(); 
+    while(node)
+    {
+        node->GetData()->Play(pb, m_greyedout);
+        node = node->GetNext();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// HitTest - whether the op list draws anything near the point of ht
+// ----------------------------------------------------------------------------
+pdcHitResult pdcObject::HitTest(pdcHitTest& ht)
+{
+    ht.Reset();
+    pdcOpList::compatibility_iterator node = m_oplist.GetFirst(); 
+    while(node)
+    {
+        pdcHitResult hit = node->GetData()->HitTest(ht);
+        if (hit != pdcHIT_NONE)
+            return hit;
+        node = node->GetNext();
+    }
+    return pdcHIT_NONE;
+}
+
 // ----------------------------------------------------------------------------
 // Translate - translate all the operations by some dx,dy
 // ----------------------------------------------------------------------------
@@ -260,6 +756,13 @@ void pdcObject::Translate(wxCoord dx, wxCoord dy)
         m_bounds.x += dx;
         m_bounds.y += dy;
     }
+    // the bitmap moves with the bounds as long as it moves by whole pixels
+    if (m_cacheBitmap.IsOk())
+    {
+        double x = dx*m_cacheScaleX, y = dy*m_cacheScaleY;
+        if (x != floor(x) || y != floor(y))
+            InvalidateCache();
+    }
 }
 
 // ----------------------------------------------------------------------------
@@ -268,6 +771,8 @@ void pdcObject::Translate(wxCoord dx, wxCoord dy)
 // ----------------------------------------------------------------------------
 void pdcObject::SetGreyedOut(bool greyout) 
 {
+    if (greyout != m_greyedout)
+        InvalidateCache();
     m_greyedout=greyout;
     if (greyout)
     {
@@ -282,6 +787,194 @@ void pdcObject::SetGreyedOut(bool greyout)
     }
 }
 
+// ============================================================================
+// pdcBitmapCache implementation
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// Draw - draw obj from its bitmap, then select what its ops would have
+//        selected so the objects after it draw the same
+// ----------------------------------------------------------------------------
+bool pdcBitmapCache::Draw(pdcObject *obj, wxDC *dc)
+{
+    if (!obj->IsCacheable())
+        return false;
+
+    double ux, uy, lx, ly;
+    dc->GetUserScale(&ux, &uy);
+    dc->GetLogicalScale(&lx, &ly);
+    double sx = ux*lx, sy = uy*ly;
+    // ops drawn to a wxGCDC are antialiased, so they are rasterized
+    // through one as well when dc is one
+#if wxUSE_GRAPHICS_CONTEXT
+    bool gc = wxDynamicCast(dc, wxGCDC) != NULL;
+#else
+    bool gc = false;
+#endif
+    if (obj->m_cacheBitmap.IsOk() && 
+        (sx != obj->m_cacheScaleX || sy != obj->m_cacheScaleY ||
+         gc != obj->m_cacheGC))
+        Release(obj);
+    if (!obj->m_cacheBitmap.IsOk())
+    {
+        if (!Rasterize(obj, sx, sy, gc))
+            return false;
+    }
+    else if (obj != m_first)
+    {
+        Unlink(obj);
+        Link(obj);
+    }
+
+    if (sx == 1.0 && sy == 1.0)
+        dc->DrawBitmap(obj->m_cacheBitmap, obj->m_bounds.x, obj->m_bounds.y, true);
+    else
+    {
+        // the bitmap is already at the dc's scale, so draw it unscaled
+        wxCoord x = dc->LogicalToDeviceX(obj->m_bounds.x);
+        wxCoord y = dc->LogicalToDeviceY(obj->m_bounds.y);
+        dc->SetUserScale(1.0, 1.0);
+        dc->SetLogicalScale(1.0, 1.0);
+        dc->DrawBitmap(obj->m_cacheBitmap, dc->DeviceToLogicalX(x),
+                       dc->DeviceToLogicalY(y), true);
+        dc->SetLogicalScale(lx, ly);
+        dc->SetUserScale(ux, uy);
+    }
+
+    for (size_t i=0; i<obj->m_cacheStateOps.GetCount(); i++)
+        ((pdcOp*)obj->m_cacheStateOps[i])->DrawToDC(dc, obj->m_greyedout);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Rasterize - draw the ops of obj into a bitmap with an alpha channel.  The
+//             ops are drawn once over black and once over white, and how
+//             much of the background shows through each pixel gives its
+//             alpha.  This works with any kind of dc and antialiasing.
+// ----------------------------------------------------------------------------
+static void pdcRasterizeTo(pdcObject *obj, wxDC *dc, double sx, double sy)
+{
+    dc->SetUserScale(sx, sy);
+    dc->SetDeviceOrigin(-(wxCoord)floor(obj->GetBounds().x*sx + 0.5),
+                        -(wxCoord)floor(obj->GetBounds().y*sy + 0.5));
+    obj->DrawToDC(dc);
+}
+
+static wxImage pdcRasterizeOver(pdcObject *obj, int w, int h, double sx,
+                                double sy, bool gc, const wxColour& bg)
+{
+    wxBitmap bmp(w, h, 24);
+    wxMemoryDC memdc;
+    memdc.SelectObject(bmp);
+    memdc.SetBackground(wxBrush(bg));
+    memdc.Clear();
+#if wxUSE_GRAPHICS_CONTEXT
+    if (gc)
+    {
+        wxGCDC gcdc(memdc);
+        pdcRasterizeTo(obj, &gcdc, sx, sy);
+    }
+    else
+#else
+    wxUnusedVar(gc);
+#endif
+        pdcRasterizeTo(obj, &memdc, sx, sy);
+    memdc.SelectObject(wxNullBitmap);
+    return bmp.ConvertToImage();
+}
+
+bool pdcBitmapCache::Rasterize(pdcObject *obj, double sx, double sy, bool gc)
+{
+    int w = (int)ceil(obj->m_bounds.width*sx);
+    int h = (int)ceil(obj->m_bounds.height*sy);
+    size_t size = (size_t)w*h*4;
+    if (w <= 0 || h <= 0 || size > m_budget)
+        return false;
+    Evict(size);
+
+    wxImage black = pdcRasterizeOver(obj, w, h, sx, sy, gc, *wxBLACK);
+    wxImage white = pdcRasterizeOver(obj, w, h, sx, sy, gc, *wxWHITE);
+    wxImage img(w, h, false);
+    img.InitAlpha();
+    unsigned char *b = black.GetData();
+    unsigned char *wh = white.GetData();
+    unsigned char *data = img.GetData();
+    unsigned char *alpha = img.GetAlpha();
+    for (int i=0; i<w*h; i++, b+=3, wh+=3, data+=3)
+    {
+        int a = 255 - ((wh[0]-b[0]) + (wh[1]-b[1]) + (wh[2]-b[2]))/3;
+        if (a < 0) a = 0;
+        if (a > 255) a = 255;
+        alpha[i] = (unsigned char)a;
+        for (int c=0; c<3; c++)
+            data[c] = a ? (unsigned char)wxMin(255, b[c]*255/a) : 0;
+    }
+    obj->m_cacheBitmap = wxBitmap(img, 32);
+    obj->m_cacheScaleX = sx;
+    obj->m_cacheScaleY = sy;
+    obj->m_cacheGC = gc;
+
+    obj->m_cacheStateOps.Clear();
+    pdcOpList::compatibility_iterator node = obj->m_oplist.GetFirst(); 
+    while(node)
+    {
+        if (node->GetData()->SetsState())
+            obj->m_cacheStateOps.Add(node->GetData());
+        node = node->GetNext();
+    }
+
+    m_used += size;
+    Link(obj);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Release - drop the bitmap of obj and free its share of the budget
+// ----------------------------------------------------------------------------
+void pdcBitmapCache::Release(pdcObject *obj)
+{
+    if (!obj->m_cacheBitmap.IsOk())
+        return;
+    m_used -= obj->GetCacheSize();
+    obj->m_cacheBitmap = wxNullBitmap;
+    obj->m_cacheStateOps.Clear();
+    Unlink(obj);
+}
+
+// ----------------------------------------------------------------------------
+// Evict - drop the least recently drawn bitmaps until needed more bytes fit
+//         in the budget
+// ----------------------------------------------------------------------------
+void pdcBitmapCache::Evict(size_t needed)
+{
+    while (m_last && m_used + needed > m_budget)
+        Release(m_last);
+}
+
+void pdcBitmapCache::Link(pdcObject *obj)
+{
+    obj->m_cachePrev = NULL;
+    obj->m_cacheNext = m_first;
+    if (m_first)
+        m_first->m_cachePrev = obj;
+    else
+        m_last = obj;
+    m_first = obj;
+}
+
+void pdcBitmapCache::Unlink(pdcObject *obj)
+{
+    if (obj->m_cachePrev)
+        obj->m_cachePrev->m_cacheNext = obj->m_cacheNext;
+    else
+        m_first = obj->m_cacheNext;
+    if (obj->m_cacheNext)
+        obj->m_cacheNext->m_cachePrev = obj->m_cachePrev;
+    else
+        m_last = obj->m_cachePrev;
+    obj->m_cachePrev = obj->m_cacheNext = NULL;
+}
+
 // ============================================================================
 // wxPseudoDC implementation
 // ============================================================================
@@ -293,7 +986,9 @@ wxPseudoDC::~wxPseudoDC()
 {
     // delete all the nodes in the list
     RemoveAll();
-    
+    delete m_objectlist;
+    delete m_objectIndex;
+    delete m_bitmapCache;
 }
 
 // ----------------------------------------------------------------------------
@@ -301,19 +996,47 @@ wxPseudoDC::~wxPseudoDC()
 // ----------------------------------------------------------------------------
 void wxPseudoDC::RemoveAll(void)
 {
-    m_objectlist.Clear();
-    m_objectIndex.clear();
+    m_objectlist->Clear();
+    m_objectIndex->clear();
     m_currId = -1;
     m_lastObject = NULL;
     
 }
 
+// ----------------------------------------------------------------------------
+// Swap - exchange the recorded objects with another pseudo dc.  Only the
+//        pointers to the lists are exchanged, so this takes constant time
+//        however much has been recorded.
+// ----------------------------------------------------------------------------
+void wxPseudoDC::Swap(wxPseudoDC& other)
+{
+    pdcObjectList *objectlist = m_objectlist;
+    m_objectlist = other.m_objectlist;
+    other.m_objectlist = objectlist;
+
+    pdcObjectHash *objectIndex = m_objectIndex;
+    m_objectIndex = other.m_objectIndex;
+    other.m_objectIndex = objectIndex;
+
+    // the objects keep pointing to the cache they were put in
+    pdcBitmapCache *bitmapCache = m_bitmapCache;
+    m_bitmapCache = other.m_bitmapCache;
+    other.m_bitmapCache = bitmapCache;
+
+    int currId = m_currId;
+    m_currId = other.m_currId;
+    other.m_currId = currId;
+
+    m_lastObject = NULL;
+    other.m_lastObject = NULL;
+}
+
 // ----------------------------------------------------------------------------
 // GetLen - return the number of operations in the current op list
 // ----------------------------------------------------------------------------
 int wxPseudoDC::GetLen(void)
 {
-    pdcObjectList::compatibility_iterator pt = m_objectlist.GetFirst();
+    pdcObjectList::compatibility_iterator pt = m_objectlist->GetFirst();
     int len=0;
     while (pt) 
     {
@@ -334,13 +1057,13 @@ pdcObject *wxPseudoDC::FindObject(int id, bool create)
     //~ if (m_lastObject && m_lastObject->GetId() == id)
         //~ return m_lastObject;
     // if not then search for it    
-    pdcObjectHash::iterator lookup = m_objectIndex.find(id);
-    if (lookup == m_objectIndex.end()) {//not found
+    pdcObjectHash::iterator lookup = m_objectIndex->find(id);
+    if (lookup == m_objectIndex->end()) {//not found
         if (create) {
             m_lastObject = new pdcObject(id);
-            m_objectlist.Append(m_lastObject);
+            m_objectlist->Append(m_lastObject);
             pdcObjectHash::value_type insert(id, m_lastObject);
-            m_objectIndex.insert(insert);
+            m_objectIndex->insert(insert);
             return m_lastObject;
         } else {
             return NULL;
@@ -359,6 +1082,38 @@ void wxPseudoDC::AddToList(pdcOp *newOp)
     obj->AddOp(newOp);
 }
 
+// ----------------------------------------------------------------------------
+// DrawXXXArray - record n primitives from an array of coordinates.  The
+//                object for the current id is only looked up once.
+// ----------------------------------------------------------------------------
+void wxPseudoDC::DrawPointArray(int n, const int* coords)
+{
+    pdcObject *obj = FindObject(m_currId, true);
+    for (int i=0; i<n; i++, coords+=2)
+        obj->AddOp(new pdcDrawPointOp(coords[0], coords[1]));
+}
+
+void wxPseudoDC::DrawLineArray(int n, const int* coords)
+{
+    pdcObject *obj = FindObject(m_currId, true);
+    for (int i=0; i<n; i++, coords+=4)
+        obj->AddOp(new pdcDrawLineOp(coords[0], coords[1], coords[2], coords[3]));
+}
+
+void wxPseudoDC::DrawRectangleArray(int n, const int* coords)
+{
+    pdcObject *obj = FindObject(m_currId, true);
+    for (int i=0; i<n; i++, coords+=4)
+        obj->AddOp(new pdcDrawRectangleOp(coords[0], coords[1], coords[2], coords[3]));
+}
+
+void wxPseudoDC::DrawEllipseArray(int n, const int* coords)
+{
+    pdcObject *obj = FindObject(m_currId, true);
+    for (int i=0; i<n; i++, coords+=4)
+        obj->AddOp(new pdcDrawEllipseOp(coords[0], coords[1], coords[2], coords[3]));
+}
+
 // ----------------------------------------------------------------------------
 // ClearID - remove all the operations associated with a single ID
 // ----------------------------------------------------------------------------
@@ -378,9 +1133,9 @@ void wxPseudoDC::RemoveId(int id)
     {
         if (m_lastObject == obj)
             m_lastObject = obj;
-        m_objectlist.DeleteObject(obj);
+        m_objectlist->DeleteObject(obj);
     }
-    m_objectIndex.erase(id);
+    m_objectIndex->erase(id);
 }
 
 // ----------------------------------------------------------------------------
@@ -419,7 +1174,7 @@ void wxPseudoDC::TranslateId(int id, wxCoord dx, wxCoord dy)
 void wxPseudoDC::DrawIdToDC(int id, wxDC *dc)
 {
     pdcObject *obj = FindObject(id);
-    if (obj) obj->DrawToDC(dc);
+    if (obj) DrawObject(obj, dc);
 }
 
 // ----------------------------------------------------------------------------
@@ -441,6 +1196,44 @@ bool wxPseudoDC::GetIdGreyedOut(int id)
     else return false;
 }
 
+// ----------------------------------------------------------------------------
+// SetIdCached - Set whether an id is drawn from a cached bitmap
+// ----------------------------------------------------------------------------
+void wxPseudoDC::SetIdCached(int id, bool cached)
+{
+    pdcObject *obj = FindObject(id);
+    if (obj) obj->SetCache(cached ? m_bitmapCache : NULL);
+}
+
+// ----------------------------------------------------------------------------
+// GetIdCached - Get whether an id is drawn from a cached bitmap
+// ----------------------------------------------------------------------------
+bool wxPseudoDC::GetIdCached(int id)
+{
+    pdcObject *obj = FindObject(id);
+    if (obj) return obj->GetCache() != NULL;
+    else return false;
+}
+
+// ----------------------------------------------------------------------------
+// GetIdCacheSize - Get the bytes taken by the cached bitmap of an id
+// ----------------------------------------------------------------------------
+size_t wxPseudoDC::GetIdCacheSize(int id)
+{
+    pdcObject *obj = FindObject(id);
+    if (obj) return obj->GetCacheSize();
+    else return 0;
+}
+
+// ----------------------------------------------------------------------------
+// DrawObject - draw an object from its cached bitmap if it has one
+// ----------------------------------------------------------------------------
+void wxPseudoDC::DrawObject(pdcObject *obj, wxDC *dc)
+{
+    if (!obj->GetCache() || !obj->GetCache()->Draw(obj, dc))
+        obj->DrawToDC(dc);
+}
+
 // ----------------------------------------------------------------------------
 // FindObjectsByBBox - Return a list of all the ids whose bounding boxes
 //                     contain (x,y)
@@ -448,7 +1241,7 @@ bool wxPseudoDC::GetIdGreyedOut(int id)
 PyObject *wxPseudoDC::FindObjectsByBBox(wxCoord x, wxCoord y)
 {
     //wxPyBlock_t blocked = wxPyBeginBlockThreads();
-    pdcObjectList::compatibility_iterator pt = m_objectlist.GetFirst();
+    pdcObjectList::compatibility_iterator pt = m_objectlist->GetFirst();
     pdcObject *obj;
     PyObject* pyList = NULL;
     pyList = PyList_New(0);
@@ -470,111 +1263,140 @@ PyObject *wxPseudoDC::FindObjectsByBBox(wxCoord x, wxCoord y)
 }
 
 // ----------------------------------------------------------------------------
-// FindObjects - Return a list of all the ids that draw to (x,y)
+// pdcPixelHitTest - finds whether an object draws near a point by drawing
+//                   it and looking at the pixels, for the objects whose ops
+//                   can't tell from their geometry
 // ----------------------------------------------------------------------------
-PyObject *wxPseudoDC::FindObjects(wxCoord x, wxCoord y, 
-                                  wxCoord radius, const wxColor& bg)
+class pdcPixelHitTest
+{
+    public:
+        pdcPixelHitTest(wxCoord x, wxCoord y, wxCoord radius, const wxColour& bg);
+        ~pdcPixelHitTest();
+        bool HitTest(pdcObject *obj);
+    protected:
+        wxCoord m_x, m_y, m_radius;
+        wxColour m_bg;
+        wxBrush m_bgbrush;
+        wxPen m_bgpen;
+        wxRect m_viewrect;
+        wxBitmap m_bmp;
+        wxMemoryDC m_memdc;
+        wxBitmap m_maskbmp;
+        wxMemoryDC m_maskdc;
+};
+
+pdcPixelHitTest::pdcPixelHitTest(wxCoord x, wxCoord y, wxCoord radius,
+                                 const wxColour& bg)
+    : m_x(x), m_y(y), m_radius(radius), m_bg(bg), m_bgbrush(bg), m_bgpen(bg)
 {
-    //wxPyBlock_t blocked = wxPyBeginBlockThreads();
-    pdcObjectList::compatibility_iterator pt = m_objectlist.GetFirst();
-    pdcObject *obj;
-    PyObject* pyList = NULL;
-    pyList = PyList_New(0);
-    wxBrush bgbrush(bg);
-    wxPen bgpen(bg);
     // special case radius = 0
     if (radius == 0)
     {
-        wxBitmap bmp(4,4,24);
-        wxMemoryDC memdc;
-        wxColor pix;
-        wxRect viewrect(x-2,y-2,4,4);
+        m_bmp = wxBitmap(4,4,24);
+        m_viewrect = wxRect(x-2,y-2,4,4);
         // setup the memdc for rendering
-        memdc.SelectObject(bmp);
-        memdc.SetBackground(bgbrush);
-        memdc.Clear();
-        memdc.SetDeviceOrigin(2-x,2-y);
-        while (pt) 
-        {
-            obj = pt->GetData();
-            if (obj->IsBounded() && obj->GetBounds().Contains(x,y))
-            {
-                // start clean
-                memdc.SetBrush(bgbrush);
-                memdc.SetPen(bgpen);
-                memdc.DrawRectangle(viewrect);
-                // draw the object
-                obj->DrawToDC(&memdc);
-                memdc.GetPixel(x,y,&pix);
-                // clear and update rgn2
-                if (pix != bg)
-                {
-                    PyObject* pyObj = PyInt_FromLong((long)obj->GetId());
-                    PyList_Insert(pyList, 0, pyObj);
-                    Py_DECREF(pyObj);
-                }
-            }
-            pt = pt->GetNext();
-        }
-        memdc.SelectObject(wxNullBitmap);
+        m_memdc.SelectObject(m_bmp);
+        m_memdc.SetBackground(m_bgbrush);
+        m_memdc.Clear();
+        m_memdc.SetDeviceOrigin(2-x,2-y);
     }
     else
     {
-        wxRect viewrect(x-radius,y-radius,2*radius,2*radius);
-        wxBitmap maskbmp(2*radius,2*radius,24);
-        wxMemoryDC maskdc;
+        m_viewrect = wxRect(x-radius,y-radius,2*radius,2*radius);
+        m_maskbmp = wxBitmap(2*radius,2*radius,24);
         // create bitmap with circle for masking
-        maskdc.SelectObject(maskbmp);
-        maskdc.SetBackground(*wxBLACK_BRUSH);
-        maskdc.Clear();
-        maskdc.SetBrush(*wxWHITE_BRUSH);
-        maskdc.SetPen(*wxWHITE_PEN);
-        maskdc.DrawCircle(radius,radius,radius);
+        m_maskdc.SelectObject(m_maskbmp);
+        m_maskdc.SetBackground(*wxBLACK_BRUSH);
+        m_maskdc.Clear();
+        m_maskdc.SetBrush(*wxWHITE_BRUSH);
+        m_maskdc.SetPen(*wxWHITE_PEN);
+        m_maskdc.DrawCircle(radius,radius,radius);
         // now setup a memdc for rendering our object
-        wxBitmap bmp(2*radius,2*radius,24);
-        wxMemoryDC memdc;
-        memdc.SelectObject(bmp);
+        m_bmp = wxBitmap(2*radius,2*radius,24);
+        m_memdc.SelectObject(m_bmp);
         // set the origin so (x,y) is in the bmp center
-        memdc.SetDeviceOrigin(radius-x,radius-y);
-        // a region will be used to see if the result is empty
-        wxRegion rgn2;
-        while (pt) 
+        m_memdc.SetDeviceOrigin(radius-x,radius-y);
+    }
+}
+
+pdcPixelHitTest::~pdcPixelHitTest()
+{
+    if (m_radius != 0)
+        m_maskdc.SelectObject(wxNullBitmap);
+    m_memdc.SelectObject(wxNullBitmap);
+}
+
+bool pdcPixelHitTest::HitTest(pdcObject *obj)
+{
+    // start clean
+    m_memdc.SetBrush(m_bgbrush);
+    m_memdc.SetPen(m_bgpen);
+    m_memdc.DrawRectangle(m_viewrect);
+    // draw the object
+    obj->DrawToDC(&m_memdc);
+    if (m_radius == 0)
+    {
+        wxColor pix;
+        m_memdc.GetPixel(m_x,m_y,&pix);
+        return pix != m_bg;
+    }
+    // remove background color
+    m_memdc.SetLogicalFunction(wxXOR);
+    m_memdc.SetBrush(m_bgbrush);
+    m_memdc.SetPen(m_bgpen);
+    m_memdc.DrawRectangle(m_viewrect);
+    m_memdc.SetLogicalFunction(wxCOPY);
+    m_memdc.Blit(m_x-m_radius,m_y-m_radius,2*m_radius,2*m_radius,&m_maskdc,0,0,wxCOPY);
+    // a region will be used to see if the result is empty
+    m_memdc.SelectObject(wxNullBitmap);
+    wxRegion rgn2;
+    rgn2.Union(m_bmp, *wxBLACK);
+    m_memdc.SelectObject(m_bmp);
+    return !rgn2.IsEmpty();
+}
+
+// ----------------------------------------------------------------------------
+// FindObjects - Return a list of all the ids that draw to (x,y)
+//               The ops work out from their geometry whether they draw
+//               near the point; objects with ops that can't (masked
+//               bitmaps, arcs, raster operations...) are drawn to a
+//               small bitmap and the pixels looked at
+// ----------------------------------------------------------------------------
+PyObject *wxPseudoDC::FindObjects(wxCoord x, wxCoord y, 
+                                  wxCoord radius, const wxColor& bg)
+{
+    //wxPyBlock_t blocked = wxPyBeginBlockThreads();
+    pdcObjectList::compatibility_iterator pt = m_objectlist->GetFirst();
+    pdcObject *obj;
+    PyObject* pyList = NULL;
+    pyList = PyList_New(0);
+    wxRect viewrect(x-radius,y-radius,2*radius,2*radius);
+    pdcHitTest ht(x, y, radius, bg);
+    pdcPixelHitTest *pixels = NULL; // made when first needed
+    while (pt) 
+    {
+        obj = pt->GetData();
+        if (obj->IsBounded() && 
+            (radius == 0 ? obj->GetBounds().Contains(x,y) 
+                         : viewrect.Intersects(obj->GetBounds())))
         {
-            obj = pt->GetData();
-            if (obj->IsBounded() && viewrect.Intersects(obj->GetBounds()))
+            pdcHitResult hit = obj->HitTest(ht);
+            if (hit == pdcHIT_UNKNOWN)
             {
-                // start clean
-                //memdc.Clear();
-                memdc.SetBrush(bgbrush);
-                memdc.SetPen(bgpen);
-                memdc.DrawRectangle(viewrect);
-                // draw the object
-                obj->DrawToDC(&memdc);
-                // remove background color
-                memdc.SetLogicalFunction(wxXOR);
-                memdc.SetBrush(bgbrush);
-                memdc.SetPen(bgpen);
-                memdc.DrawRectangle(viewrect);
-                memdc.SetLogicalFunction(wxCOPY);
-                memdc.Blit(x-radius,y-radius,2*radius,2*radius,&maskdc,0,0,wxCOPY);
-                // clear and update rgn2
-                memdc.SelectObject(wxNullBitmap);
-                rgn2.Clear();
-                rgn2.Union(bmp, *wxBLACK);
-                //rgn2.Intersect(rgn);
-                memdc.SelectObject(bmp);
-                if (!rgn2.IsEmpty())
-                {
-                    PyObject* pyObj = PyInt_FromLong((long)obj->GetId());
-                    PyList_Insert(pyList, 0, pyObj);
-                    Py_DECREF(pyObj);
-                }
+                if (!pixels)
+                    pixels = new pdcPixelHitTest(x, y, radius, bg);
+                hit = pixels->HitTest(obj) ? pdcHIT_FOUND : pdcHIT_NONE;
+            }
+            if (hit == pdcHIT_FOUND)
+            {
+                PyObject* pyObj = PyInt_FromLong((long)obj->GetId());
+                PyList_Insert(pyList, 0, pyObj);
+                Py_DECREF(pyObj);
             }
-            pt = pt->GetNext();
         }
-        maskdc.SelectObject(wxNullBitmap);
-        memdc.SelectObject(wxNullBitmap);
+        pt = pt->GetNext();
     }
+    delete pixels;
     //wxPyEndBlockThreads(blocked);
     return pyList;
 }
@@ -587,26 +1409,26 @@ PyObject *wxPseudoDC::FindObjects(wxCoord x, wxCoord y,
 // ----------------------------------------------------------------------------
 void wxPseudoDC::DrawToDCClipped(wxDC *dc, const wxRect& rect)
 {
-    pdcObjectList::compatibility_iterator pt = m_objectlist.GetFirst();
+    pdcObjectList::compatibility_iterator pt = m_objectlist->GetFirst();
     pdcObject *obj;
     while (pt) 
     {
         obj = pt->GetData();
         if (!obj->IsBounded() || rect.Intersects(obj->GetBounds()))
-            obj->DrawToDC(dc);
+            DrawObject(obj, dc);
         pt = pt->GetNext();
     }
 }
 void wxPseudoDC::DrawToDCClippedRgn(wxDC *dc, const wxRegion& region)
 {
-    pdcObjectList::compatibility_iterator pt = m_objectlist.GetFirst();
+    pdcObjectList::compatibility_iterator pt = m_objectlist->GetFirst();
     pdcObject *obj;
     while (pt) 
     {
         obj = pt->GetData();
         if (!obj->IsBounded() || 
             (region.Contains(obj->GetBounds()) != wxOutRegion))
-            obj->DrawToDC(dc);
+            DrawObject(obj, dc);
         pt = pt->GetNext();
     }
 }
@@ -616,11 +1438,53 @@ void wxPseudoDC::DrawToDCClippedRgn(wxDC *dc, const wxRegion& region)
 // ----------------------------------------------------------------------------
 void wxPseudoDC::DrawToDC(wxDC *dc)
 {
-    pdcObjectList::compatibility_iterator pt = m_objectlist.GetFirst();
+    pdcObjectList::compatibility_iterator pt = m_objectlist->GetFirst();
     while (pt) 
     {
-        pt->GetData()->DrawToDC(dc);
+        DrawObject(pt->GetData(), dc);
         pt = pt->GetNext();
     }
 }
         
+
+#if wxUSE_GRAPHICS_CONTEXT
+// ----------------------------------------------------------------------------
+// DrawToGCDC - play back the op list to a wxGCDC, skipping redundant pens,
+//              brushes and fonts and drawing runs of lines and rectangles
+//              directly with its graphics context
+// ----------------------------------------------------------------------------
+void wxPseudoDC::DrawToGCDC(wxGCDC *dc)
+{
+    pdcPlayback pb(dc, dc->GetGraphicsContext());
+    pdcObjectList::compatibility_iterator pt = m_objectlist->GetFirst();
+    pdcObject *obj;
+    while (pt) 
+    {
+        obj = pt->GetData();
+        if (obj->GetCache() && obj->GetCache()->Draw(obj, pb.GetDC()))
+            pb.Reset();
+        else
+            obj->Play(pb);
+        pt = pt->GetNext();
+    }
+}
+
+void wxPseudoDC::DrawToGCDCClipped(wxGCDC *dc, const wxRect& rect)
+{
+    pdcPlayback pb(dc, dc->GetGraphicsContext());
+    pdcObjectList::compatibility_iterator pt = m_objectlist->GetFirst();
+    pdcObject *obj;
+    while (pt) 
+    {
+        obj = pt->GetData();
+        if (!obj->IsBounded() || rect.Intersects(obj->GetBounds()))
+        {
+            if (obj->GetCache() && obj->GetCache()->Draw(obj, pb.GetDC()))
+                pb.Reset();
+            else
+                obj->Play(pb);
+        }
+        pt = pt->GetNext();
+    }
+}
+#endif // wxUSE_GRAPHICS_CONTEXT
@@ -25,6 +25,10 @@
 
 #include <wx/richtext/richtextctrl.h>
 
+// Size of the reads and writes done by the file handlers on their streams,
+// which may be Python file-like objects.
+#define wxPY_RICHTEXT_STREAM_BUFSIZE 65536
+
 
 class wxEffects;
 class wxBufferedDC;
@@ -23,6 +23,9 @@ languages are built-in."
 #include "wx/wxPython/wxPython.h"
 #include "wx/wxPython/pyclasses.h"
 #include <wx/stc/stc.h>
+
+// for SCI_GETSTYLEDTEXT and Sci_TextRange
+#include "Scintilla.h"
 %}
 
 //---------------------------------------------------------------------------
@@ -67,6 +70,75 @@ MustHaveApp(wxStyledTextCtrl);
             wxPyBLOCK_THREADS( rv = PyBuffer_FromMemory((void*)ptr, len) );
             return rv;
         }
+
+        DocStr(SetStylingFromBuffer,
+               "Sets the styles of the characters from start on to the bytes of a
+string or other object supporting the buffer interface, one byte per
+character, as StartStyling(start, mask) followed by SetStyleBytes
+would.  This lets a lexer written in Python style a whole range with
+one call instead of one per token.", "");
+        void SetStylingFromBuffer(int start, buffer data, int DATASIZE, int mask = 0x1f)
+        {
+            if (start < 0 || start + DATASIZE > self->GetLength()) {
+                wxPyErr_SetString(PyExc_ValueError,
+                                  "Style buffer extends past the end of the document.");
+                return;
+            }
+            self->StartStyling(start, mask);
+            self->SetStyleBytes(DATASIZE, (char*)data);
+        }
+
+        DocStr(GetStyledTextBuffer,
+               "Returns a string holding the characters from startPos up to endPos
+interleaved with their style bytes, like GetStyledText, but copied
+directly from the document.", "");
+        PyObject* GetStyledTextBuffer(int startPos, int endPos)
+        {
+            if (endPos < startPos) {
+                int temp = startPos;
+                startPos = endPos;
+                endPos = temp;
+            }
+            if (startPos < 0)
+                startPos = 0;
+            if (endPos > self->GetLength())
+                endPos = self->GetLength();
+            int len = wxMax(endPos - startPos, 0);
+
+            // Scintilla also writes two terminating nulls, the string already
+            // has room for one.
+            PyObject* rv;
+            wxPyBLOCK_THREADS( rv = PyString_FromStringAndSize(NULL, len*2 + 1) );
+            if (!rv)
+                return NULL;
+            if (len) {
+                Sci_TextRange tr;
+                tr.chrg.cpMin = startPos;
+                tr.chrg.cpMax = endPos;
+                tr.lpstrText = PyString_AS_STRING(rv);
+                self->SendMsg(SCI_GETSTYLEDTEXT, 0, (wxIntPtr)&tr);
+            }
+            wxPyBLOCK_THREADS( _PyString_Resize(&rv, len*2) );
+            return rv;
+        }
+
+        DocStr(IndicatorFillRanges,
+               "Fills several ranges with the current indicator and value, as calling
+IndicatorFillRange for each would.  The ranges are given as a buffer of
+native ints holding (position, length) pairs, such as an
+array.array('i').", "");
+        void IndicatorFillRanges(buffer data, int DATASIZE)
+        {
+            if (DATASIZE % (2 * sizeof(int))) {
+                wxPyErr_SetString(PyExc_ValueError,
+                                  "The buffer should hold pairs of ints.");
+                return;
+            }
+            const int* ranges = (const int*)data;
+            int count = DATASIZE / (2 * sizeof(int));
+            for (int i = 0; i < count; i++)
+                self->IndicatorFillRange(ranges[i*2], ranges[i*2 + 1]);
+        }
     }
     
     %pythoncode {
@@ -0,0 +1,324 @@
+# -*- coding: utf-8 -*-
+"""Benchmarks for the cost of wxPython's binding layer.
+
+Each benchmark times a hot path through the wrappers -- event dispatch to
+Python handlers, virtuals overridden in Python, creation of proxy objects,
+string conversion, the DrawXXXList methods and PseudoDC playback -- and
+reports the time per call in nanoseconds, as one JSON object per line:
+
+    {"name": "event.dispatch", "calls": 20000, "ns_per_call": 1843.2,
+     "gc_objects_per_call": 3.0}
+
+gc_objects_per_call is the change in the number of objects tracked by the
+garbage collector, which leaves out ints, strings and the like, and what
+the C++ side allocates.
+
+With --stats each result also gets a "stats" item holding what
+wx.GetBindingStats reports for one run of the benchmark.
+
+Run it with a display, or headless with "./b bench", which uses xvfb-run
+and passes on its arguments, for example "./b bench -o results.json event".
+"""
+
+import array
+import gc
+import sys
+import time
+from optparse import OptionParser
+import wx
+
+try:
+    import json
+except ImportError:
+    json = None
+
+
+# ----------------- Measuring ---------------------
+
+def measure(name, func, calls, repeat, stats=False):
+    """Time func(calls) repeat times, func doing about calls calls of the
+    path being measured, and return the result of the fastest run.  The
+    times are divided by the number of calls func returns, or by calls if
+    it returns None."""
+    func(min(calls, 100))        # warm up
+    best = None
+    for i in range(repeat):
+        gc.collect()
+        start = time.time()
+        done = func(calls) or calls
+        elapsed = time.time() - start
+        if best is None or elapsed < best:
+            best = elapsed
+
+    gc.collect()
+    before = len(gc.get_objects())
+    func(calls)
+    after = len(gc.get_objects())
+
+    result = { 'name'                : name,
+               'calls'               : done,
+               'ns_per_call'         : round(best * 1e9 / done, 1),
+               'gc_objects_per_call' : round(float(after - before) / done, 2),
+               }
+
+    if stats:
+        # counted in a run of their own, so they don't skew the timing
+        wx.ResetBindingStats()
+        wx.EnableBindingStats(True)
+        func(calls)
+        wx.EnableBindingStats(False)
+        result['stats'] = wx.GetBindingStats()
+    return result
+
+
+def report(result, out):
+    if json is not None:
+        out.write(json.dumps(result, sort_keys=True) + '\n')
+    else:
+        out.write('{%s}\n' % ', '.join(['"%s": %r' % item for item in sorted(result.items())]))
+    out.flush()
+
+
+# ----------------- Benchmarks ---------------------
+
+class BestSizePanel(wx.PyPanel):
+    def DoGetBestSize(self):
+        return wx.Size(100, 20)
+
+
+class Benchmarks(object):
+    """Each bench_* method sets up what it needs and returns a function
+    taking the number of calls to make.  The ones that make calls in
+    batches return the number they made."""
+
+    def __init__(self, frame):
+        self.frame = frame
+        self.panel = wx.Panel(frame)
+
+
+    def bench_event_dispatch(self):
+        # EventThunker: a Python handler bound to a window
+        button = wx.Button(self.panel, -1, 'button')
+        button.Bind(wx.EVT_BUTTON, lambda evt: None)
+        evt = wx.CommandEvent(wx.wxEVT_COMMAND_BUTTON_CLICKED, button.GetId())
+        evt.SetEventObject(button)
+        def run(calls):
+            process = button.GetEventHandler().ProcessEvent
+            for i in xrange(calls):
+                process(evt)
+        return run
+
+
+    def bench_event_unbound(self):
+        # dispatch of an event that no Python handler is bound for
+        window = wx.Window(self.panel)
+        evt = wx.CommandEvent(wx.wxEVT_COMMAND_BUTTON_CLICKED, window.GetId())
+        def run(calls):
+            process = window.GetEventHandler().ProcessEvent
+            for i in xrange(calls):
+                process(evt)
+        return run
+
+
+    def bench_virtual_override(self):
+        # findCallback and the call of a C++ virtual overridden in Python
+        panel = BestSizePanel(self.panel)
+        def run(calls):
+            invalidate = panel.InvalidateBestSize
+            get = panel.GetBestSize
+            for i in xrange(calls):
+                invalidate()
+                get()
+        return run
+
+
+    def bench_proxy_construction(self):
+        # wxPyConstructObject and SWIG proxies for returned objects
+        window = wx.Window(self.panel)
+        def run(calls):
+            getFont = window.GetFont
+            for i in xrange(calls):
+                getFont()
+        return run
+
+
+    def bench_proxy_oor(self):
+        # returning a window that already has a Python object
+        window = wx.Window(self.panel)
+        def run(calls):
+            getParent = window.GetParent
+            for i in xrange(calls):
+                getParent()
+        return run
+
+
+    def bench_string_ascii(self):
+        window = wx.Window(self.panel)
+        text = 'label ' * 10
+        def run(calls):
+            setLabel = window.SetLabel
+            getLabel = window.GetLabel
+            for i in xrange(calls):
+                setLabel(text)
+                getLabel()
+        return run
+
+
+    def bench_string_unicode(self):
+        window = wx.Window(self.panel)
+        text = u'étiquette 中文 ' * 5
+        def run(calls):
+            setLabel = window.SetLabel
+            getLabel = window.GetLabel
+            for i in xrange(calls):
+                setLabel(text)
+                getLabel()
+        return run
+
+
+    def _memoryDC(self):
+        bmp = wx.EmptyBitmap(400, 400)
+        dc = wx.MemoryDC(bmp)
+        self._bitmap = bmp
+        return dc
+
+
+    def bench_draw_point_list(self):
+        dc = self._memoryDC()
+        points = [(i % 400, i // 400) for i in xrange(1000)]
+        def run(calls):
+            # one call draws a point, so calls/1000 DrawPointList calls
+            batches = max(calls // len(points), 1)
+            for i in xrange(batches):
+                dc.DrawPointList(points)
+            return batches * len(points)
+        return run
+
+
+    def bench_draw_line_list(self):
+        dc = self._memoryDC()
+        lines = [(i % 400, 0, 0, i % 400) for i in xrange(1000)]
+        def run(calls):
+            batches = max(calls // len(lines), 1)
+            for i in xrange(batches):
+                dc.DrawLineList(lines)
+            return batches * len(lines)
+        return run
+
+
+    def bench_draw_rectangle_list(self):
+        dc = self._memoryDC()
+        rects = [(i % 390, i % 390, 10, 10) for i in xrange(1000)]
+        def run(calls):
+            batches = max(calls // len(rects), 1)
+            for i in xrange(batches):
+                dc.DrawRectangleList(rects)
+            return batches * len(rects)
+        return run
+
+
+    def bench_pseudodc_playback(self):
+        pdc = wx.PseudoDC()
+        for i in xrange(1000):
+            pdc.SetId(i)
+            pdc.SetPen(wx.BLACK_PEN)
+            pdc.DrawRectangle(i % 390, i % 390, 10, 10)
+            pdc.SetIdBounds(i, wx.Rect(i % 390, i % 390, 10, 10))
+        dc = self._memoryDC()
+        def run(calls):
+            # one call plays back one operation, a pen or a rectangle
+            batches = max(calls // pdc.GetLen(), 1)
+            for i in xrange(batches):
+                pdc.DrawToDC(dc)
+            return batches * pdc.GetLen()
+        return run
+
+
+    def bench_pseudodc_playback_gc(self):
+        # the same display list, played back with DrawToGCDC
+        pdc = wx.PseudoDC()
+        for i in xrange(1000):
+            pdc.SetId(i)
+            pdc.SetPen(wx.BLACK_PEN)
+            pdc.DrawRectangle(i % 390, i % 390, 10, 10)
+            pdc.SetIdBounds(i, wx.Rect(i % 390, i % 390, 10, 10))
+        dc = wx.GCDC(self._memoryDC())
+        def run(calls):
+            batches = max(calls // pdc.GetLen(), 1)
+            for i in xrange(batches):
+                pdc.DrawToGCDC(dc)
+            return batches * pdc.GetLen()
+        return run
+
+
+    def bench_pseudodc_record(self):
+        pdc = wx.PseudoDC()
+        def run(calls):
+            pdc.RemoveAll()
+            for i in xrange(calls):
+                pdc.SetId(i)
+                pdc.DrawRectangle(i % 390, i % 390, 10, 10)
+        return run
+
+
+    def bench_pseudodc_record_buffer(self):
+        pdc = wx.PseudoDC()
+        coords = array.array('i')
+        for i in xrange(1000):
+            coords.extend((i % 390, i % 390, 10, 10))
+        def run(calls):
+            # one call records one rectangle
+            batches = max(calls // (len(coords) // 4), 1)
+            for i in xrange(batches):
+                pdc.RemoveAll()
+                pdc.DrawRectangleBuffer(coords)
+            return batches * (len(coords) // 4)
+        return run
+
+
+# ----------------- Main ---------------------
+
+def main(args):
+    parser = OptionParser(usage='%prog [options] [name ...]',
+                          description='Runs the benchmarks whose names start with '
+                                      'one of the given names, or all of them.')
+    parser.add_option('-n', '--calls', type='int', default=20000,
+                      help='number of calls per run [%default]')
+    parser.add_option('-r', '--repeat', type='int', default=5,
+                      help='number of runs, the fastest is reported [%default]')
+    parser.add_option('-o', '--output', default='-',
+                      help='file to write the results to [stdout]')
+    parser.add_option('-l', '--list', action='store_true', default=False,
+                      help='list the benchmarks and exit')
+    parser.add_option('-s', '--stats', action='store_true', default=False,
+                      help='add the counters of wx.GetBindingStats to the results')
+    options, names = parser.parse_args(args)
+
+    app = wx.App(False)
+    frame = wx.Frame(None, title='benchmarks')
+    benchmarks = Benchmarks(frame)
+    available = sorted([attr[6:] for attr in dir(benchmarks) if attr.startswith('bench_')])
+    if options.list:
+        for name in available:
+            print name.replace('_', '.', 1)
+        return 0
+
+    if options.output == '-':
+        out = sys.stdout
+    else:
+        out = open(options.output, 'w')
+    for name in available:
+        dotted = name.replace('_', '.', 1)
+        if names and not [n for n in names if dotted.startswith(n)]:
+            continue
+        run = getattr(benchmarks, 'bench_' + name)()
+        report(measure(dotted, run, options.calls, options.repeat, options.stats), out)
+    if out is not sys.stdout:
+        out.close()
+
+    frame.Destroy()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
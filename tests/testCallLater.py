@@ -0,0 +1,149 @@
+"""Unit tests for wx.CallLater and wx.CallEvery.
+
+Methods yet to test:
+GetInterval, GetResult, HasRun, SetArgs"""
+
+import unittest
+import time
+import wx
+
+def runEvents(millis, condition=None):
+    """Process events for millis milliseconds, or until condition() is
+    true.  The tests don't run in a main loop, so the timers only fire
+    from here."""
+    end = time.time() + millis / 1000.0
+    while time.time() < end:
+        if condition is not None and condition():
+            break
+        wx.GetApp().Yield(True)
+        wx.MilliSleep(5)
+
+# -----------------------------------------------------------
+
+class CallLaterTest(unittest.TestCase):
+    def setUp(self):
+        self.calls = []
+        self.timers = []
+
+    def tearDown(self):
+        for timer in self.timers:
+            timer.Stop()
+
+    def callLater(self, millis, name, action=None):
+        def call():
+            self.calls.append(name)
+            if action is not None:
+                action()
+        timer = wx.CallLater(millis, call)
+        self.timers.append(timer)
+        return timer
+
+    def testRun(self):
+        """Start, IsRunning"""
+        timer = self.callLater(20, 'a')
+        self.assert_(timer.IsRunning())
+        runEvents(1000, lambda: self.calls)
+        self.assertEquals(['a'], self.calls)
+        self.assert_(not timer.IsRunning())
+
+    def testStop(self):
+        """Stop"""
+        timer = self.callLater(20, 'a')
+        timer.Stop()
+        runEvents(100)
+        self.assertEquals([], self.calls)
+
+    def testStopFromCallback(self):
+        """Stop from a callback run in the same batch"""
+        # both are due in the same tick, the first one stops the second
+        second = []
+        self.callLater(20, 'a', lambda: second[0].Stop())
+        second.append(self.callLater(20, 'b'))
+        runEvents(200)
+        self.assertEquals(['a'], self.calls)
+
+    def testRestartFromCallback(self):
+        """Restart from a callback run in the same batch"""
+        second = []
+        self.callLater(20, 'a', lambda: second[0].Restart(100))
+        second.append(self.callLater(20, 'b'))
+        runEvents(60)
+        self.assertEquals(['a'], self.calls)
+        runEvents(1000, lambda: len(self.calls) == 2)
+        runEvents(100)
+        self.assertEquals(['a', 'b'], self.calls)
+
+    def testStopAndStartFromCallback(self):
+        """Stop and Start from a callback run in the same batch"""
+        second = []
+        def restart():
+            second[0].Stop()
+            second[0].Start(100)
+        self.callLater(20, 'a', restart)
+        second.append(self.callLater(20, 'b'))
+        runEvents(60)
+        self.assertEquals(['a'], self.calls)
+        runEvents(1000, lambda: len(self.calls) == 2)
+        runEvents(100)
+        self.assertEquals(['a', 'b'], self.calls)
+
+    def testRestartSelf(self):
+        """Restart from its own callback"""
+        timer = []
+        def again():
+            if len(self.calls) < 3:
+                timer[0].Restart(10)
+        timer.append(self.callLater(10, 'a', again))
+        runEvents(1000, lambda: len(self.calls) == 3)
+        runEvents(100)
+        self.assertEquals(['a', 'a', 'a'], self.calls)
+        self.assert_(not timer[0].IsRunning())
+
+
+class CallEveryTest(unittest.TestCase):
+    def setUp(self):
+        self.count = 0
+        self.timer = None
+
+    def tearDown(self):
+        if self.timer is not None:
+            self.timer.Stop()
+
+    def testRepeat(self):
+        """Start, IsRunning"""
+        def tick():
+            self.count += 1
+        self.timer = wx.CallEvery(10, tick)
+        runEvents(1000, lambda: self.count >= 3)
+        self.assert_(self.count >= 3)
+        self.assert_(self.timer.IsRunning())
+
+    def testStopFromCallback(self):
+        """Stop from its own callback"""
+        def tick():
+            self.count += 1
+            if self.count == 3:
+                self.timer.Stop()
+        self.timer = wx.CallEvery(10, tick)
+        runEvents(1000, lambda: self.count >= 3)
+        runEvents(100)
+        self.assertEquals(3, self.count)
+        self.assert_(not self.timer.IsRunning())
+
+    def testRestartFromCallback(self):
+        """Restart from its own callback"""
+        def tick():
+            self.count += 1
+            if self.count == 1:
+                self.timer.Restart(200)
+        self.timer = wx.CallEvery(10, tick)
+        runEvents(1000, lambda: self.count >= 1)
+        runEvents(100)
+        self.assertEquals(1, self.count)
+        runEvents(1000, lambda: self.count >= 2)
+        self.assertEquals(2, self.count)
+
+
+if __name__ == '__main__':
+    app = wx.PySimpleApp()
+    unittest.main()
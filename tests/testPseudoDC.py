@@ -0,0 +1,238 @@
+"""Unit tests for wx.PseudoDC.FindObjects and the bitmap cache.
+
+FindObjects finds most objects from their geometry, without drawing them.
+These tests draw the same objects to a bitmap and check that the objects
+found at each point match the pixels that were drawn there.  The cache
+tests check when the bitmaps of cached objects are made and dropped.
+
+Methods yet to test:
+everything else"""
+
+import unittest
+import wx
+
+SIZE = 40
+
+def drawnPixels(pdc):
+    """The points where pdc draws something on a white background."""
+    bmp = wx.EmptyBitmap(SIZE, SIZE, 24)
+    dc = wx.MemoryDC(bmp)
+    dc.SetBackground(wx.WHITE_BRUSH)
+    dc.Clear()
+    pdc.DrawToDC(dc)
+    drawn = set()
+    for x in range(SIZE):
+        for y in range(SIZE):
+            if dc.GetPixel(x, y) != wx.WHITE:
+                drawn.add((x, y))
+    dc.SelectObject(wx.NullBitmap)
+    return drawn
+
+def foundPoints(pdc):
+    """The points where FindObjects finds the object with id 1."""
+    found = set()
+    for x in range(SIZE):
+        for y in range(SIZE):
+            if 1 in pdc.FindObjects(x, y, 0, wx.WHITE):
+                found.add((x, y))
+    return found
+
+def recorder(draw, pen=None, brush=None):
+    pdc = wx.PseudoDC()
+    pdc.SetId(1)
+    pdc.SetPen(pen or wx.Pen(wx.BLACK, 1))
+    pdc.SetBrush(brush or wx.TRANSPARENT_BRUSH)
+    draw(pdc)
+    pdc.SetIdBounds(1, wx.Rect(0, 0, SIZE, SIZE))
+    return pdc
+
+# -----------------------------------------------------------
+
+class PseudoDCFindObjectsTest(unittest.TestCase):
+    def assertSameAsPixels(self, pdc, slack=0):
+        """The points found are the pixels drawn, except for at most slack
+        of them on edges that are not straight."""
+        drawn = drawnPixels(pdc)
+        found = foundPoints(pdc)
+        self.assert_(drawn)
+        self.assert_(len(drawn ^ found) <= slack,
+                     'differ at %s' % sorted(drawn ^ found))
+
+    def testRectangle(self):
+        """DrawRectangle outlined"""
+        self.assertSameAsPixels(recorder(lambda pdc: pdc.DrawRectangle(5, 5, 10, 10)))
+
+    def testFilledRectangle(self):
+        """DrawRectangle filled"""
+        self.assertSameAsPixels(recorder(lambda pdc: pdc.DrawRectangle(5, 5, 10, 10),
+                                         brush=wx.BLACK_BRUSH))
+
+    def testAdjacentRectangles(self):
+        """DrawRectangle side by side, found once"""
+        pdc = wx.PseudoDC()
+        pdc.SetPen(wx.BLACK_PEN)
+        pdc.SetBrush(wx.BLACK_BRUSH)
+        for id, x in ((1, 0), (2, 10)):
+            pdc.SetId(id)
+            pdc.DrawRectangle(x, 0, 10, 10)
+            pdc.SetIdBounds(id, wx.Rect(x, 0, 10, 10))
+        self.assertEquals([1], pdc.FindObjects(9, 5, 0, wx.WHITE))
+        self.assertEquals([2], pdc.FindObjects(10, 5, 0, wx.WHITE))
+
+    def testWidePen(self):
+        """DrawRectangle with a 3 pixel pen"""
+        self.assertSameAsPixels(recorder(lambda pdc: pdc.DrawRectangle(5, 5, 20, 20),
+                                         pen=wx.Pen(wx.BLACK, 3)))
+
+    def testPoint(self):
+        """DrawPoint with a wide pen sets one pixel"""
+        self.assertSameAsPixels(recorder(lambda pdc: pdc.DrawPoint(10, 10),
+                                         pen=wx.Pen(wx.BLACK, 5)))
+
+    def testLines(self):
+        """DrawLine across and down"""
+        def draw(pdc):
+            pdc.DrawLine(2, 5, 30, 5)
+            pdc.DrawLine(20, 10, 20, 35)
+        self.assertSameAsPixels(recorder(draw))
+
+    def testDiagonalLine(self):
+        """DrawLine at an angle"""
+        self.assertSameAsPixels(recorder(lambda pdc: pdc.DrawLine(2, 3, 35, 20)),
+                                slack=4)
+
+    def testEllipse(self):
+        """DrawEllipse outlined and filled"""
+        draw = lambda pdc: pdc.DrawEllipse(4, 6, 30, 20)
+        self.assertSameAsPixels(recorder(draw), slack=8)
+        self.assertSameAsPixels(recorder(draw, brush=wx.BLACK_BRUSH), slack=8)
+
+    def testPolygon(self):
+        """DrawPolygon outlined and filled"""
+        points = [(5, 5), (30, 5), (30, 30), (5, 30)]
+        draw = lambda pdc: pdc.DrawPolygon(points)
+        self.assertSameAsPixels(recorder(draw))
+        triangle = [(5, 5), (35, 20), (5, 35)]
+        draw = lambda pdc: pdc.DrawPolygon(triangle)
+        self.assertSameAsPixels(recorder(draw, brush=wx.BLACK_BRUSH), slack=8)
+
+    def testText(self):
+        """DrawText is found on its glyphs and nowhere outside its extent"""
+        pdc = recorder(lambda pdc: pdc.DrawText('Hg', 5, 5))
+        drawn = drawnPixels(pdc)
+        found = foundPoints(pdc)
+        self.assert_(drawn)
+        self.assert_(drawn <= found, 'missed %s' % sorted(drawn - found))
+        dc = wx.MemoryDC(wx.EmptyBitmap(1, 1))
+        w, h = dc.GetTextExtent('Hg')
+        box = set([(x, y) for x in range(5, 5 + w) for y in range(5, 5 + h)])
+        self.assert_(found <= box, 'found outside at %s' % sorted(found - box))
+
+
+class PseudoDCCacheTest(unittest.TestCase):
+    # a 10x10 bitmap with alpha
+    BYTES = 10 * 10 * 4
+
+    def setUp(self):
+        self.pdc = wx.PseudoDC()
+
+    def square(self, id, x, cached=True):
+        """A filled 10x10 square drawn by id at (x, 0)."""
+        self.pdc.SetId(id)
+        self.pdc.SetPen(wx.BLACK_PEN)
+        self.pdc.SetBrush(wx.BLACK_BRUSH)
+        self.pdc.DrawRectangle(x, 0, 10, 10)
+        self.pdc.SetIdBounds(id, wx.Rect(x, 0, 10, 10))
+        self.pdc.SetIdCached(id, cached)
+
+    def drawIds(self, *ids):
+        dc = wx.MemoryDC(wx.EmptyBitmap(SIZE, SIZE, 24))
+        for id in ids:
+            self.pdc.DrawIdToDC(id, dc)
+        dc.SelectObject(wx.NullBitmap)
+
+    def testRasterized(self):
+        """SetIdCached, GetIdCacheSize, GetCacheUsed"""
+        self.square(1, 0, cached=False)
+        uncached = drawnPixels(self.pdc)
+        self.assertEquals(0, self.pdc.GetIdCacheSize(1))
+        self.pdc.SetIdCached(1)
+        self.assertEquals(0, self.pdc.GetIdCacheSize(1))
+        self.assertEquals(uncached, drawnPixels(self.pdc))
+        self.assertEquals(self.BYTES, self.pdc.GetIdCacheSize(1))
+        self.assertEquals(self.BYTES, self.pdc.GetCacheUsed())
+
+    def testSetId(self):
+        """Drawing more after SetId drops the bitmap"""
+        self.square(1, 0)
+        drawnPixels(self.pdc)
+        self.pdc.SetId(1)
+        self.pdc.SetPen(wx.Pen(wx.BLACK, 1))
+        self.pdc.DrawLine(0, 15, 30, 15)
+        self.pdc.SetIdBounds(1, wx.Rect(0, 0, 30, 20))
+        self.assertEquals(0, self.pdc.GetIdCacheSize(1))
+        self.assertEquals(0, self.pdc.GetCacheUsed())
+        self.assert_((20, 15) in drawnPixels(self.pdc))
+        self.assertEquals(30 * 20 * 4, self.pdc.GetCacheUsed())
+
+    def testClearId(self):
+        """ClearId drops the bitmap"""
+        self.square(1, 0)
+        drawnPixels(self.pdc)
+        self.pdc.ClearId(1)
+        self.assertEquals(0, self.pdc.GetIdCacheSize(1))
+        self.assertEquals(0, self.pdc.GetCacheUsed())
+        self.pdc.SetId(1)
+        self.pdc.SetPen(wx.Pen(wx.BLACK, 1))
+        self.pdc.DrawPoint(5, 5)
+        self.assertEquals(set([(5, 5)]), drawnPixels(self.pdc))
+
+    def testRemoveId(self):
+        """RemoveId drops the bitmap"""
+        self.square(1, 0)
+        self.square(2, 10)
+        drawnPixels(self.pdc)
+        self.pdc.RemoveId(1)
+        self.assertEquals(self.BYTES, self.pdc.GetCacheUsed())
+        self.pdc.RemoveId(2)
+        self.assertEquals(0, self.pdc.GetCacheUsed())
+
+    def testUncacheable(self):
+        """Objects with a logical function are drawn op by op"""
+        self.square(1, 0)
+        self.pdc.SetId(1)
+        self.pdc.SetLogicalFunction(wx.XOR)
+        drawnPixels(self.pdc)
+        self.assert_(self.pdc.GetIdCached(1))
+        self.assertEquals(0, self.pdc.GetIdCacheSize(1))
+        self.assertEquals(0, self.pdc.GetCacheUsed())
+
+    def testEviction(self):
+        """The least recently drawn bitmap is dropped first"""
+        self.pdc.SetCacheBudget(2 * self.BYTES)
+        self.square(1, 0)
+        self.square(2, 10)
+        self.square(3, 20)
+        self.drawIds(1, 2, 1)
+        self.drawIds(3)
+        self.assertEquals(self.BYTES, self.pdc.GetIdCacheSize(1))
+        self.assertEquals(0, self.pdc.GetIdCacheSize(2))
+        self.assertEquals(self.BYTES, self.pdc.GetIdCacheSize(3))
+        self.assertEquals(2 * self.BYTES, self.pdc.GetCacheUsed())
+        # shrinking the budget keeps the most recently drawn
+        self.pdc.SetCacheBudget(self.BYTES)
+        self.assertEquals(0, self.pdc.GetIdCacheSize(1))
+        self.assertEquals(self.BYTES, self.pdc.GetIdCacheSize(3))
+        self.assertEquals(self.BYTES, self.pdc.GetCacheUsed())
+
+    def testTooBig(self):
+        """An object bigger than the budget is drawn op by op"""
+        self.pdc.SetCacheBudget(self.BYTES - 1)
+        self.square(1, 0)
+        self.assert_(drawnPixels(self.pdc))
+        self.assertEquals(0, self.pdc.GetCacheUsed())
+
+
+if __name__ == '__main__':
+    app = wx.PySimpleApp()
+    unittest.main()
@@ -0,0 +1,98 @@
+"""Unit tests for wx.richtext.RichTextXMLHandler.
+
+The handler reads its XML with a parser of its own, these tests check it
+against documents written by hand as well as by the handler itself.
+
+Methods yet to test:
+CanLoad, CanSave"""
+
+import unittest
+import cStringIO
+import wx
+import wx.richtext as rt
+
+HEADER = '<?xml version="1.0" encoding="%s"?>\n'
+
+def document(text, encoding='UTF-8'):
+    """A document with one paragraph holding the given text element(s)."""
+    return (HEADER % encoding +
+            '<richtext version="1.0.0.0" xmlns="http://www.wxwidgets.org">\n'
+            '  <paragraphlayout>\n'
+            '    <paragraph>\n'
+            '      %s\n'
+            '    </paragraph>\n'
+            '  </paragraphlayout>\n'
+            '</richtext>\n') % text
+
+def load(data):
+    """Load the bytes into a new buffer, returns (success, buffer)."""
+    buffer = rt.RichTextBuffer()
+    ok = buffer.LoadStream(cStringIO.StringIO(data), rt.RICHTEXT_TYPE_XML)
+    return ok, buffer
+
+# -----------------------------------------------------------
+
+class RichTextXMLHandlerTest(unittest.TestCase):
+    def setUp(self):
+        if not rt.RichTextBuffer.FindHandlerByType(rt.RICHTEXT_TYPE_XML):
+            rt.RichTextBuffer.AddHandler(rt.RichTextXMLHandler())
+
+    def assertLoads(self, data, text):
+        ok, buffer = load(data)
+        self.assert_(ok)
+        self.assertEquals(text, buffer.GetText())
+        return buffer
+
+    def testRoundTrip(self):
+        """SaveStream, LoadStream"""
+        buffer = rt.RichTextBuffer()
+        text = u'a < b & c > d, \'single\' and "double" quotes, \xe9\u20ac'
+        buffer.AddParagraph(text)
+        buffer.AddParagraph(u'second paragraph')
+        out = cStringIO.StringIO()
+        self.assert_(buffer.SaveStream(out, rt.RICHTEXT_TYPE_XML))
+        ok, loaded = load(out.getvalue())
+        self.assert_(ok)
+        self.assertEquals(buffer.GetText(), loaded.GetText())
+
+    def testEntities(self):
+        """The predefined entities and character references"""
+        self.assertLoads(document('<text>&lt;&amp;&gt;&quot;&apos; &#65;&#x42;</text>'),
+                         u'<&>"\' AB')
+
+    def testUnknownEntity(self):
+        """An unknown entity is kept as it is"""
+        self.assertLoads(document('<text>a &nbsp; b</text>'), u'a &nbsp; b')
+
+    def testCDATA(self):
+        """CDATA is not parsed"""
+        self.assertLoads(document('<text><![CDATA[a <b> &amp; ]>]]></text>'),
+                         u'a <b> &amp; ]>')
+
+    def testQuotedAttributes(self):
+        """Attribute values in either quotes, with > and the other quote"""
+        buffer = self.assertLoads(
+            document('<text textcolor=\'#FF0000\' fontfacename="a\'b>c">x</text>'), u'x')
+        attr = rt.RichTextAttr()
+        self.assert_(buffer.GetStyle(0, attr))
+        self.assertEquals(wx.Colour(255, 0, 0), attr.GetTextColour())
+
+    def testLatin1(self):
+        """A document in ISO-8859-1"""
+        self.assertLoads(document('<text>caf\xe9</text>', 'ISO-8859-1'), u'caf\xe9')
+
+    def testInvalidUTF8(self):
+        """Bytes that are not UTF-8 fail the load"""
+        ok, buffer = load(document('<text>caf\xe9</text>'))
+        self.assert_(not ok)
+
+    def testUnterminated(self):
+        """A truncated document fails the load"""
+        data = document('<text>abc</text>')
+        ok, buffer = load(data[:data.index('</text>') + 3])
+        self.assert_(not ok)
+
+
+if __name__ == '__main__':
+    app = wx.PySimpleApp()
+    unittest.main()
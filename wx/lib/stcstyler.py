@@ -0,0 +1,172 @@
+"""
+Styles a `wx.stc.StyledTextCtrl` with a lexer written in Python on a worker
+thread, so that lexing a large document does not block typing.
+
+The lexer is a callable taking the raw (byte) text of a range and the
+document position where it starts, and returning one style byte per byte of
+text, as a string or any object supporting the buffer interface::
+
+    def lexer(text, startPos):
+        return '\\0' * len(text)
+
+    styler = BackgroundStyler(stc, lexer)
+
+When the control needs styling the styler takes a snapshot of the unstyled
+text, from the start of the line where the styled text ends, and hands it to
+the worker thread.  The result is applied with one call to
+SetStylingFromBuffer, but only if the document has not been changed since
+the snapshot was taken; otherwise it is dropped and a new snapshot is taken
+when the control asks for styling again.  A large document is styled in
+chunks of about `chunkSize` bytes, each of them ending at a line end.
+
+The lexer runs while holding the Python global interpreter lock like any
+other Python code, but the GUI thread gets to run between its bytecodes
+instead of waiting for the whole range to be lexed.
+"""
+
+import threading
+import traceback
+import warnings
+import wx
+import wx.stc as stc
+
+__all__ = ('BackgroundStyler',)
+
+
+class BackgroundStyler(object):
+    """
+    Styles `ctrl` in the background with `lexer`.  The control's lexer is
+    set to STC_LEX_CONTAINER, and its STYLENEEDED and MODIFIED events are
+    bound (and skipped, so other handlers still see them).  `styleMask` is
+    passed to SetStylingFromBuffer.
+    """
+    def __init__(self, ctrl, lexer, chunkSize=65536, styleMask=0x1f):
+        self.ctrl = ctrl
+        self.lexer = lexer
+        self.chunkSize = chunkSize
+        self.styleMask = styleMask
+
+        self._version = 0      # incremented by every text change
+        self._busy = False     # a snapshot is being lexed
+        self._needed = 0       # how far the control wants styles
+        self._job = None       # the next snapshot for the worker
+        self._stopped = False
+        self._cond = threading.Condition()
+        self._thread = threading.Thread(target=self._run)
+        self._thread.setDaemon(True)
+        self._thread.start()
+
+        ctrl.SetLexer(stc.STC_LEX_CONTAINER)
+        ctrl.Bind(stc.EVT_STC_STYLENEEDED, self.OnStyleNeeded)
+        ctrl.Bind(stc.EVT_STC_MODIFIED, self.OnModified)
+        ctrl.Bind(wx.EVT_WINDOW_DESTROY, self.OnDestroy)
+
+
+    def Stop(self):
+        """
+        Stops the worker thread.  Results still being computed are dropped.
+        """
+        self._cond.acquire()
+        self._stopped = True
+        self._job = None
+        self._cond.notify()
+        self._cond.release()
+
+
+    def Restyle(self):
+        """
+        Drops any result being computed and styles the document again from
+        the start, for example after the lexer's settings changed.
+        """
+        self._version += 1
+        self.ctrl.StartStyling(0, self.styleMask)
+        self._needed = max(self._needed, self.ctrl.GetLength())
+        self._busy = False
+        self._Request()
+
+
+    def OnStyleNeeded(self, evt):
+        self._needed = max(self._needed, evt.GetPosition())
+        if not self._busy:
+            self._Request()
+        evt.Skip()
+
+
+    def OnModified(self, evt):
+        if evt.GetModificationType() & (stc.STC_MOD_INSERTTEXT | stc.STC_MOD_DELETETEXT):
+            # Whatever is being lexed is now stale; the control lowers its
+            # styled end to the change and will ask for styling again.
+            self._version += 1
+            self._busy = False
+            self._needed = 0
+        evt.Skip()
+
+
+    def OnDestroy(self, evt):
+        if evt.GetEventObject() is self.ctrl:
+            self.Stop()
+        evt.Skip()
+
+
+    def _Request(self):
+        # Take a snapshot of the next chunk that needs styling and queue it,
+        # replacing a queued snapshot that has not been started yet.
+        ctrl = self.ctrl
+        length = ctrl.GetLength()
+        start = ctrl.PositionFromLine(ctrl.LineFromPosition(ctrl.GetEndStyled()))
+        # One chunk at a time, _Apply asks for the next one until the
+        # control is styled as far as it needs.
+        end = min(start + self.chunkSize, length)
+        if end < length:
+            nextLine = ctrl.PositionFromLine(ctrl.LineFromPosition(end) + 1)
+            if 0 <= nextLine < length:
+                end = nextLine
+            else:
+                end = length
+        if start >= end:
+            return
+        text = ctrl.GetTextRangeRaw(start, end)
+        self._busy = True
+        self._cond.acquire()
+        self._job = (self._version, start, text)
+        self._cond.notify()
+        self._cond.release()
+
+
+    def _run(self):
+        # The worker thread: lex the latest snapshot and send the styles
+        # back to the GUI thread.
+        while True:
+            self._cond.acquire()
+            while self._job is None and not self._stopped:
+                self._cond.wait()
+            if self._stopped:
+                self._cond.release()
+                return
+            version, start, text = self._job
+            self._job = None
+            self._cond.release()
+
+            try:
+                styles = self.lexer(text, start)
+            except Exception:
+                traceback.print_exc()
+                styles = None
+            if styles is not None and len(styles) != len(text):
+                warnings.warn('BackgroundStyler: the lexer returned %d styles for %d bytes' %
+                              (len(styles), len(text)), RuntimeWarning)
+                styles = None
+            wx.CallAfter(self._Apply, version, start, styles)
+
+
+    def _Apply(self, version, start, styles):
+        if self._stopped or not self.ctrl or version != self._version:
+            return
+        self._busy = False
+        if styles is None:
+            return
+        if start + len(styles) > self.ctrl.GetLength():
+            return
+        self.ctrl.SetStylingFromBuffer(start, styles, self.styleMask)
+        if self.ctrl.GetEndStyled() < self._needed:
+            self._Request()